@@ -0,0 +1,34 @@
+	OPT	mz1
+
+	SECTION	"Code",CODE
+start:
+	lda	later		; shortened, zero page EQU defined later
+	sta	later+1,x	; shortened
+	lda	(later),y	; no absolute mode, always zero page
+	lda	variable	; zero page, label in the ZP group
+	lda	msg,x		; stays absolute, code label defined later
+	lda	start		; stays absolute, code label already defined
+	jmp	start
+msg:	DB	"hello"
+msgend:
+	DS	msgend-msg	; constant, no shortened instruction between the labels
+	DB	msgend-start	; patched after shortening
+
+	SECTION	"Aligned",CODE
+	lda	later		; stays absolute, before the alignment
+	EVEN
+	lda	later		; shortened, after the alignment
+	rts
+
+	SECTION	"Sizes",CODE
+sizeStart:
+	lda	sizeStart	; stays absolute, not recorded as shortenable
+	jmp	start
+sizeEnd:
+	DS	sizeEnd-sizeStart	; constant, nothing between the labels may shrink
+
+	SECTION	"Variables",ZP
+variable:
+	DS	1
+
+later	EQU	$80
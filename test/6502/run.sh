@@ -10,7 +10,23 @@ test() {
 	fi
 }
 
+testlink() {
+	echo Testing linking $1
+	../../build/cmake/debug/xasm/6502/motor6502 -fx -o$1.obj $1 >$1.out 2>$1.err
+	../../build/cmake/debug/xlink/xlink -c$2 -fbin -o$1.bin $1.obj >>$1.out 2>>$1.err
+	od -t x1 $1.bin | sed 's/  */ /g' | sed -e '$a\' >$1.r
+	cat $1.r $1.out $1.err >$1.output 2>/dev/null
+	rm $1.obj $1.bin $1.r $1.out $1.err 2>/dev/null
+	diff $1.output $1.answer
+	if [ $? -eq 0 ]; then
+		rm $1.output
+	fi
+}
+
 for i in *.asm; do
 	test $i
 done
 
+for i in *.s; do
+	testlink $i fxf256jrs
+done
@@ -3,7 +3,7 @@
 test() {
 	echo Test assembling $1
 	echo EMPTY >$1.bin
-	../../build/cmake/debug/xasm/680x0/motor68k -mga -f$2 -o$1.bin $1 >$1.out 2>$1.err
+	../../build/cmake/debug/xasm/680x0/motor68k -mga $3 -f$2 -o$1.bin $1 >$1.out 2>$1.err
 	od -t x1 $1.bin | sed 's/  */ /g' | sed -e '$a\' >$1.r
 	cat $1.r $1.out $1.err >$1.obj.output 2>/dev/null
 	rm $1.bin $1.r $1.out $1.err 2>/dev/null
@@ -27,6 +27,21 @@ testlink() {
 	fi
 }
 
+# Links $1 and $2 into an Amiga executable
+testamigaexe() {
+	echo Test linking $1
+	../../build/cmake/debug/xasm/680x0/motor68k -mga -o$1.obj $1 >$1.out 2>$1.err
+	../../build/cmake/debug/xasm/680x0/motor68k -mga -o$2.obj $2 >>$1.out 2>>$1.err
+	../../build/cmake/debug/xlink/xlink -camiga -famigaexe -o$1.exe $1.obj $2.obj >>$1.out 2>>$1.err
+	od -t x1 $1.exe | sed 's/  */ /g' | sed -e '$a\' >$1.r
+	cat $1.r $1.out $1.err >$1.exe.output 2>/dev/null
+	rm $1.obj $2.obj $1.exe $1.r $1.out $1.err 2>/dev/null
+	diff -b $1.exe.output $1.exe.answer
+	if [ $? -eq 0 ]; then
+		rm $1.exe.output
+	fi
+}
+
 test amigaexe.68k g
 test amigaobj.68k h
 test test.68k b
@@ -36,7 +51,8 @@ test odd-instr.68k b
 test issue15.68k b
 test issue17.68k b
 test 68040.68k b
+test relax.68k b -mry
 
 testlink amigaexe.68k a
 testlink amigaobj.68k b
-
+testamigaexe pcrel.68k pcrel_data.68k
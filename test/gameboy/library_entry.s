@@ -0,0 +1,6 @@
+; Library module, linked by run.sh as the smart linking root
+
+	SECTION	"Entry",CODE
+	IMPORT	helper
+entry::
+	DB	$E1,helper
@@ -0,0 +1,5 @@
+; Library module, read because library_entry.s imports its symbol
+
+	SECTION	"Helper",CODE
+helper::
+	DB	$48
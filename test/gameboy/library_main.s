@@ -0,0 +1,4 @@
+; Linked by run.sh together with a library of library_entry.s, library_helper.s and library_unused.s
+
+	SECTION	"Main",CODE
+	DB	$11
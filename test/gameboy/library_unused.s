@@ -0,0 +1,5 @@
+; Library module that is not needed
+
+	SECTION	"Unused",CODE
+unused::
+	DB	$55
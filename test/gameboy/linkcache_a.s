@@ -0,0 +1,3 @@
+	SECTION	"A",CODE
+	IMPORT	Value,Label
+	DB	$A1,Value,Label
@@ -0,0 +1,17 @@
+	SECTION	"B",CODE
+	EXPORT	Value,Label
+
+	IF	DEF(CHANGED)
+Value	EQU	2
+	ELSE
+Value	EQU	1
+	ENDC
+
+	IF	DEF(LARGER)
+	DB	$B0,$B0
+	ENDC
+Label:	DB	$B1
+
+	IF	DEF(AFTER)
+	DB	$B2
+	ENDC
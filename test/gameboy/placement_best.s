@@ -0,0 +1,9 @@
+; In order the first two sections fill the first pool, and the last one doesn't fit
+	SECTION	"A",CODE
+	DB	$A1,$A2,$A3
+	SECTION	"B",CODE
+	DB	$B1,$B2,$B3
+	SECTION	"C",CODE
+	DB	$C1,$C2,$C3,$C4,$C5,$C6,$C7
+	SECTION	"D",CODE
+	DB	$D1,$D2,$D3,$D4,$D5,$D6,$D7
@@ -0,0 +1,13 @@
+; Placing the largest sections first leaves no pool for the last section
+	SECTION	"A",CODE
+	DB	$A1,$A2,$A3,$A4
+	SECTION	"B",CODE
+	DB	$B1,$B2,$B3,$B4
+	SECTION	"C",CODE
+	DB	$C1,$C2,$C3
+	SECTION	"D",CODE
+	DB	$D1,$D2,$D3
+	SECTION	"E",CODE
+	DB	$E1,$E2,$E3
+	SECTION	"F",CODE
+	DB	$F1,$F2,$F3
@@ -10,7 +10,73 @@ test() {
 	fi
 }
 
+# Links $1 and $2 with the machine definition $3 several times, keeping a link cache and listing the sections reused
+# from it. $2 is assembled with different options each time.
+testlinkcache() {
+	echo Testing link cache $1
+	rm -f $1.output $1.cache
+	../../build/cmake/debug/xasm/z80/motorz80 -mcg -s$3 -o$1.o $1 >>$1.output 2>&1
+	for options in "" "" -DCHANGED -DLARGER "" -DAFTER; do
+		echo "Options: $options" >>$1.output
+		../../build/cmake/debug/xasm/z80/motorz80 -mcg -s$3 $options -o$2.o $2 >>$1.output 2>&1
+		../../build/cmake/debug/xlink/xlink -a$3 -fbin -v -i$1.cache -o$1.bin $1.o $2.o >>$1.output 2>&1
+		od -t x1 $1.bin | sed 's/  */ /g' >>$1.output
+		rm -f $1.bin
+	done
+	rm -f $1.o $2.o $1.cache
+	diff $1.output $1.answer
+	if [ $? -eq 0 ]; then
+		rm $1.output
+	fi
+}
+
+# Links $1 with the machine definition $2 using every section placement
+testplacement() {
+	echo Testing placement $1
+	rm -f $1.output
+	../../build/cmake/debug/xasm/z80/motorz80 -mcg -s$2 -o$1.o $1 >>$1.output 2>&1
+	for placement in first best pack; do
+		echo "Placement: $placement" >>$1.output
+		../../build/cmake/debug/xlink/xlink -a$2 -fbin -p$placement -o$1.bin $1.o >>$1.output 2>&1
+		od -t x1 $1.bin 2>/dev/null | sed 's/  */ /g' >>$1.output
+		rm -f $1.bin
+	done
+	rm -f $1.o
+	diff $1.output $1.answer
+	if [ $? -eq 0 ]; then
+		rm $1.output
+	fi
+}
+
+# Links $1 with the machine definition $2 and a library of the remaining files, smart linking from the symbol "entry"
+# which only the library exports
+testlibrary() {
+	echo Testing library $1
+	main=$1
+	machine=$2
+	shift 2
+	rm -f $main.output $main.xlb
+	for file in $main "$@"; do
+		../../build/cmake/debug/xasm/z80/motorz80 -mcg -s$machine -o$file.o $file >>$main.output 2>&1
+	done
+	for file in "$@"; do
+		../../build/cmake/debug/xlib/xlib $main.xlb a $file.o >>$main.output 2>&1
+		rm -f $file.o
+	done
+	../../build/cmake/debug/xlink/xlink -a$machine -fbin -sentry -o$main.bin $main.o $main.xlb >>$main.output 2>&1
+	od -t x1 $main.bin 2>/dev/null | sed 's/  */ /g' >>$main.output
+	rm -f $main.o $main.xlb $main.bin
+	diff $main.output $main.answer
+	if [ $? -eq 0 ]; then
+		rm $main.output
+	fi
+}
+
 for i in *.asm; do
 	test $i
 done
 
+testlinkcache linkcache_a.s linkcache_b.s link.def
+testplacement placement_best.s link.def
+testplacement placement_pack.s link.def
+testlibrary library_main.s link.def library_entry.s library_helper.s library_unused.s
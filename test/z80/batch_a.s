@@ -0,0 +1,4 @@
+; Assembled together with batch_b.s and batch_c.s by run.sh
+
+	SECTION	"Code",CODE
+	DB	1
@@ -0,0 +1,4 @@
+; Assembled together with batch_a.s and batch_c.s by run.sh, fails
+
+	SECTION	"Code",CODE
+	DB	UNDEFINED
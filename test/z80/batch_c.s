@@ -0,0 +1,4 @@
+; Assembled together with batch_a.s and batch_b.s by run.sh
+
+	SECTION	"Code",CODE
+	DB	3
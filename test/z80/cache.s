@@ -0,0 +1,5 @@
+; Assembled several times by run.sh with a cache, cache_value.tmp is written by run.sh
+
+	SECTION	"Code",CODE
+	INCLUDE	"cache_value.tmp"
+	DB	VALUE
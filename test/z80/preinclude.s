@@ -0,0 +1,5 @@
+; Assembled by run.sh with preinclude.inc pre-included
+
+	SECTION	"Code",CODE
+	PUT	VALUE
+	DB	NAME
@@ -10,7 +10,77 @@ test() {
 	fi
 }
 
+# Assembles $1 with $2 pre-included, $3 is written to the file included by $2 and $4 are extra options
+preinclude() {
+	echo "$3" >preinclude_value.tmp
+	../../build/cmake/debug/xasm/z80/motorz80 -mcz $4 -fv -p$2 -o$1.r $1 >>$1.output 2>&1
+	cat $1.r >>$1.output 2>/dev/null
+	rm $1.r 2>/dev/null
+	if [ -f $2.snapshot ]; then
+		echo "Snapshot exists" >>$1.output
+	fi
+}
+
+testpreinclude() {
+	echo Testing $1
+	rm -f $1.output $2.snapshot
+	preinclude $1 $2 "VALUE EQU 1"
+	preinclude $1 $2 "VALUE EQU 1"
+	preinclude $1 $2 "VALUE EQU 2"
+	preinclude $1 $2 "VALUE EQU 2" -DWIDE
+	rm -f $2.snapshot preinclude_value.tmp
+	diff $1.output $1.answer
+	if [ $? -eq 0 ]; then
+		rm $1.output
+	fi
+}
+
+# Assembles $1 with a cache, $2 is written to the file included by $1
+cache() {
+	echo "$2" >cache_value.tmp
+	../../build/cmake/debug/xasm/z80/motorz80 -mcz -v -c$1.cache -fv -o$1.r $1 2>&1 | sed 's/ in [0-9.]* seconds.*//' >>$1.output
+	cat $1.r >>$1.output 2>/dev/null
+	rm $1.r 2>/dev/null
+}
+
+testcache() {
+	echo Testing cache $1
+	rm -rf $1.output $1.cache
+	mkdir $1.cache
+	cache $1 "VALUE EQU 1"
+	cache $1 "VALUE EQU 1"
+	cache $1 "VALUE EQU 2"
+	cache $1 "VALUE EQU 2"
+	rm -rf $1.cache cache_value.tmp
+	diff $1.output $1.answer
+	if [ $? -eq 0 ]; then
+		rm $1.output
+	fi
+}
+
+# Assembles the files given at once, $1 names the output
+testbatch() {
+	echo Testing batch $1
+	rm -f $1.output
+	../../build/cmake/debug/xasm/z80/motorz80 -mcz -fv -j2 "$@" >>$1.output 2>&1
+	echo "Exit code: $?" >>$1.output
+	for file in "$@"; do
+		if [ -f ${file%.*}.mem ]; then
+			echo "${file%.*}.mem:" >>$1.output
+			cat ${file%.*}.mem >>$1.output
+			rm ${file%.*}.mem
+		fi
+	done
+	diff $1.output $1.answer
+	if [ $? -eq 0 ]; then
+		rm $1.output
+	fi
+}
+
 for i in *.asm; do
 	test $i
 done
 
+testpreinclude preinclude.s preinclude.inc
+testcache cache.s
+testbatch batch_a.s batch_b.s batch_c.s
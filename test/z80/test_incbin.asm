@@ -0,0 +1,7 @@
+	SECTION	"Data",DATA
+	INCBIN	"test_incbin.dat"	; the whole file
+	INCBIN	"test_incbin.dat",12	; the rest of the file from an offset
+	INCBIN	"test_incbin.dat",4,3	; a slice
+	INCBIN	"test_incbin.dat",16	; the empty rest at the end
+	INCBIN	"test_incbin.dat",15,1	; the last byte
+	INCBIN	"test_incbin.dat",2,0	; nothing
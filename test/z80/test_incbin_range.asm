@@ -0,0 +1,6 @@
+	SECTION	"Data",DATA
+	INCBIN	"test_incbin.dat",17	; offset after the end
+	INCBIN	"test_incbin.dat",8,9	; slice past the end
+	INCBIN	"test_incbin.dat",-1	; negative offset
+	INCBIN	"test_incbin.dat",0,-1	; negative length
+	INCBIN	"test_incbin.dat",0,16	; the whole file
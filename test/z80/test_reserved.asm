@@ -0,0 +1,6 @@
+	SECTION	"Code",CODE
+LDIR:				; removes the LDIR keyword
+	ldi			; keywords sharing its prefix remain
+	lddr
+	ld	a,b
+	jr	LDIR
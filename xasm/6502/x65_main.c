@@ -62,6 +62,8 @@ static SConfiguration x65_xasmConfiguration = {
     x65_AssignSection,
 
     x65_IsValidLocalName,
+
+    x65_RelaxSections,
 };
 
 extern int
@@ -58,6 +58,7 @@ x65_SetDefault(SMachineOptions* options) {
 	options->x16 = false;
 	options->allowedModes = MODE_6502;
 	options->bp_base = 0;
+	options->relaxZeroPage = false;
 }
 
 void
@@ -128,6 +129,14 @@ x65_ParseOption(const char* s) {
 			err_Warn(WARN_MACHINE_UNKNOWN_OPTION, s);
 			return false;
 		}
+		case 'z': {
+			if (strlen(&s[1]) == 1) {
+				opt_Current->machineOptions->relaxZeroPage = s[1] == '1';
+				return true;
+			}
+			err_Warn(WARN_MACHINE_UNKNOWN_OPTION, s);
+			return false;
+		}
 		default:
 			err_Warn(WARN_MACHINE_UNKNOWN_OPTION, s);
 			return false;
@@ -153,5 +162,8 @@ x65_PrintOptions(void) {
 	       "              5 - 45GS02\n"
 	       "    -ms<x>  Synthesized instructions:\n"
 	       "              0 - Disabled (default)\n"
+	       "              1 - Enabled\n"
+	       "    -mz<x>  Zero page addressing for symbols resolved later:\n"
+	       "              0 - Disabled (default)\n"
 	       "              1 - Enabled\n");
 }
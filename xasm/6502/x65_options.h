@@ -40,6 +40,7 @@ typedef struct MachineOptions {
 	bool x16; /* 16 bit index immediate */
 	uint32_t allowedModes;
 	int32_t bp_base;
+	bool relaxZeroPage; /* shorten absolute addresses found to be in the zero page */
 } SMachineOptions;
 
 extern SMachineOptions*
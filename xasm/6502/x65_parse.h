@@ -83,6 +83,7 @@ typedef struct {
 	SExpression* expr2;
 	SExpression* expr3;
 	bool size_forced;
+	uint32_t relaxableMode; /* zero page mode the absolute mode may be shortened to, or 0 */
 } SAddressingMode;
 
 typedef enum {
@@ -31,6 +31,7 @@
 #include "x65_errors.h"
 #include "x65_options.h"
 #include "x65_parse.h"
+#include "x65_section.h"
 #include "x65_tokens.h"
 
 static SExpression*
@@ -86,13 +87,14 @@ x65_ParseAddressingModeCore(SAddressingMode* addrMode, uint32_t allowedModes, EI
 			break;
 	}
 
-	SLexerContext bm;
+	SLexerBookmark bm;
 	lex_Bookmark(&bm);
 
 	addrMode->expr = NULL;
 	addrMode->expr2 = NULL;
 	addrMode->expr3 = NULL;
 	addrMode->size_forced = false;
+	addrMode->relaxableMode = 0;
 
 	if ((allowedModes & MODE_A) && lex_Context->token.id == T_6502_REG_A) {
 		parse_GetToken();
@@ -347,12 +349,54 @@ x65_ParseAddressingModeCore(SAddressingMode* addrMode, uint32_t allowedModes, EI
 	(MODE_4510_IND_ZP_Z | MODE_45GS02_IND_ZP_Z_QUAD | MODE_45GS02_IND_ZP_QUAD | MODE_IND_ZP_X | MODE_IND_ZP_Y | MODE_ZP_ABS | \
 	 MODE_BIT_ZP_ABS | MODE_ZP | MODE_ZP_X | MODE_ZP_Y | MODE_45GS02_IND_ZP_QUAD | MODE_816_LONG_IND_ZP)
 
+//	Returns the zero page mode an absolute mode may be shortened to, or 0
+static uint32_t
+zeroPageMode(uint32_t mode, uint32_t allowedModes) {
+	switch (mode) {
+		case MODE_ABS:
+			return MODE_ZP & allowedModes;
+		case MODE_ABS_X:
+			return MODE_ZP_X & allowedModes;
+		case MODE_ABS_Y:
+			return MODE_ZP_Y & allowedModes;
+		case MODE_IND_ABS:
+			return MODE_IND_ZP & allowedModes;
+		case MODE_816_LONG_IND_ABS:
+			return MODE_816_LONG_IND_ZP & allowedModes;
+		default:
+			return 0;
+	}
+}
+
+//	Uses the zero page mode for an address in the zero page group, or when the instruction has no absolute mode, and
+//	otherwise marks the absolute mode as one that may be shortened when the address is known. An address already known
+//	to be outside the zero page is left absolute.
+static void
+relaxAddressingMode(SAddressingMode* addrMode, uint32_t allowedModes) {
+	uint32_t zpMode = zeroPageMode(addrMode->mode, allowedModes);
+	if (zpMode == 0)
+		return;
+
+	if ((addrMode->mode & allowedModes) == 0 || x65_IsZeroPageLabel(addrMode->expr)) {
+		addrMode->mode = zpMode;
+		addrMode->expr = x65_ZeroPageExpression(addrMode->expr, opt_Current->machineOptions->bp_base);
+	} else if (!x65_IsAbsoluteLabel(addrMode->expr)) {
+		addrMode->relaxableMode = zpMode;
+	}
+}
+
 extern bool
 x65_ParseAddressingMode(SAddressingMode* addrMode, uint32_t allowedModes, EImmediateSize immSize) {
 	if (x65_ParseAddressingModeCore(addrMode, allowedModes, immSize)) {
-		if (addrMode->size_forced || (addrMode->mode & HANDLE_MODES) == 0 || !expr_IsConstant(addrMode->expr))
+		if (addrMode->size_forced || (addrMode->mode & HANDLE_MODES) == 0)
 			return addrMode->mode != 0;
 
+		if (!expr_IsConstant(addrMode->expr)) {
+			if (opt_Current->machineOptions->relaxZeroPage)
+				relaxAddressingMode(addrMode, allowedModes);
+			return addrMode->mode != 0;
+		}
+
 		SExpression** zpExpr = NULL;
 		switch (addrMode->mode) {
 			case MODE_BIT_ZP:
@@ -376,30 +420,16 @@ x65_ParseAddressingMode(SAddressingMode* addrMode, uint32_t allowedModes, EImmed
 
 		switch (addrMode->mode) {
 			case MODE_ABS:
-				if ((allowedModes & MODE_ZP) == 0)
-					return true;
-				addrMode->mode = MODE_ZP;
-				break;
 			case MODE_ABS_X:
-				if ((allowedModes & MODE_ZP_X) == 0)
-					return true;
-				addrMode->mode = MODE_ZP_X;
-				break;
 			case MODE_ABS_Y:
-				if ((allowedModes & MODE_ZP_Y) == 0)
-					return true;
-				addrMode->mode = MODE_ZP_Y;
-				break;
 			case MODE_IND_ABS:
-				if ((allowedModes & MODE_IND_ZP) == 0)
-					return true;
-				addrMode->mode = MODE_IND_ZP;
-				break;
-			case MODE_816_LONG_IND_ABS:
-				if ((allowedModes & MODE_816_LONG_IND_ZP) == 0)
+			case MODE_816_LONG_IND_ABS: {
+				uint32_t zpMode = zeroPageMode(addrMode->mode, allowedModes);
+				if (zpMode == 0)
 					return true;
-				addrMode->mode = MODE_816_LONG_IND_ZP;
+				addrMode->mode = zpMode;
 				break;
+			}
 			case MODE_4510_IND_ZP_Z:
 			case MODE_45GS02_IND_ZP_Z_QUAD:
 			case MODE_45GS02_IND_ZP_QUAD:
@@ -19,6 +19,7 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "errors.h"
 #include "expression.h"
@@ -26,10 +27,12 @@
 #include "options.h"
 #include "parse.h"
 #include "section.h"
+#include "symbol.h"
 
 #include "x65_errors.h"
 #include "x65_options.h"
 #include "x65_parse.h"
+#include "x65_section.h"
 #include "x65_tokens.h"
 
 #define NOP_PREFIX 0xEA
@@ -710,6 +713,41 @@ static SParser g_instructionHandlers[T_65C02_SMB7 - T_6502_ADC + 1] = {
     {0xF7, CPU_65C02S, IMM_8_BIT, MODE_ZP,                                                                                  handleBITx_C02      }, /* SMB7 */
 };
 
+static bool
+isRelaxable(const SAddressingMode* addrMode) {
+	return addrMode->relaxableMode != 0 && sect_Current != NULL && sect_Current->flags == 0 && sect_Current->group != NULL &&
+	       sect_Current->group->value.groupType == GROUP_TEXT;
+}
+
+//	Outputs an instruction with an absolute address that may turn out to be in the zero page. The zero page encoding is
+//	output first to learn its bytes, and then removed again.
+static bool
+handleRelaxable(const SParser* handler, SAddressingMode* addrMode) {
+	uint32_t offset = sect_Current->usedSpace;
+
+	SAddressingMode zpMode = *addrMode;
+	zpMode.mode = addrMode->relaxableMode;
+	zpMode.expr = expr_Const(0);
+	handler->handler(handler->baseOpcode, &zpMode);
+
+	uint32_t zpSize = sect_Current->usedSpace - offset;
+	uint8_t zpEncoding[X65_MAX_ZERO_PAGE_ENCODING];
+	bool encoded = zpSize >= 2 && zpSize - 1 <= X65_MAX_ZERO_PAGE_ENCODING;
+	if (encoded)
+		memcpy(zpEncoding, &sect_Current->data[offset], zpSize - 1);
+	sect_RemoveBytes(sect_Current, &offset, 1, zpSize);
+
+	SExpression* address = expr_Copy(addrMode->expr);
+	handler->handler(handler->baseOpcode, addrMode);
+
+	if (encoded && sect_Current->usedSpace - offset == zpSize + 1)
+		x65_AddRelaxableInstruction(offset, zpEncoding, opt_Current->machineOptions->bp_base, address);
+	else
+		expr_Free(address);
+
+	return true;
+}
+
 extern bool
 x65_HandleTokenAddressMode(ETargetToken token, SAddressingMode* addrMode) {
 	assert(T_6502_ADC <= token && token <= T_65C02_SMB7);
@@ -734,10 +772,13 @@ x65_HandleToken(ETargetToken token, uint32_t allowedModes) {
 	if (handler->cpu & opt_Current->machineOptions->cpu) {
 		SAddressingMode addrMode;
 		allowedModes &= handler->allowedModes & opt_Current->machineOptions->allowedModes;
-		if (x65_ParseAddressingMode(&addrMode, allowedModes, handler->immSize) && (addrMode.mode & allowedModes))
+		if (x65_ParseAddressingMode(&addrMode, allowedModes, handler->immSize) && (addrMode.mode & allowedModes)) {
+			if (isRelaxable(&addrMode))
+				return handleRelaxable(handler, &addrMode);
 			return handler->handler(handler->baseOpcode, &addrMode);
-		else
+		} else {
 			err_Error(MERROR_ILLEGAL_ADDRMODE);
+		}
 	} else {
 		err_Error(MERROR_INSTRUCTION_NOT_SUPPORTED);
 	}
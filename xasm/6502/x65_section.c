@@ -16,7 +16,225 @@
     along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mem.h"
+
+#include "expression.h"
+#include "patch.h"
+#include "section.h"
+#include "symbol.h"
+
 #include "x65_section.h"
+#include "x65_symbols.h"
+
+typedef struct RelaxableInstruction {
+	SSection* section;
+	uint32_t offset; // offset of the first byte of the instruction
+	uint32_t size;   // size of the instruction using an absolute address
+	uint8_t zeroPageEncoding[X65_MAX_ZERO_PAGE_ENCODING];
+	int32_t basePage;
+	SExpression* address;
+} SRelaxableInstruction;
+
+static SRelaxableInstruction* g_instructions = NULL;
+static uint32_t g_totalInstructions = 0;
+static uint32_t g_allocatedInstructions = 0;
+
+static SExpression*
+skipParens(SExpression* expr) {
+	while (expr != NULL && expr_Type(expr) == EXPR_PARENS)
+		expr = expr->right;
+	return expr;
+}
+
+//	Returns the symbol the address is relative to, if the address is a symbol optionally plus or minus a constant
+static SSymbol*
+addressSymbol(SExpression* address) {
+	address = skipParens(address);
+	if (address == NULL)
+		return NULL;
+
+	if (expr_Type(address) == EXPR_SYMBOL)
+		return address->value.symbol;
+
+	if (expr_IsOperator(address, T_OP_ADD) || expr_IsOperator(address, T_OP_SUBTRACT)) {
+		if (expr_IsConstant(address->right))
+			return addressSymbol(address->left);
+		if (expr_IsOperator(address, T_OP_ADD) && expr_IsConstant(address->left))
+			return addressSymbol(address->right);
+	}
+
+	return NULL;
+}
+
+//	Evaluates an address built from constants and symbols that have been given constant values since it was parsed
+static bool
+constantAddress(SExpression* address, int32_t* value) {
+	address = skipParens(address);
+	if (address == NULL)
+		return false;
+
+	if (expr_IsConstant(address)) {
+		*value = address->value.integer;
+		return true;
+	}
+
+	if (expr_Type(address) == EXPR_SYMBOL && (address->value.symbol->flags & SYMF_CONSTANT)) {
+		*value = address->value.symbol->value.integer;
+		return true;
+	}
+
+	int32_t left, right;
+	if ((expr_IsOperator(address, T_OP_ADD) || expr_IsOperator(address, T_OP_SUBTRACT)) &&
+	    constantAddress(address->left, &left) && constantAddress(address->right, &right)) {
+		*value = expr_IsOperator(address, T_OP_ADD) ? left + right : left - right;
+		return true;
+	}
+
+	return false;
+}
+
+static bool
+isZeroPageAddress(SExpression* address, int32_t basePage) {
+	int32_t value;
+	if (constantAddress(address, &value))
+		return basePage <= value && value <= basePage + 255;
+
+	return x65_IsZeroPageLabel(address);
+}
+
+//	Returns the instruction whose address patch is at the offset, the instructions are sorted by offset
+static SRelaxableInstruction*
+findInstruction(SRelaxableInstruction** instructions, uint32_t totalInstructions, uint32_t patchOffset) {
+	uint32_t low = 0;
+	uint32_t high = totalInstructions;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+		SRelaxableInstruction* instruction = instructions[middle];
+		uint32_t addressOffset = instruction->offset + instruction->size - 2;
+		if (addressOffset == patchOffset)
+			return instruction;
+		else if (addressOffset < patchOffset)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return NULL;
+}
+
+static void
+relaxSection(SSection* section, SRelaxableInstruction** instructions, uint32_t* offsets) {
+	uint32_t fixedSpace = section->alignedSpace > section->evenAlignedSpace ? section->alignedSpace : section->evenAlignedSpace;
+
+	//	The high byte of the address is removed, which must not move data before an alignment
+	uint32_t totalInstructions = 0;
+	for (uint32_t i = 0; i < g_totalInstructions; ++i) {
+		SRelaxableInstruction* instruction = &g_instructions[i];
+		if (instruction->section == section && instruction->offset + instruction->size - 1 >= fixedSpace &&
+		    isZeroPageAddress(instruction->address, instruction->basePage)) {
+			instructions[totalInstructions++] = instruction;
+		}
+	}
+
+	if (totalInstructions == 0)
+		return;
+
+	//	The patch of the low byte of the address is made 8 bit
+	for (SPatch* patch = section->patches; patch != NULL; patch = list_GetNext(patch)) {
+		SRelaxableInstruction* instruction = findInstruction(instructions, totalInstructions, patch->offset);
+		if (instruction != NULL && patch->type == PATCH_LE_16) {
+			expr_Free(patch->expression);
+			patch->expression = x65_ZeroPageExpression(instruction->address, instruction->basePage);
+			patch->type = PATCH_8;
+			instruction->address = NULL;
+		}
+	}
+
+	uint32_t totalOffsets = 0;
+	for (uint32_t i = 0; i < totalInstructions; ++i) {
+		SRelaxableInstruction* instruction = instructions[i];
+		if (instruction->address == NULL) {
+			memcpy(&section->data[instruction->offset], instruction->zeroPageEncoding, instruction->size - 2);
+			offsets[totalOffsets++] = instruction->offset + instruction->size - 1;
+		}
+	}
+
+	sect_RemoveBytes(section, offsets, totalOffsets, 1);
+}
 
 extern void
 x65_AssignSection(SSection* section) {}
+
+extern SExpression*
+x65_ZeroPageExpression(SExpression* address, int32_t basePage) {
+	return expr_And(expr_CheckRange(address, basePage, basePage + 255), expr_Const(0xFF));
+}
+
+extern bool
+x65_IsZeroPageLabel(SExpression* address) {
+	SSymbol* symbol = addressSymbol(address);
+	return symbol != NULL && symbol->type == SYM_LABEL && symbol->section != NULL &&
+	       x65_IsZeroPageGroup(symbol->section->group);
+}
+
+extern bool
+x65_IsAbsoluteLabel(SExpression* address) {
+	SSymbol* symbol = addressSymbol(address);
+	if (symbol == NULL)
+		return false;
+
+	if (symbol->type == SYM_IMPORT)
+		return true;
+
+	return symbol->type == SYM_LABEL && symbol->section != NULL && !x65_IsZeroPageGroup(symbol->section->group);
+}
+
+extern void
+x65_AddRelaxableInstruction(uint32_t offset, const uint8_t* zeroPageEncoding, int32_t basePage, SExpression* address) {
+	if (g_totalInstructions == g_allocatedInstructions) {
+		g_allocatedInstructions = g_allocatedInstructions == 0 ? 64 : g_allocatedInstructions * 2;
+		g_instructions =
+		    (SRelaxableInstruction*) mem_Realloc(g_instructions, g_allocatedInstructions * sizeof(SRelaxableInstruction));
+	}
+
+	SRelaxableInstruction* instruction = &g_instructions[g_totalInstructions++];
+	instruction->section = sect_Current;
+	instruction->offset = offset;
+	instruction->size = sect_Current->usedSpace - offset;
+	memcpy(instruction->zeroPageEncoding, zeroPageEncoding, instruction->size - 2);
+	instruction->basePage = basePage;
+	instruction->address = address;
+
+	if (sect_Current->firstShrinkable == UINT32_MAX)
+		sect_Current->firstShrinkable = offset;
+	sect_Current->lastShrinkable = offset;
+}
+
+extern void
+x65_RelaxSections(void) {
+	if (g_totalInstructions == 0)
+		return;
+
+	SRelaxableInstruction** instructions =
+	    (SRelaxableInstruction**) mem_Alloc(g_totalInstructions * sizeof(SRelaxableInstruction*));
+	uint32_t* offsets = (uint32_t*) mem_Alloc(g_totalInstructions * sizeof(uint32_t));
+
+	for (SSection* section = sect_Sections; section != NULL; section = list_GetNext(section)) {
+		if (section->flags == 0 && section->data != NULL)
+			relaxSection(section, instructions, offsets);
+	}
+
+	mem_Free(offsets);
+	mem_Free(instructions);
+
+	for (uint32_t i = 0; i < g_totalInstructions; ++i)
+		expr_Free(g_instructions[i].address);
+
+	mem_Free(g_instructions);
+	g_instructions = NULL;
+	g_totalInstructions = 0;
+	g_allocatedInstructions = 0;
+}
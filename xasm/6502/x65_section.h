@@ -19,9 +19,37 @@
 #ifndef XASM_6502_SECTION_H_INCLUDED_
 #define XASM_6502_SECTION_H_INCLUDED_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "expression.h"
 #include "section.h"
 
+#define X65_MAX_ZERO_PAGE_ENCODING 8
+
 extern void
 x65_AssignSection(SSection* section);
 
+//	Returns the expression of the zero page byte of the address, with a range check against the base page
+extern SExpression*
+x65_ZeroPageExpression(SExpression* address, int32_t basePage);
+
+//	Returns true if the address is a label, optionally plus or minus a constant, in a section of the zero page group
+extern bool
+x65_IsZeroPageLabel(SExpression* address);
+
+//	Returns true if the address is an imported symbol or a label, optionally plus or minus a constant, in a section
+//	outside the zero page group. Such an address is never shortened.
+extern bool
+x65_IsAbsoluteLabel(SExpression* address);
+
+//	Records that the instruction just output at the offset with an absolute address may be shortened to its zero page
+//	encoding, of which zeroPageEncoding holds the bytes before the address. The section takes ownership of the address.
+extern void
+x65_AddRelaxableInstruction(uint32_t offset, const uint8_t* zeroPageEncoding, int32_t basePage, SExpression* address);
+
+//	Shortens the recorded instructions whose address turned out to be in the zero page
+extern void
+x65_RelaxSections(void);
+
 #endif
@@ -24,6 +24,9 @@
 #include "symbol.h"
 
 #include "x65_options.h"
+#include "x65_symbols.h"
+
+#define ZERO_PAGE_GROUP "ZP"
 
 static int32_t
 getMWidth(SSymbol* symbol) {
@@ -61,7 +64,7 @@ x65_DefineSymbols(void) {
 		createGroup("CODE", GROUP_TEXT);
 		createGroup("DATA", GROUP_TEXT);
 		createGroup("BSS", GROUP_BSS);
-		createGroup("ZP", GROUP_BSS);
+		createGroup(ZERO_PAGE_GROUP, GROUP_BSS);
 	}
 
 	createEquCallback("__816_M", getMWidth);
@@ -69,6 +72,11 @@ x65_DefineSymbols(void) {
 	createEquCallback("__4510_BP", getBP);
 }
 
+bool
+x65_IsZeroPageGroup(const SSymbol* group) {
+	return group != NULL && str_EqualConst(group->name, ZERO_PAGE_GROUP);
+}
+
 bool
 x65_IsValidLocalName(const string* name) {
 	return true;
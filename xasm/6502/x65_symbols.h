@@ -24,9 +24,15 @@
 
 #include "str.h"
 
+#include "symbol.h"
+
 extern void
 x65_DefineSymbols(void);
 
+//	Returns true if the group is the group of zero page sections
+extern bool
+x65_IsZeroPageGroup(const SSymbol* group);
+
 extern bool
 x65_IsValidLocalName(const string* name);
 
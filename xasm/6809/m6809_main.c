@@ -64,6 +64,8 @@ static SConfiguration m6809_xasmConfiguration = {
     m6809_AssignSection,
 
     m6809_IsValidLocalName,
+
+    NULL,
 };
 
 extern int
@@ -87,7 +87,7 @@ parseRegisterListBit(ETargetToken allowedStack, ETargetToken disallowedStack) {
 
 bool
 m6809_ParseAddressingMode(SAddressingMode* addrMode, uint32_t allowedModes) {
-	SLexerContext bm;
+	SLexerBookmark bm;
 	lex_Bookmark(&bm);
 
 	if ((allowedModes & MODE_IMMEDIATE) && lex_Context->token.id == '#')
@@ -60,6 +60,8 @@ static SConfiguration g_680x0Configuration = {
     m68k_AssignSection,
 
     m68k_IsValidLocalName,
+
+    m68k_RelaxSections,
 };
 
 extern int
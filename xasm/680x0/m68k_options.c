@@ -46,6 +46,7 @@ m68k_SetDefaults(SMachineOptions* options) {
 	options->fpu = 0;
 	options->platform = PLATFORM_GENERIC;
 	options->trackMovem = false;
+	options->relaxBranches = false;
 }
 
 void
@@ -160,6 +161,23 @@ m68k_ParseOption(const char* option) {
 			}
 			err_Warn(WARN_MACHINE_UNKNOWN_OPTION, option);
 			return false;
+		case 'r':
+			if (strlen(&option[1]) == 1) {
+				switch (option[1]) {
+					case 'y':
+					case 'Y':
+						opt_Current->machineOptions->relaxBranches = true;
+						return true;
+					case 'n':
+					case 'N':
+						opt_Current->machineOptions->relaxBranches = false;
+						return true;
+					default:
+						break;
+				}
+			}
+			err_Warn(WARN_MACHINE_UNKNOWN_OPTION, option);
+			return false;
 		default:
 			err_Warn(WARN_MACHINE_UNKNOWN_OPTION, option);
 			return false;
@@ -175,5 +193,6 @@ m68k_PrintOptions(void) {
 	       "                f - Foenix A2560K/X\n"
 	       "                g - Generic (default)\n"
 	       "                s - Sega Genesis/Mega Drive\n"
-	       "    -mm<X>  MOVEM updates regmask, <X> is y(es) or n(o) (default)\n");
+	       "    -mm<X>  MOVEM updates regmask, <X> is y(es) or n(o) (default)\n"
+	       "    -mr<X>  Shorten unsized branches, <X> is y(es) or n(o) (default)\n");
 }
@@ -29,6 +29,7 @@
 #include "m68k_errors.h"
 #include "m68k_options.h"
 #include "m68k_parse.h"
+#include "m68k_section.h"
 #include "m68k_symbols.h"
 #include "m68k_tokens.h"
 
@@ -446,6 +447,12 @@ handleBcc(ESize size, SAddressingMode* _src, SAddressingMode* _dest, uint16_t op
 	}
 
 	opcode = (uint16_t) 0x6000 | (opcode << 8);
+	if (size == SIZE_DEFAULT) {
+		if (opt_Current->machineOptions->relaxBranches && sect_Current != NULL && sect_Current->flags == 0)
+			m68k_AddRelaxableBranch(expr_Copy(target));
+		size = SIZE_WORD;
+	}
+
 	if (size == SIZE_BYTE) {
 		SExpression* expr = expr_CheckRange(expr_PcRelative(target, -2), -128, 127);
 		SExpression* assertion = expr_NotEqual(expr_Copy(expr), expr_Const(0));
@@ -483,6 +490,7 @@ handleBcc(ESize size, SAddressingMode* _src, SAddressingMode* _dest, uint16_t op
 		return true;
 	}
 
+	err_Error(MERROR_INSTRUCTION_SIZE);
 	return true;
 }
 
@@ -1798,7 +1806,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BCC
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0004,
 		AM_NONE,
 		AM_NONE,
@@ -1807,7 +1815,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BCS
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0005,
 		AM_NONE,
 		AM_NONE,
@@ -1816,7 +1824,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BEQ
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0007,
 		AM_NONE,
 		AM_NONE,
@@ -1825,7 +1833,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BGE
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x000C,
 		AM_NONE,
 		AM_NONE,
@@ -1834,7 +1842,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BGT
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x000E,
 		AM_NONE,
 		AM_NONE,
@@ -1843,7 +1851,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BHI
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0002,
 		AM_NONE,
 		AM_NONE,
@@ -1852,7 +1860,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BLE
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x000F,
 		AM_NONE, 
 		AM_NONE,
@@ -1861,7 +1869,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BLS
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0003,
 		AM_NONE,
 		AM_NONE,
@@ -1870,7 +1878,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BLT
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x000D,
 		AM_NONE,
 		AM_NONE,
@@ -1879,7 +1887,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BMI
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x000B,
 		AM_NONE,
 		AM_NONE,
@@ -1888,7 +1896,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BNE
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0006,
 		AM_NONE, 
 		AM_NONE,
@@ -1897,7 +1905,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BPL
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x000A,
 		AM_NONE, 
 		AM_NONE,
@@ -1906,7 +1914,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BVC
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0008,
 		AM_NONE, 
 		AM_NONE,
@@ -1915,7 +1923,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BVS
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0009,
 		AM_NONE, 
 		AM_NONE,
@@ -2023,7 +2031,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BRA
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0000,
 		AM_NONE, 
 		AM_NONE,
@@ -2041,7 +2049,7 @@ static SInstruction g_integerInstructions[T_68K_INTEGER_LAST - T_68K_INTEGER_FIR
 	},
 	{	// BSR
 		CPUF_ALL,
-		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_WORD,
+		SIZE_BYTE | SIZE_WORD | SIZE_LONG, SIZE_DEFAULT,
 		0x0001,
 		AM_NONE, 
 		AM_NONE,
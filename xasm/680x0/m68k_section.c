@@ -16,7 +16,163 @@
     along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mem.h"
+
+#include "expression.h"
+#include "section.h"
+
 #include "m68k_section.h"
 
+#define BRANCH_WORD_SIZE 2
+
+typedef struct RelaxableBranch {
+	SSection* section;
+	uint32_t offset; // offset of the opcode word
+	uint32_t targetOffset;
+	SExpression* target;
+	bool shortened;
+} SRelaxableBranch;
+
+static SRelaxableBranch* g_branches = NULL;
+static uint32_t g_totalBranches = 0;
+static uint32_t g_allocatedBranches = 0;
+
+//	Returns the number of bytes removed before the offset by shortening the branches at the opcode offsets
+static uint32_t
+removedBefore(const uint32_t* opcodeOffsets, uint32_t totalOffsets, uint32_t offset) {
+	uint32_t low = 0;
+	uint32_t high = totalOffsets;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+		if (opcodeOffsets[middle] + 2 * BRANCH_WORD_SIZE <= offset)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	uint32_t removed = low * BRANCH_WORD_SIZE;
+	if (low < totalOffsets && opcodeOffsets[low] + BRANCH_WORD_SIZE < offset)
+		removed += offset - (opcodeOffsets[low] + BRANCH_WORD_SIZE);
+	return removed;
+}
+
+//	Drops the branches that would be out of range, or branch to the following instruction, if all the remaining
+//	branches were shortened. Returns true if any branch was dropped.
+static bool
+dropOutOfRangeBranches(SRelaxableBranch** branches, uint32_t totalBranches, uint32_t* opcodeOffsets) {
+	uint32_t totalOffsets = 0;
+	for (uint32_t i = 0; i < totalBranches; ++i) {
+		if (branches[i]->shortened)
+			opcodeOffsets[totalOffsets++] = branches[i]->offset;
+	}
+
+	bool dropped = false;
+	for (uint32_t i = 0; i < totalBranches; ++i) {
+		SRelaxableBranch* branch = branches[i];
+		if (branch->shortened) {
+			int32_t target = (int32_t) (branch->targetOffset - removedBefore(opcodeOffsets, totalOffsets, branch->targetOffset));
+			int32_t pc = (int32_t) (branch->offset - removedBefore(opcodeOffsets, totalOffsets, branch->offset)) + BRANCH_WORD_SIZE;
+			int32_t displacement = target - pc;
+			if (displacement < -128 || displacement > 127 || displacement == 0) {
+				branch->shortened = false;
+				dropped = true;
+			}
+		}
+	}
+
+	return dropped;
+}
+
+static void
+relaxSection(SSection* section, SRelaxableBranch** branches, uint32_t totalBranches, uint32_t* offsets) {
+	for (uint32_t i = 0; i < totalBranches; ++i) {
+		SRelaxableBranch* branch = branches[i];
+		branch->shortened = branch->offset + BRANCH_WORD_SIZE >= section->alignedSpace &&
+		                    expr_GetSectionOffset(branch->target, section, &branch->targetOffset);
+	}
+
+	//	All branches start out short, and are made long again until they are all in range. A branch made long can only
+	//	push other branches out of range, so this terminates.
+	bool dropped;
+	do {
+		dropped = dropOutOfRangeBranches(branches, totalBranches, offsets);
+	} while (dropped);
+
+	uint32_t totalOffsets = 0;
+	for (uint32_t i = 0; i < totalBranches; ++i) {
+		if (branches[i]->shortened)
+			offsets[totalOffsets++] = branches[i]->offset;
+	}
+
+	for (uint32_t i = 0; i < totalBranches; ++i) {
+		SRelaxableBranch* branch = branches[i];
+		if (branch->shortened) {
+			uint32_t target = branch->targetOffset - removedBefore(offsets, totalOffsets, branch->targetOffset);
+			uint32_t pc = branch->offset - removedBefore(offsets, totalOffsets, branch->offset) + BRANCH_WORD_SIZE;
+			section->data[branch->offset + 1] = (uint8_t) (target - pc);
+		}
+	}
+
+	for (uint32_t i = 0; i < totalOffsets; ++i)
+		offsets[i] += BRANCH_WORD_SIZE;
+
+	sect_RemoveBytes(section, offsets, totalOffsets, BRANCH_WORD_SIZE);
+}
+
 extern void
 m68k_AssignSection(SSection* section) {}
+
+extern void
+m68k_AddRelaxableBranch(SExpression* target) {
+	if (g_totalBranches == g_allocatedBranches) {
+		g_allocatedBranches = g_allocatedBranches == 0 ? 64 : g_allocatedBranches * 2;
+		g_branches = (SRelaxableBranch*) mem_Realloc(g_branches, g_allocatedBranches * sizeof(SRelaxableBranch));
+	}
+
+	SRelaxableBranch* branch = &g_branches[g_totalBranches++];
+	branch->section = sect_Current;
+	branch->offset = sect_Current->usedSpace;
+	branch->targetOffset = 0;
+	branch->target = target;
+	branch->shortened = false;
+
+	if (sect_Current->firstShrinkable == UINT32_MAX)
+		sect_Current->firstShrinkable = sect_Current->cpuProgramCounter;
+	sect_Current->lastShrinkable = sect_Current->cpuProgramCounter;
+}
+
+extern void
+m68k_RelaxSections(void) {
+	if (g_totalBranches == 0)
+		return;
+
+	SRelaxableBranch** branches = (SRelaxableBranch**) mem_Alloc(g_totalBranches * sizeof(SRelaxableBranch*));
+	uint32_t* offsets = (uint32_t*) mem_Alloc(g_totalBranches * sizeof(uint32_t));
+
+	for (SSection* section = sect_Sections; section != NULL; section = list_GetNext(section)) {
+		if (section->flags != 0 || section->data == NULL)
+			continue;
+
+		uint32_t totalBranches = 0;
+		for (uint32_t i = 0; i < g_totalBranches; ++i) {
+			if (g_branches[i].section == section)
+				branches[totalBranches++] = &g_branches[i];
+		}
+
+		relaxSection(section, branches, totalBranches, offsets);
+	}
+
+	mem_Free(offsets);
+	mem_Free(branches);
+
+	for (uint32_t i = 0; i < g_totalBranches; ++i)
+		expr_Free(g_branches[i].target);
+
+	mem_Free(g_branches);
+	g_branches = NULL;
+	g_totalBranches = 0;
+	g_allocatedBranches = 0;
+}
@@ -19,9 +19,19 @@
 #ifndef XASM_68000_SECTION_H_INCLUDED_
 #define XASM_68000_SECTION_H_INCLUDED_
 
+#include "expression.h"
 #include "section.h"
 
 extern void
 m68k_AssignSection(SSection* section);
 
+//	Records that the word sized branch about to be output at the current location may be shortened, the section takes
+//	ownership of the target expression
+extern void
+m68k_AddRelaxableBranch(SExpression* target);
+
+//	Shortens the recorded branches whose targets are in range of a byte displacement
+extern void
+m68k_RelaxSections(void);
+
 #endif
@@ -62,6 +62,8 @@ static SConfiguration x10c_XasmConfiguration = {
     x10c_AssignSection,
 
     x10c_IsValidLocalName,
+
+    NULL,
 };
 
 extern int
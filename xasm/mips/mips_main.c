@@ -62,6 +62,8 @@ static SConfiguration g_xasmConfiguration = {
     mips_AssignSection,
 
     mips_IsValidLocalName,
+
+    NULL,
 };
 
 extern int
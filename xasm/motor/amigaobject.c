@@ -71,19 +71,17 @@ fputstr(const string* str, FILE* fileHandle, uint32_t flags) {
 }
 
 static void
-writeSymbolHunk(FILE* fileHandle, const SSection* section) {
+writeSymbolHunk(FILE* fileHandle, SSection* section) {
 	uint32_t symbolCount = 0;
 	off_t startPosition = ftello(fileHandle);
 
 	fputbl(HUNK_SYMBOL, fileHandle);
 
-	for (uint_fast16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (const SSymbol* symbol = sym_hashedSymbols[i]; symbol != NULL; symbol = list_GetNext(symbol)) {
-			if ((symbol->flags & SYMF_RELOC) != 0 && symbol->section == section) {
-				fputstr(symbol->name, fileHandle, 0);
-				fputbl((uint32_t) symbol->value.integer, fileHandle);
-				++symbolCount;
-			}
+	for (const SSymbol* symbol = sym_FirstSymbolInSection(section); symbol != NULL; symbol = sym_NextSymbolInSection(symbol)) {
+		if ((symbol->flags & SYMF_RELOC) != 0) {
+			fputstr(symbol->name, fileHandle, 0);
+			fputbl((uint32_t) symbol->value.integer, fileHandle);
+			++symbolCount;
 		}
 	}
 
@@ -94,7 +92,7 @@ writeSymbolHunk(FILE* fileHandle, const SSection* section) {
 }
 
 static void
-writeExtHunk(FILE* fileHandle, const SSection* section, SPatch* importPatches, off_t hunkPosition) {
+writeExtHunk(FILE* fileHandle, SSection* section, SPatch* importPatches, off_t hunkPosition) {
 	bool dataWritten = false;
 	off_t startPosition = ftello(fileHandle);
 
@@ -144,14 +142,12 @@ writeExtHunk(FILE* fileHandle, const SSection* section, SPatch* importPatches, o
 		}
 	}
 
-	for (uint_fast16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (SSymbol* symbol = sym_hashedSymbols[i]; symbol != NULL; symbol = list_GetNext(symbol)) {
-			if ((symbol->flags & (SYMF_RELOC | SYMF_EXPORT)) == (SYMF_RELOC | SYMF_EXPORT) && symbol->section == section) {
-				fputstr(symbol->name, fileHandle, EXT_DEF);
-				fputbl((uint32_t) symbol->value.integer, fileHandle);
+	for (SSymbol* symbol = sym_FirstSymbolInSection(section); symbol != NULL; symbol = sym_NextSymbolInSection(symbol)) {
+		if ((symbol->flags & (SYMF_RELOC | SYMF_EXPORT)) == (SYMF_RELOC | SYMF_EXPORT)) {
+			fputstr(symbol->name, fileHandle, EXT_DEF);
+			fputbl((uint32_t) symbol->value.integer, fileHandle);
 
-				dataWritten = true;
-			}
+			dataWritten = true;
 		}
 	}
 
@@ -0,0 +1,91 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// From util
+#include "mem.h"
+
+// From xasm
+#include "arena.h"
+
+#define ELEMENTS_PER_BLOCK 1024
+
+//	Elements are aligned for any member type, including long double
+#define ALIGNMENT 16
+
+typedef struct ArenaBlock {
+	struct ArenaBlock* next;
+} SArenaBlock;
+
+/* Internal functions */
+
+static size_t
+alignedSize(size_t size) {
+	return (size + ALIGNMENT - 1) & ~(size_t) (ALIGNMENT - 1);
+}
+
+static void
+allocBlock(SArena* arena) {
+	size_t elementSize = alignedSize(arena->elementSize);
+	size_t headerSize = alignedSize(sizeof(SArenaBlock));
+
+	SArenaBlock* block = (SArenaBlock*) mem_Alloc(headerSize + ELEMENTS_PER_BLOCK * elementSize);
+	block->next = arena->blocks;
+	arena->blocks = block;
+
+	arena->nextElement = (char*) block + headerSize;
+	arena->blockEnd = arena->nextElement + ELEMENTS_PER_BLOCK * elementSize;
+}
+
+/* Exported functions */
+
+extern void*
+arena_Alloc(SArena* arena) {
+	if (arena->freeElements != NULL) {
+		void* element = arena->freeElements;
+		arena->freeElements = *(void**) element;
+		return element;
+	}
+
+	if (arena->nextElement == arena->blockEnd)
+		allocBlock(arena);
+
+	void* element = arena->nextElement;
+	arena->nextElement += alignedSize(arena->elementSize);
+	return element;
+}
+
+extern void
+arena_Free(SArena* arena, void* element) {
+	if (element != NULL) {
+		*(void**) element = arena->freeElements;
+		arena->freeElements = element;
+	}
+}
+
+extern void
+arena_Release(SArena* arena) {
+	while (arena->blocks != NULL) {
+		SArenaBlock* next = arena->blocks->next;
+		mem_Free(arena->blocks);
+		arena->blocks = next;
+	}
+
+	arena->freeElements = NULL;
+	arena->nextElement = NULL;
+	arena->blockEnd = NULL;
+}
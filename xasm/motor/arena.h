@@ -0,0 +1,46 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XASM_MOTOR_ARENA_H_INCLUDED_
+#define XASM_MOTOR_ARENA_H_INCLUDED_
+
+#include <stddef.h>
+
+//	Allocates elements of one size from large blocks. Freed elements are reused by the following allocations, and all
+//	the blocks are released at once.
+typedef struct Arena {
+	size_t elementSize;
+	void* freeElements;
+	struct ArenaBlock* blocks;
+	char* nextElement;
+	char* blockEnd;
+} SArena;
+
+#define ARENA_INIT(type) {sizeof(type), NULL, NULL, NULL, NULL}
+
+extern void*
+arena_Alloc(SArena* arena);
+
+extern void
+arena_Free(SArena* arena, void* element);
+
+//	Releases all the elements allocated from the arena
+extern void
+arena_Release(SArena* arena);
+
+#endif /* XASM_MOTOR_ARENA_H_INCLUDED_ */
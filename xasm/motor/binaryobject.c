@@ -87,16 +87,14 @@ commonPatch(void) {
 		section = list_GetNext(section);
 	} while (section != NULL);
 
-	for (uint_fast16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (SSymbol* symbol = sym_hashedSymbols[i]; symbol != NULL; symbol = list_GetNext(symbol)) {
-			if (symbol->flags & SYMF_USED) {
-				if (symbol->type == SYM_IMPORT || symbol->type == SYM_GLOBAL) {
-					err_Fail(ERROR_SYMBOL_UNDEFINED, str_String(symbol->name));
-				} else if (symbol->flags & SYMF_RELOC) {
-					symbol->flags &= ~SYMF_RELOC;
-					symbol->flags |= SYMF_CONSTANT;
-					symbol->value.integer += symbol->section->cpuOrigin;
-				}
+	for (SSymbol* symbol = sym_FirstSymbol(); symbol != NULL; symbol = sym_NextSymbol(symbol)) {
+		if (symbol->flags & SYMF_USED) {
+			if (symbol->type == SYM_IMPORT || symbol->type == SYM_GLOBAL) {
+				err_Fail(ERROR_SYMBOL_UNDEFINED, str_String(symbol->name));
+			} else if (symbol->flags & SYMF_RELOC) {
+				symbol->flags &= ~SYMF_RELOC;
+				symbol->flags |= SYMF_CONSTANT;
+				symbol->value.integer += symbol->section->cpuOrigin;
 			}
 		}
 	}
@@ -0,0 +1,433 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+// From util
+#include "file.h"
+#include "set.h"
+#include "str.h"
+#include "strcoll.h"
+#include "vec.h"
+
+// From xasm
+#include "cache.h"
+#include "dependency.h"
+#include "includes.h"
+#include "symbol.h"
+
+#define CACHE_ID "XCA\2"
+
+#define HASH_INITIAL 0xCBF29CE484222325u
+#define HASH_PRIME   0x100000001B3u
+
+//	An entry is named after the hash of the key text and the contents of the source file. It holds:
+//
+//	  CACHE_ID, key text (the options, the source file name and the random seed)
+//	  number of time symbols read, followed by the name and value of every symbol
+//	  number of files read, followed by the name, size and hash of every file, the source file first
+//	  number of files looked for in the include paths that didn't exist, followed by their names
+//	  the output file
+
+/* Internal variables */
+
+static string* g_directory = NULL;
+static string* g_options = NULL;
+
+//	The key text and entry name of the source file being assembled, computed before assembly
+static string* g_keyText = NULL;
+static string* g_entryName = NULL;
+
+//	The symbols holding the time of assembly. A symbol keeps the value last read, it is NULL if never read.
+static const char* g_timeSymbols[] = {"__DATE", "__TIME", "__AMIGADATE"};
+
+#define TOTAL_TIME_SYMBOLS (sizeof(g_timeSymbols) / sizeof(g_timeSymbols[0]))
+
+/* Internal functions */
+
+//	FNV-1a
+static uint64_t
+hashData(uint64_t hash, const void* data, size_t size) {
+	const uint8_t* bytes = (const uint8_t*) data;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= HASH_PRIME;
+	}
+	return hash;
+}
+
+static string*
+readFile(const string* fileName) {
+	FILE* fileHandle = fopen(str_String(fileName), "rb");
+	if (fileHandle == NULL)
+		return NULL;
+
+	string* content = str_ReadFile(fileHandle, fsize(fileHandle));
+	fclose(fileHandle);
+
+	return content;
+}
+
+static bool
+hashFile(const string* fileName, uint32_t* size, uint64_t* hash) {
+	string* content = readFile(fileName);
+	if (content == NULL)
+		return false;
+
+	*size = (uint32_t) str_Length(content);
+	*hash = hashData(HASH_INITIAL, str_String(content), str_Length(content));
+	str_Free(content);
+
+	return true;
+}
+
+static string*
+createKeyText(const string* sourcePath) {
+	return str_CreateFormat("%s\n%s\n%08X", str_String(g_options), str_String(sourcePath), s_randseed);
+}
+
+static string*
+createEntryName(const string* keyText, const string* sourcePath) {
+	string* content = readFile(sourcePath);
+	if (content == NULL)
+		return NULL;
+
+	uint64_t hash = hashData(HASH_INITIAL, str_String(keyText), str_Length(keyText) + 1);
+	hash = hashData(hash, str_String(content), str_Length(content));
+	str_Free(content);
+
+	return str_CreateFormat("%s%08X%08X.xcache", str_String(g_directory), (uint32_t) (hash >> 32u), (uint32_t) hash);
+}
+
+static void
+writeString(FILE* fileHandle, const string* str) {
+	fputll((uint32_t) str_Length(str), fileHandle);
+	fwrite(str_String(str), 1, str_Length(str), fileHandle);
+}
+
+//	Returns the string, or NULL if the entry is truncated
+static string*
+readString(FILE* fileHandle, size_t fileSize) {
+	uint32_t length = fgetll(fileHandle);
+	if (feof(fileHandle) || length > fileSize)
+		return NULL;
+
+	string* result = str_ReadFile(fileHandle, length);
+	if (str_Length(result) != length) {
+		str_Free(result);
+		return NULL;
+	}
+	return result;
+}
+
+static void
+writeTimeSymbols(FILE* fileHandle) {
+	SSymbol* symbols[TOTAL_TIME_SYMBOLS];
+	uint32_t totalSymbols = 0;
+
+	for (size_t i = 0; i < TOTAL_TIME_SYMBOLS; ++i) {
+		string* name = str_Create(g_timeSymbols[i]);
+		if (sym_IsDefined(name)) {
+			SSymbol* symbol = sym_GetSymbol(name);
+			if (symbol->callback.string != NULL && symbol->value.macro != NULL)
+				symbols[totalSymbols++] = symbol;
+		}
+		str_Free(name);
+	}
+
+	fputll(totalSymbols, fileHandle);
+	for (uint32_t i = 0; i < totalSymbols; ++i) {
+		writeString(fileHandle, symbols[i]->name);
+		writeString(fileHandle, symbols[i]->value.macro);
+	}
+}
+
+//	The time symbols read by the assembly must have the same values now
+static bool
+readTimeSymbols(FILE* fileHandle, size_t fileSize) {
+	bool upToDate = true;
+
+	uint32_t totalSymbols = fgetll(fileHandle);
+	for (uint32_t i = 0; i < totalSymbols && upToDate; ++i) {
+		string* name = readString(fileHandle, fileSize);
+		string* value = readString(fileHandle, fileSize);
+
+		string* currentValue = NULL;
+		if (name != NULL && value != NULL && sym_IsDefined(name))
+			sym_GetStringSymbolValueByName(&currentValue, name);
+
+		upToDate = currentValue != NULL && str_Equal(currentValue, value);
+
+		str_Free(currentValue);
+		str_Free(value);
+		str_Free(name);
+	}
+
+	return upToDate && !feof(fileHandle);
+}
+
+static void
+collectDependency(set_t* _, intptr_t element, intptr_t data) {
+	vec_t* fileNames = (vec_t*) data;
+	const string* fileName = (const string*) element;
+	if (!str_Equal(fileName, strvec_StringAt(fileNames, 0)))
+		strvec_PushBack(fileNames, fileName);
+}
+
+//	Returns false if a file cannot be read
+static bool
+writeFiles(FILE* fileHandle, const string* sourcePath, set_t* dependencies) {
+	vec_t* fileNames = strvec_Create();
+	strvec_PushBack(fileNames, sourcePath);
+	set_ForEachElement(dependencies, collectDependency, (intptr_t) fileNames);
+
+	bool written = true;
+	fputll((uint32_t) strvec_Count(fileNames), fileHandle);
+	for (size_t i = 0; i < strvec_Count(fileNames); ++i) {
+		uint32_t size = 0;
+		uint64_t hash = 0;
+		if (!hashFile(strvec_StringAt(fileNames, i), &size, &hash)) {
+			written = false;
+			break;
+		}
+
+		writeString(fileHandle, strvec_StringAt(fileNames, i));
+		fputll(size, fileHandle);
+		fputll((uint32_t) hash, fileHandle);
+		fputll((uint32_t) (hash >> 32u), fileHandle);
+	}
+
+	strvec_Free(fileNames);
+	return written;
+}
+
+//	The files read by the assembly must be unchanged. Returns the names of the files, or NULL.
+static vec_t*
+readFiles(FILE* fileHandle, size_t fileSize) {
+	vec_t* fileNames = strvec_Create();
+	bool upToDate = true;
+
+	uint32_t totalFiles = fgetll(fileHandle);
+	for (uint32_t i = 0; i < totalFiles && upToDate; ++i) {
+		string* name = readString(fileHandle, fileSize);
+		uint32_t size = fgetll(fileHandle);
+		uint64_t hash = fgetll(fileHandle);
+		hash |= (uint64_t) fgetll(fileHandle) << 32u;
+
+		uint32_t currentSize;
+		uint64_t currentHash;
+		upToDate = name != NULL && !feof(fileHandle) && hashFile(name, &currentSize, &currentHash) && currentSize == size &&
+		           currentHash == hash;
+
+		if (upToDate)
+			strvec_PushBack(fileNames, name);
+		str_Free(name);
+	}
+
+	if (!upToDate || totalFiles == 0) {
+		strvec_Free(fileNames);
+		return NULL;
+	}
+
+	return fileNames;
+}
+
+static void
+countMissingFile(const string* fileName, intptr_t data) {
+	++*(uint32_t*) data;
+}
+
+static void
+writeMissingFile(const string* fileName, intptr_t data) {
+	writeString((FILE*) data, fileName);
+}
+
+static void
+writeMissingFiles(FILE* fileHandle) {
+	uint32_t totalFiles = 0;
+	inc_ForEachMissingFile(countMissingFile, (intptr_t) &totalFiles);
+
+	fputll(totalFiles, fileHandle);
+	inc_ForEachMissingFile(writeMissingFile, (intptr_t) fileHandle);
+}
+
+//	A file that now exists where the assembly didn't find one could be included instead of the file that was
+static bool
+readMissingFiles(FILE* fileHandle, size_t fileSize) {
+	bool upToDate = true;
+
+	uint32_t totalFiles = fgetll(fileHandle);
+	for (uint32_t i = 0; i < totalFiles && upToDate; ++i) {
+		string* name = readString(fileHandle, fileSize);
+		upToDate = name != NULL && !fexists(str_String(name));
+		str_Free(name);
+	}
+
+	return upToDate && !feof(fileHandle);
+}
+
+static bool
+writeOutput(const string* outputFilename, const string* output) {
+	FILE* fileHandle = fopen(str_String(outputFilename), "wb");
+	if (fileHandle == NULL)
+		return false;
+
+	bool written = fwrite(str_String(output), 1, str_Length(output), fileHandle) == str_Length(output);
+	written = fclose(fileHandle) == 0 && written;
+
+	if (!written)
+		remove(str_String(outputFilename));
+
+	return written;
+}
+
+static bool
+restoreEntry(FILE* fileHandle, const string* keyText, const string* outputFilename) {
+	size_t fileSize = fsize(fileHandle);
+
+	char id[4];
+	if (fread(id, 1, sizeof(id), fileHandle) != sizeof(id) || memcmp(id, CACHE_ID, sizeof(id)) != 0)
+		return false;
+
+	//	The entry is named after a hash, the key text must match exactly
+	string* entryKeyText = readString(fileHandle, fileSize);
+	bool sameKey = entryKeyText != NULL && str_Equal(entryKeyText, keyText);
+	str_Free(entryKeyText);
+
+	if (!sameKey || !readTimeSymbols(fileHandle, fileSize))
+		return false;
+
+	vec_t* fileNames = readFiles(fileHandle, fileSize);
+	if (fileNames == NULL)
+		return false;
+
+	if (!readMissingFiles(fileHandle, fileSize)) {
+		strvec_Free(fileNames);
+		return false;
+	}
+
+	string* output = readString(fileHandle, fileSize);
+	bool restored = output != NULL && writeOutput(outputFilename, output);
+
+	if (restored) {
+		for (size_t i = 0; i < strvec_Count(fileNames); ++i)
+			dep_AddDependency(strvec_StringAt(fileNames, i));
+	}
+
+	str_Free(output);
+	strvec_Free(fileNames);
+
+	return restored;
+}
+
+/* Exported functions */
+
+extern void
+cache_Initialize(const char* directory, const string* options) {
+	size_t length = strlen(directory);
+	if (length > 0 && directory[length - 1] != '/' && directory[length - 1] != '\\')
+		g_directory = str_CreateFormat("%s/", directory);
+	else
+		g_directory = str_Create(directory);
+
+	str_Assign(&g_options, options);
+}
+
+extern void
+cache_Exit(void) {
+	str_Free(g_directory);
+	str_Free(g_options);
+	str_Free(g_keyText);
+	str_Free(g_entryName);
+	g_directory = NULL;
+	g_options = NULL;
+	g_keyText = NULL;
+	g_entryName = NULL;
+}
+
+extern bool
+cache_Restore(const string* sourcePath, const string* outputFilename) {
+	if (g_directory == NULL)
+		return false;
+
+	//	The files read must be known to store the result
+	if (dep_Dependencies() == NULL)
+		dep_Initialize(NULL);
+
+	str_Free(g_keyText);
+	str_Free(g_entryName);
+	g_keyText = createKeyText(sourcePath);
+	g_entryName = createEntryName(g_keyText, sourcePath);
+
+	bool restored = false;
+	if (g_entryName != NULL) {
+		FILE* fileHandle = fopen(str_String(g_entryName), "rb");
+		if (fileHandle != NULL) {
+			restored = restoreEntry(fileHandle, g_keyText, outputFilename);
+			fclose(fileHandle);
+		}
+	}
+
+	return restored;
+}
+
+extern void
+cache_Store(const string* sourcePath, const string* outputFilename) {
+	set_t* dependencies = dep_Dependencies();
+	if (g_entryName == NULL || dependencies == NULL)
+		return;
+
+	string* output = readFile(outputFilename);
+	if (output == NULL)
+		return;
+
+	//	Assemblies running at the same time may store the same entry, each writes a file of its own and renames it
+	string* tempName = str_CreateFormat("%s.%d.tmp", str_String(g_entryName), (int) getpid());
+	FILE* fileHandle = fopen(str_String(tempName), "wb");
+	if (fileHandle != NULL) {
+		fwrite(CACHE_ID, 1, 4, fileHandle);
+		writeString(fileHandle, g_keyText);
+		writeTimeSymbols(fileHandle);
+		bool written = writeFiles(fileHandle, sourcePath, dependencies);
+		writeMissingFiles(fileHandle);
+		writeString(fileHandle, output);
+
+		written = ferror(fileHandle) == 0 && written;
+		written = fclose(fileHandle) == 0 && written;
+
+#if defined(_WIN32)
+		if (written)
+			remove(str_String(g_entryName));
+#endif
+		if (!written || rename(str_String(tempName), str_String(g_entryName)) != 0)
+			remove(str_String(tempName));
+	}
+
+	str_Free(tempName);
+	str_Free(output);
+}
@@ -0,0 +1,44 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XASM_MOTOR_CACHE_H_INCLUDED_
+#define XASM_MOTOR_CACHE_H_INCLUDED_
+
+#include <stdbool.h>
+
+#include "str.h"
+
+//	Enables the cache of assembly results in the directory. The options must be the text of all options that affect the
+//	output.
+extern void
+cache_Initialize(const char* directory, const string* options);
+
+extern void
+cache_Exit(void);
+
+//	Writes the output file stored for the source file, if the source file and all the files it read are unchanged, and
+//	records the files read as dependencies. Returns false if there is no such result.
+extern bool
+cache_Restore(const string* sourcePath, const string* outputFilename);
+
+//	Stores the output file written by the assembly of the source file, cache_Restore must have been called before the
+//	assembly. Dependencies must have been recorded.
+extern void
+cache_Store(const string* sourcePath, const string* outputFilename);
+
+#endif /* XASM_MOTOR_CACHE_H_INCLUDED_ */
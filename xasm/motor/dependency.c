@@ -50,7 +50,7 @@ writeTarget(set_t* _, intptr_t element, intptr_t data) {
 
 extern void
 dep_Initialize(const char* outputFileName) {
-	g_outputFilename = str_Create(outputFileName);
+	g_outputFilename = outputFileName != NULL ? str_Create(outputFileName) : NULL;
 	g_dependencySet = strset_Create();
 }
 
@@ -84,9 +84,19 @@ dep_AddDependency(const string* filename) {
 	}
 }
 
+extern const string*
+dep_MainDependency(void) {
+	return g_mainDependency;
+}
+
+extern set_t*
+dep_Dependencies(void) {
+	return g_dependencySet;
+}
+
 extern void
 dep_WriteDependencyFile(void) {
-	if (g_dependencySet != NULL) {
+	if (g_dependencySet != NULL && g_outputFilename != NULL) {
 		FILE* fileHandle = fopen(str_String(g_outputFilename), "wt");
 		if (fileHandle != NULL) {
 			fprintf(fileHandle, "%s:", str_String(g_mainOutput));
@@ -19,8 +19,10 @@
 #ifndef XASM_MOTOR_DEPENDENCY_H_INCLUDED_
 #define XASM_MOTOR_DEPENDENCY_H_INCLUDED_
 
+#include "set.h"
 #include "str.h"
 
+//	Starts recording the files read. The dependency file is only written if outputFileName is not NULL.
 extern void
 dep_Initialize(const char* outputFileName);
 
@@ -36,6 +38,14 @@ dep_SetMainOutput(const string* filename);
 extern void
 dep_AddDependency(const string* filename);
 
+//	Returns the name of the first file read, or NULL
+extern const string*
+dep_MainDependency(void);
+
+//	Returns the names of the files read, or NULL if dependencies are not recorded
+extern set_t*
+dep_Dependencies(void);
+
 extern void
 dep_WriteDependencyFile(void);
 
@@ -244,22 +244,20 @@ writeSymbol(const string* name, e_addr_t value, uint8_t bind, uint8_t type, e_ha
 
 static uint32_t
 writeGlobalSymbols(FILE* fileHandle, uint32_t symbolIndex) {
-	for (uint16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (SSymbol* symbol = sym_hashedSymbols[i]; symbol != NULL; symbol = list_GetNext(symbol)) {
-			if ((symbol->id == 0) &&
-			    (symbol->type == SYM_LABEL || symbol->type == SYM_EQU || symbol->type == SYM_IMPORT ||
-			     symbol->type == SYM_GLOBAL) &&
-			    ((symbol->flags & (SYMF_RELOC | SYMF_USED | SYMF_EXPORT)) != 0)) {
-
-				e_half_t sectionIndex = symbol->flags & SYMF_CONSTANT //
-				                            ? SHN_ABS
-				                            : symbol->type == SYM_GLOBAL || symbol->type == SYM_IMPORT //
-				                                  ? SHN_UNDEF                                          //
-				                                  : symbol->section->id;
-
-				writeSymbol(symbol->name, symbol->value.integer, STB_GLOBAL, STT_NOTYPE, sectionIndex, fileHandle);
-				symbol->id = symbolIndex++;
-			}
+	for (SSymbol* symbol = sym_FirstSymbol(); symbol != NULL; symbol = sym_NextSymbol(symbol)) {
+		if ((symbol->id == 0) &&
+		    (symbol->type == SYM_LABEL || symbol->type == SYM_EQU || symbol->type == SYM_IMPORT ||
+		     symbol->type == SYM_GLOBAL) &&
+		    ((symbol->flags & (SYMF_RELOC | SYMF_USED | SYMF_EXPORT)) != 0)) {
+
+			e_half_t sectionIndex = symbol->flags & SYMF_CONSTANT //
+			                            ? SHN_ABS
+			                            : symbol->type == SYM_GLOBAL || symbol->type == SYM_IMPORT //
+			                                  ? SHN_UNDEF                                          //
+			                                  : symbol->section->id;
+
+			writeSymbol(symbol->name, symbol->value.integer, STB_GLOBAL, STT_NOTYPE, sectionIndex, fileHandle);
+			symbol->id = symbolIndex++;
 		}
 	}
 	return symbolIndex;
@@ -267,18 +265,16 @@ writeGlobalSymbols(FILE* fileHandle, uint32_t symbolIndex) {
 
 static uint32_t
 writeLocalSymbols(FILE* fileHandle, uint32_t symbolIndex) {
-	for (uint16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (SSymbol* symbol = sym_hashedSymbols[i]; symbol != NULL; symbol = list_GetNext(symbol)) {
-			if ((symbol->id == 0) &&                                                    //
-			    (symbol->type == SYM_LABEL || symbol->type == SYM_EQU)                  //
-			    && ((symbol->flags & (SYMF_RELOC | SYMF_USED | SYMF_FILE_EXPORT)) != 0) //
-			    && ((symbol->flags & SYMF_EXPORT) == 0)) {
-
-				e_half_t sectionIndex = symbol->flags & SYMF_CONSTANT ? SHN_ABS : symbol->section->id;
-
-				writeSymbol(symbol->name, symbol->value.integer, STB_LOCAL, STT_NOTYPE, sectionIndex, fileHandle);
-				symbol->id = symbolIndex++;
-			}
+	for (SSymbol* symbol = sym_FirstSymbol(); symbol != NULL; symbol = sym_NextSymbol(symbol)) {
+		if ((symbol->id == 0) &&                                                    //
+		    (symbol->type == SYM_LABEL || symbol->type == SYM_EQU)                  //
+		    && ((symbol->flags & (SYMF_RELOC | SYMF_USED | SYMF_FILE_EXPORT)) != 0) //
+		    && ((symbol->flags & SYMF_EXPORT) == 0)) {
+
+			e_half_t sectionIndex = symbol->flags & SYMF_CONSTANT ? SHN_ABS : symbol->section->id;
+
+			writeSymbol(symbol->name, symbol->value.integer, STB_LOCAL, STT_NOTYPE, sectionIndex, fileHandle);
+			symbol->id = symbolIndex++;
 		}
 	}
 	return symbolIndex;
@@ -485,10 +481,8 @@ writeSections(FILE* fileHandle) {
 static void
 prepareSymbols(void) {
 	// Reset all symbols id's
-	for (uint16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (SSymbol* symbol = sym_hashedSymbols[i]; symbol != NULL; symbol = list_GetNext(symbol)) {
-			symbol->id = 0;
-		}
+	for (SSymbol* symbol = sym_FirstSymbol(); symbol != NULL; symbol = sym_NextSymbol(symbol)) {
+		symbol->id = 0;
 	}
 }
 
@@ -116,6 +116,8 @@ static char* g_errors[] = {
     "Invalid outside structure scope",
     "Cannot modify internal symbol %s",
     "Section %s size exceeds page size",
+    "Option \"%s\" cannot be used when assembling several files",
+    "Unable to start assembling \"%s\"",
 };
 
 static const char*
@@ -247,7 +249,7 @@ printError(const SPatch* patch, const SSymbol* symbol, char severity, size_t err
 
 	if (patch != NULL) {
 		lineNumber = patch->lineNumber;
-		strbuf_AppendFormat(buf, "%s:%d: ", str_String(patch->filename), lineNumber);
+		strbuf_AppendFormat(buf, "%s:%d: ", str_String(patch->fileInfo->fileName), lineNumber);
 	} else if (symbol != NULL) {
 		lineNumber = symbol->lineNumber;
 		strbuf_AppendFormat(buf, "%s:%d: ", str_String(symbol->fileInfo->fileName), lineNumber);
@@ -371,5 +373,8 @@ err_PrintAll(void) {
 		}
 	}
 	freeMessages(&g_allMessages);
+	initializeMessages(&g_allMessages);
+
 	str_Free(g_lastErrorString);
+	g_lastErrorString = NULL;
 }
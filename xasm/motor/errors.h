@@ -98,7 +98,9 @@ typedef enum {
 	ERROR_ELF_LOAD_ZERO,
 	ERROR_NOT_IN_STRUCTURE_SCOPE,
 	ERROR_MODIFY_INTERNAL_SYMBOL,
-	ERROR_SECTION_SIZE_EXCEEDS_PAGE
+	ERROR_SECTION_SIZE_EXCEEDS_PAGE,
+	ERROR_BATCH_OPTION,
+	ERROR_BATCH_START
 } EError;
 
 extern bool
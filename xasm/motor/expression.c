@@ -27,6 +27,7 @@
 #include "str.h"
 
 // From xasm
+#include "arena.h"
 #include "errors.h"
 #include "expression.h"
 #include "section.h"
@@ -34,8 +35,15 @@
 #include "tokens.h"
 #include "xasm.h"
 
+static SArena g_expressions = ARENA_INIT(SExpression);
+
 /* Internal functions */
 
+static SExpression*
+allocExpression(void) {
+	return (SExpression*) arena_Alloc(&g_expressions);
+}
+
 static bool
 getSymbolSectionOffset(const SExpression* expression, const SSection* section, uint32_t* resultOffset) {
 	SSymbol* symbol = expression->value.symbol;
@@ -91,7 +99,7 @@ getSymbolSectionOffset(const SExpression* expression, const SSection* section, u
 	SExpression* expr_##NAME(SExpression* expr) {                       \
 		if (!assertExpression(expr))                                    \
 			return NULL;                                                \
-		SExpression* r = (SExpression*) mem_Alloc(sizeof(SExpression)); \
+		SExpression* r = allocExpression();                             \
 		r->right = expr;                                                \
 		r->left = NULL;                                                 \
 		r->value.integer = FUNC(expr->value.integer);                   \
@@ -143,7 +151,7 @@ mergeExpressions(SExpression* left, SExpression* right, EToken operation) {
 	if (!assertExpressions(left, right))
 		return NULL;
 
-	expr = (SExpression*) mem_Alloc(sizeof(SExpression));
+	expr = allocExpression();
 
 	expr->isConstant = left->isConstant && right->isConstant;
 	expr->left = left;
@@ -221,7 +229,7 @@ expr_Parens(SExpression* expression) {
 	if (!assertExpression(expression))
 		return NULL;
 
-	SExpression* r = (SExpression*) mem_Alloc(sizeof(SExpression));
+	SExpression* r = allocExpression();
 	r->right = expression;
 	r->left = NULL;
 	r->value.integer = expression->value.integer;
@@ -243,7 +251,7 @@ expr_Bit(SExpression* right) {
 		return NULL;
 	}
 
-	SExpression* r = (SExpression*) mem_Alloc(sizeof(SExpression));
+	SExpression* r = allocExpression();
 	r->right = right;
 	r->left = NULL;
 	r->value.integer = log2n(v);
@@ -267,7 +275,7 @@ expr_PcRelative(SExpression* expression, int adjustment) {
 		    expression,                                                                                                      //
 		    expr_Const(adjustment - (sect_Current->cpuProgramCounter + sect_Current->cpuOrigin + sect_Current->cpuAdjust))); //
 	} else {
-		SExpression* r = (SExpression*) mem_Alloc(sizeof(SExpression));
+		SExpression* r = allocExpression();
 
 		r->value.integer = 0;
 		r->type = EXPR_PC_RELATIVE;
@@ -287,7 +295,7 @@ expr_Pc(void) {
 	if (symbol == NULL)
 		return NULL;
 
-	SExpression* r = (SExpression*) mem_Alloc(sizeof(SExpression));
+	SExpression* r = allocExpression();
 
 	if (symbol->flags & SYMF_CONSTANT) {
 		r->value.integer = symbol->value.integer;
@@ -308,12 +316,31 @@ expr_Pc(void) {
 
 SExpression*
 expr_Const(int32_t value) {
-	SExpression* r = (SExpression*) mem_Alloc(sizeof(SExpression));
+	SExpression* r = allocExpression();
 	expr_SetConst(r, value);
 
 	return r;
 }
 
+//	Returns true if an instruction that may still shrink could lie between the two labels, the distance between them is
+//	then not known until the section has been relaxed. Both labels are already defined, so every instruction that could
+//	lie between them has been recorded. When both labels are at or before the first such instruction, or both are after
+//	the last one, they move together.
+static bool
+isShrinkableBetween(const SSymbol* first, const SSymbol* second) {
+	const SSection* section = first->section;
+	if (section == NULL || section->firstShrinkable == UINT32_MAX)
+		return false;
+
+	uint32_t firstOffset = (uint32_t) first->value.integer;
+	uint32_t secondOffset = (uint32_t) second->value.integer;
+
+	if (firstOffset <= section->firstShrinkable && secondOffset <= section->firstShrinkable)
+		return false;
+
+	return firstOffset <= section->lastShrinkable || secondOffset <= section->lastShrinkable;
+}
+
 SExpression*
 expr_Sub(SExpression* left, SExpression* right) {
 	if (!assertExpressions(left, right))
@@ -329,7 +356,8 @@ expr_Sub(SExpression* left, SExpression* right) {
 	    isSymbol(left->right) &&                                                //
 	    left->left->value.symbol->section == left->right->value.symbol->section //
 	    && left->left->value.symbol->type == SYM_LABEL                          //
-	    && left->right->value.symbol->type == SYM_LABEL) {
+	    && left->right->value.symbol->type == SYM_LABEL                         //
+	    && !isShrinkableBetween(left->left->value.symbol, left->right->value.symbol)) {
 		int32_t newValue = left->left->value.symbol->value.integer - left->right->value.symbol->value.integer;
 		expr_Free(left);
 		return expr_Const(newValue);
@@ -387,7 +415,7 @@ SExpression*
 expr_Bank(SSymbol* symbol) {
 	assert(xasm_Configuration->supportBanks);
 
-	SExpression* r = (SExpression*) mem_Alloc(sizeof(SExpression));
+	SExpression* r = allocExpression();
 	r->right = NULL;
 	r->left = NULL;
 	r->value.symbol = symbol;
@@ -404,7 +432,7 @@ expr_Symbol(SSymbol* symbol) {
 		if (symbol->flags & SYMF_CONSTANT) {
 			return expr_Const(sym_GetValue(symbol));
 		} else {
-			SExpression* r = (SExpression*) mem_Alloc(sizeof(SExpression));
+			SExpression* r = allocExpression();
 
 			r->right = NULL;
 			r->left = NULL;
@@ -452,7 +480,7 @@ expr_Free(SExpression* expression) {
 	if (expression != NULL) {
 		expr_Free(expression->left);
 		expr_Free(expression->right);
-		mem_Free(expression);
+		arena_Free(&g_expressions, expression);
 	}
 }
 
@@ -461,7 +489,7 @@ expr_Copy(SExpression* expression) {
 	if (expression == NULL)
 		return NULL;
 
-	SExpression* r = (SExpression*) mem_Alloc(sizeof(SExpression));
+	SExpression* r = allocExpression();
 	r->isConstant = expression->isConstant;
 	r->left = expr_Copy(expression->left);
 	r->right = expr_Copy(expression->right);
@@ -538,7 +566,7 @@ expr_Clone(SExpression* expression) {
 	if (expression == NULL)
 		return NULL;
 
-	SExpression* result = (SExpression*) mem_Alloc(sizeof(SExpression));
+	SExpression* result = allocExpression();
 	result->isConstant = expression->isConstant;
 	result->operation = expression->operation;
 	result->type = expression->type;
@@ -560,7 +588,7 @@ expr_Optimize(SExpression* expression) {
 	if (expr_Type(expression) == EXPR_PARENS) {
 		SExpression* pToFree = expression->right;
 		*expression = *(expression->right);
-		mem_Free(pToFree);
+		arena_Free(&g_expressions, pToFree);
 	}
 
 	if ((expression->type == EXPR_SYMBOL) && (expression->value.symbol->flags & SYMF_CONSTANT)) {
@@ -641,3 +669,8 @@ expr_GetSymbolOffset(uint32_t* resultOffset, SSymbol** resultSymbol, SExpression
 	*resultSymbol = NULL;
 	return getSymbolOffset(resultOffset, resultSymbol, expression, isSymbolic);
 }
+
+void
+expr_Exit(void) {
+	arena_Release(&g_expressions);
+}
@@ -214,4 +214,8 @@ expr_GetImportOffset(uint32_t* resultOffset, SSymbol** resultSymbol, SExpression
 extern bool
 expr_GetSymbolOffset(uint32_t* resultOffset, SSymbol** resultSymbol, SExpression* expression);
 
+//	Releases the memory of all expressions
+extern void
+expr_Exit(void);
+
 #endif /* XASM_MOTOR_EXPRESSION_H_INCLUDED_ */
@@ -17,7 +17,10 @@
 */
 
 // From util
+#include "crc32.h"
 #include "file.h"
+#include "map.h"
+#include "mem.h"
 #include "str.h"
 #include "strcoll.h"
 #include "types.h"
@@ -26,12 +29,61 @@
 // From xasm
 #include "includes.h"
 #include "lexer_context.h"
+#include "options.h"
 
 /* Internal variables */
 
 static vec_t* g_includePaths;
 
+static strmap_t* g_fileExists = NULL;
+static strmap_t* g_files = NULL;
+static strmap_t* g_binaryFiles = NULL;
+
 /* Private functions */
+
+static void
+freeNothing(intptr_t userData, intptr_t element) {}
+
+static void
+freeBinaryFile(intptr_t userData, intptr_t element) {
+	str_Free((string*) element);
+}
+
+static void
+freeFile(intptr_t userData, intptr_t element) {
+	SIncludeFile* file = (SIncludeFile*) element;
+	str_Free(file->name);
+	str_Free(file->content);
+	str_Free(file->guardSymbol);
+	mem_Free(file);
+}
+
+//	The include paths are probed for every file included, the results are remembered
+static bool
+fileExists(const string* fileName) {
+	if (g_fileExists == NULL)
+		g_fileExists = strmap_Create(freeNothing);
+
+	intptr_t exists;
+	if (!strmap_Value(g_fileExists, fileName, &exists)) {
+		exists = fexists(str_String(fileName));
+		strmap_Insert(g_fileExists, (string*) fileName, exists);
+	}
+	return exists != 0;
+}
+
+static string*
+readFile(const string* fileName, size_t* size) {
+	FILE* fileHandle = fopen(str_String(fileName), "rb");
+	if (fileHandle == NULL)
+		return NULL;
+
+	*size = fsize(fileHandle);
+	string* content = str_ReadFile(fileHandle, *size);
+	fclose(fileHandle);
+
+	return content;
+}
 static void
 buildFilename(string** dest, const string* workingName, const string* fileName) {
 	if (workingName == NULL) {
@@ -71,27 +123,27 @@ inc_FindFile(string** dest, const string* fileName) {
 	string* candidate = NULL;
 	buildFilename(&candidate, workingName, fileName);
 	if (candidate != NULL) {
-		if (fexists(str_String(candidate))) {
+		if (fileExists(candidate)) {
 			str_Move(dest, &candidate);
 			return;
 		}
-		str_Free(candidate);
+		str_Clear(&candidate);
 	}
 
 	if (g_includePaths != NULL) {
 		for (size_t count = 0; count < strvec_Count(g_includePaths); ++count) {
 			appendFilename(&candidate, strvec_StringAt(g_includePaths, count), fileName);
 
-			if (fexists(str_String(candidate))) {
+			if (fileExists(candidate)) {
 				str_Move(dest, &candidate);
 				return;
 			}
-			str_Free(candidate);
+			str_Clear(&candidate);
 		}
 	}
 
 	if (workingName == NULL) {
-		if (fexists(str_String(fileName))) {
+		if (fileExists(fileName)) {
 			string* r = fcanonicalizePath(fileName);
 			str_Move(dest, &r);
 			return;
@@ -117,3 +169,99 @@ inc_AddIncludePath(const string* pathname) {
 		strvec_PushBack(g_includePaths, pathname);
 	}
 }
+
+extern SIncludeFile*
+inc_ReadFile(const string* fileName) {
+	if (g_files == NULL)
+		g_files = strmap_Create(freeFile);
+
+	intptr_t value;
+	if (strmap_Value(g_files, fileName, &value))
+		return (SIncludeFile*) value;
+
+	size_t size;
+	string* fileContent = readFile(fileName, &size);
+	if (fileContent == NULL)
+		return NULL;
+
+	SIncludeFile* file = (SIncludeFile*) mem_Alloc(sizeof(SIncludeFile));
+	file->name = NULL;
+	str_Assign(&file->name, fileName);
+	file->content = str_CanonicalizeLineEndings(fileContent);
+	file->hasCrc32 = opt_Current->enableDebugInfo;
+	file->crc32 = file->hasCrc32 ? crc32((const uint8_t*) str_String(fileContent), size) : 0;
+	file->guardSymbol = NULL;
+	file->guardKeywordsGeneration = 0;
+	file->hasGuardSymbol = false;
+
+	str_Free(fileContent);
+
+	strmap_Insert(g_files, file->name, (intptr_t) file);
+	return file;
+}
+
+extern const string*
+inc_ReadBinaryFile(const string* fileName) {
+	if (g_binaryFiles == NULL)
+		g_binaryFiles = strmap_Create(freeBinaryFile);
+
+	intptr_t value;
+	if (strmap_Value(g_binaryFiles, fileName, &value))
+		return (const string*) value;
+
+	size_t size;
+	string* content = readFile(fileName, &size);
+	if (content != NULL)
+		strmap_Insert(g_binaryFiles, (string*) fileName, (intptr_t) content);
+
+	return content;
+}
+
+typedef struct {
+	void (*function)(const string* fileName, intptr_t data);
+	intptr_t data;
+} SMissingFileCallback;
+
+static void
+callMissingFile(map_t* map, intptr_t key, intptr_t value, intptr_t data) {
+	SMissingFileCallback* callback = (SMissingFileCallback*) data;
+	if (value == 0)
+		callback->function((const string*) key, callback->data);
+}
+
+extern void
+inc_ForEachMissingFile(void (*function)(const string* fileName, intptr_t data), intptr_t data) {
+	if (g_fileExists == NULL)
+		return;
+
+	SMissingFileCallback callback = {function, data};
+	map_ForEachKeyValue(g_fileExists, callMissingFile, (intptr_t) &callback);
+}
+
+extern uint32_t
+inc_FileCrc32(SIncludeFile* file) {
+	if (!file->hasCrc32) {
+		size_t size;
+		string* fileContent = readFile(file->name, &size);
+		if (fileContent != NULL) {
+			file->crc32 = crc32((const uint8_t*) str_String(fileContent), size);
+			str_Free(fileContent);
+		}
+		file->hasCrc32 = true;
+	}
+	return file->crc32;
+}
+
+extern void
+inc_Exit(void) {
+	if (g_fileExists != NULL)
+		strmap_Free(g_fileExists);
+	if (g_files != NULL)
+		strmap_Free(g_files);
+	if (g_binaryFiles != NULL)
+		strmap_Free(g_binaryFiles);
+
+	g_fileExists = NULL;
+	g_files = NULL;
+	g_binaryFiles = NULL;
+}
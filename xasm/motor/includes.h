@@ -19,8 +19,23 @@
 #ifndef XASM_MOTOR_INCLUDE_H_INCLUDED_
 #define XASM_MOTOR_INCLUDE_H_INCLUDED_
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "str.h"
 
+//	The contents of a source file, read once and shared by all the contexts including it
+typedef struct IncludeFile {
+	string* name;
+	string* content; // The text with canonicalized line endings
+	uint32_t crc32;  // The CRC of the file as read, valid if hasCrc32 is set
+	bool hasCrc32;
+
+	string* guardSymbol; // The symbol of the include guard wrapping the whole text, or NULL
+	uint32_t guardKeywordsGeneration;
+	bool hasGuardSymbol; // Set when guardSymbol has been found for guardKeywordsGeneration
+} SIncludeFile;
+
 extern void
 inc_AddIncludePath(const string* pathname);
 
@@ -29,4 +44,24 @@ inc_AddIncludePath(const string* pathname);
 extern void
 inc_FindFile(string** dest, const string* filename);
 
+//	Returns the contents of the file, which must have been found by inc_FindFile, or NULL if it cannot be read. The
+//	file is only read the first time.
+extern SIncludeFile*
+inc_ReadFile(const string* filename);
+
+//	Returns the contents of the binary file, or NULL if it cannot be read. The file is only read the first time.
+extern const string*
+inc_ReadBinaryFile(const string* filename);
+
+//	Calls the function with the name of every file that was looked for by inc_FindFile, but didn't exist
+extern void
+inc_ForEachMissingFile(void (*function)(const string* fileName, intptr_t data), intptr_t data);
+
+//	Returns the CRC of the file as read
+extern uint32_t
+inc_FileCrc32(SIncludeFile* file);
+
+extern void
+inc_Exit(void);
+
 #endif /* XASM_MOTOR_INCLUDE_H_INCLUDED_ */
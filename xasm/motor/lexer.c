@@ -29,10 +29,22 @@
 #include "lexer.h"
 #include "lexer_constants.h"
 #include "lexer_context.h"
+#include "lexer_directives.h"
+#include "lexer_tokens.h"
 #include "symbol.h"
 
+/* Private variables */
+
+static bool g_errorReported;
+
 /* Private functions */
 
+static bool
+lexError(uint32_t errorNumber) {
+	g_errorReported = true;
+	return err_Error(errorNumber);
+}
+
 INLINE char
 getUnexpandedChar(size_t index) {
 	return lexbuf_GetUnexpandedChar(&lex_Context->buffer, index);
@@ -85,7 +97,7 @@ acceptQuotedStringUntil(char terminator) {
 				break;
 			}
 			case '\n':
-				err_Error(ERROR_STRING_TERM);
+				lexError(ERROR_STRING_TERM);
 				return false;
 			default:
 				break;
@@ -175,7 +187,7 @@ static bool
 verifyLocalLabel(void) {
 	for (size_t i = 0; i < lex_Context->token.length; ++i) {
 		if (!isdigit(lex_Context->token.value.string[i])) {
-			return err_Error(ERROR_ID_MALFORMED);
+			return lexError(ERROR_ID_MALFORMED);
 		}
 	}
 	return true;
@@ -371,6 +383,109 @@ acceptVariadic(bool lineStart) {
 	return false;
 }
 
+static void
+unputTokenCharsFrom(size_t length) {
+	while (lex_Context->token.length > length) {
+		lex_UnputChar(lex_Context->token.value.string[--lex_Context->token.length]);
+	}
+}
+
+static bool
+acceptKeyword(const SLexConstantsWord* keyword, size_t length) {
+	unputTokenCharsFrom(length);
+	lex_Context->token.id = keyword->token;
+	return true;
+}
+
+//	Used when the identifier is followed by '#' or '$'. The identifier is accepted by acceptLabel, which expands string
+//	symbols and reports malformed local labels.
+static bool
+acceptLabelOrKeyword(const SLexConstantsWord* keyword, size_t keywordLength) {
+	unputTokenCharsFrom(0);
+
+	SLexerBookmark start;
+	lex_Bookmark(&start);
+
+	size_t labelLength = acceptLabel(T_ID) ? lex_Context->token.length : 0;
+	if (labelLength != 0 && labelLength > keywordLength)
+		return true;
+
+	if (keyword != NULL) {
+		lex_Goto(&start);
+		for (lex_Context->token.length = 0; lex_Context->token.length < keywordLength;)
+			lex_Context->token.value.string[lex_Context->token.length++] = lex_GetChar();
+
+		lex_Context->token.id = keyword->token;
+		return true;
+	}
+
+	return acceptString() || acceptChar();
+}
+
+//	Matches the longest keyword and the longest identifier in a single pass, and accepts the longest. A keyword is
+//	preferred if they are of equal length.
+static bool
+acceptKeywordOrIdentifier(void) {
+	const SLexConstantsNode* node = lex_ConstantsRoot();
+	const SLexConstantsWord* keyword = NULL;
+	size_t keywordLength = 0;
+	size_t identifierLength = 0;
+	bool identifierContinues = true;
+	char identifierTerminator = 0;
+
+	char* string = lex_Context->token.value.string;
+	lex_Context->token.length = 0;
+
+	while (node != NULL || identifierContinues) {
+		char ch = lex_GetChar();
+		if (ch == 0)
+			break;
+
+		string[lex_Context->token.length++] = ch;
+		size_t length = lex_Context->token.length;
+
+		if (node != NULL && (node = lex_ConstantsNextNode(node, ch)) != NULL) {
+			const SLexConstantsWord* word = lex_ConstantsNodeWord(node);
+			if (word != NULL) {
+				keyword = word;
+				keywordLength = length;
+			}
+		}
+
+		if (identifierContinues) {
+			if (length == 1) {
+				identifierContinues = ch == '.' || isStartSymbolCharacter(ch);
+			} else if (length == 2 && string[0] == '.') {
+				identifierContinues = isStartSymbolCharacter(ch);
+			} else {
+				identifierContinues = isSymbolCharacter(ch);
+			}
+
+			if (!identifierContinues) {
+				identifierTerminator = ch;
+			} else if (ch != '.') {
+				identifierLength = length;
+			}
+		}
+	}
+
+	if (identifierLength != 0 && (identifierTerminator == '#' || identifierTerminator == '$'))
+		return acceptLabelOrKeyword(keyword, keywordLength);
+
+	if (identifierLength > keywordLength) {
+		unputTokenCharsFrom(identifierLength);
+		string[identifierLength] = 0;
+		lex_Context->token.id = T_ID;
+		return true;
+	}
+
+	if (keyword != NULL)
+		return acceptKeyword(keyword, keywordLength);
+
+	unputTokenCharsFrom(0);
+	return acceptString() || acceptChar();
+}
+
 static bool
 acceptNext(bool lineStart) {
 	if (lineStart) {
@@ -390,26 +505,29 @@ acceptNext(bool lineStart) {
 		return true;
 	}
 
-	SLexerContext start;
-	lex_Bookmark(&start);
-
-	const SLexConstantsWord* constantWord = lex_ConstantsMatchWord();
-	size_t constantLength = constantWord != NULL ? lex_Context->token.length : 0;
-	SLexerContext afterConstant;
-	lex_Bookmark(&afterConstant);
+	return acceptKeywordOrIdentifier();
+}
 
-	lex_Goto(&start);
-	size_t labelLength = acceptLabel(T_ID) ? lex_Context->token.length : 0;
+//	Replays the token recorded at the current position of a macro body, or lexes and records it
+static bool
+acceptNextRecorded(bool lineStart) {
+	SLexerTokens* tokens = lex_Context->tokens;
+	if (tokens == NULL || !lexbuf_RewindUnputChars(&lex_Context->buffer))
+		return acceptNext(lineStart);
 
-	if (labelLength != 0 && labelLength > constantLength)
+	if (lextok_Replay(tokens, lex_Context, lineStart))
 		return true;
 
-	if (constantLength != 0) {
-		lex_Goto(&afterConstant);
-		return true;
-	}
+	size_t start = lex_Context->buffer.index;
+	g_errorReported = false;
+	if (!acceptNext(lineStart))
+		return false;
 
-	return acceptString() || acceptChar();
+	size_t scanned = lex_Context->buffer.index;
+	if (!g_errorReported && lexbuf_RewindUnputChars(&lex_Context->buffer))
+		lextok_Record(tokens, lex_Context, start, scanned, lineStart);
+
+	return true;
 }
 
 static bool
@@ -429,7 +547,7 @@ stateNormal(void) {
 	lex_Context->atLineStart = false;
 
 	for (;;) {
-		if (acceptNext(lineStart)) {
+		if (acceptNextRecorded(lineStart)) {
 			return true;
 		} else {
 			if (lexctx_EndCurrentBuffer()) {
@@ -636,6 +754,23 @@ skipWhiteSpaceIndexed(size_t* index) {
 	return (ch == ';') || (ch == 0);
 }
 
+//	Copies the used part of the token value, the string up to its terminator or the numeric value
+static void
+copyToken(SLexerToken* dest, const SLexerToken* source) {
+	size_t length = strnlen(source->value.string, MAX_TOKEN_LENGTH);
+	if (length < source->length)
+		length = source->length;
+	length += 1;
+	if (length < sizeof(source->value.floating))
+		length = sizeof(source->value.floating);
+	else if (length > sizeof(source->value))
+		length = sizeof(source->value);
+
+	dest->id = source->id;
+	dest->length = source->length;
+	memcpy(&dest->value, &source->value, length);
+}
+
 /*	Public functions */
 
 void
@@ -654,13 +789,24 @@ lex_CopyUnexpandedContent(char* dest, size_t count) {
 }
 
 void
-lex_Bookmark(SLexerContext* bookmark) {
-	lexctx_ShallowCopy(bookmark, lex_Context);
+lex_Bookmark(SLexerBookmark* bookmark) {
+	bookmark->context = lex_Context;
+	lexbuf_Mark(&lex_Context->buffer, &bookmark->position);
+	copyToken(&bookmark->token, &lex_Context->token);
+	bookmark->mode = lex_Context->mode;
+	bookmark->atLineStart = lex_Context->atLineStart;
+	bookmark->lineNumber = lex_Context->lineNumber;
 }
 
 void
-lex_Goto(SLexerContext* bookmark) {
-	lexctx_ShallowCopy(lex_Context, bookmark);
+lex_Goto(const SLexerBookmark* bookmark) {
+	assert(bookmark->context == lex_Context);
+
+	lexbuf_Seek(&lex_Context->buffer, &bookmark->position);
+	copyToken(&lex_Context->token, &bookmark->token);
+	lex_Context->mode = bookmark->mode;
+	lex_Context->atLineStart = bookmark->atLineStart;
+	lex_Context->lineNumber = bookmark->lineNumber;
 }
 
 size_t
@@ -688,15 +834,61 @@ lex_SetMode(ELexerMode mode) {
 	lex_Context->mode = mode;
 }
 
-bool
-lex_Init(string* filename) {
+void
+lex_Init(void) {
 	lex_ConstantsInit();
-	return lexctx_ContextInit(filename);
+}
+
+void
+lex_SetMainFile(string* filename) {
+	lexctx_ContextInit(filename);
+}
+
+bool
+lex_OpenMainFile(string* filename) {
+	SIncludeFile* file = lexctx_ReadFile(filename);
+	if (file == NULL)
+		return false;
+
+	lexctx_OpenFile(file);
+	return true;
+}
+
+//	Copies the directive into the token, as if it had been lexed
+static void
+acceptDirective(const SLexerDirective* directive) {
+	lex_Context->token.length = directive->wordEnd - directive->wordStart;
+	memcpy(lex_Context->token.value.string, str_String(lex_Context->buffer.text) + directive->wordStart,
+	       lex_Context->token.length);
+	lex_Context->token.value.string[lex_Context->token.length] = 0;
+	lex_Context->token.id = directive->token;
 }
 
 bool
 lex_GetNextDirective(void) {
+	SLexerDirectives* directives = lexctx_Directives();
+
 	for (;;) {
+		//	The lines without directives are skipped using the index, unless characters have been pushed
+		if (directives != NULL && lexbuf_RewindUnputChars(&lex_Context->buffer)) {
+			uint32_t lines;
+			const SLexerDirective* directive = lexdir_NextDirective(directives, lex_Context->buffer.index, &lines);
+			lex_Context->lineNumber += lines;
+
+			if (directive == NULL) {
+				lex_Context->buffer.index = str_Length(lex_Context->buffer.text);
+				return false;
+			} else if (directive->token != T_NONE) {
+				lex_Context->lineNumber += 1;
+				lex_Context->buffer.index = directive->wordEnd;
+				acceptDirective(directive);
+				return true;
+			}
+
+			//	The line must be lexed as it may expand macro arguments
+			lex_Context->buffer.index = directives->lineStarts[directive->line] - 1;
+		}
+
 		if (!skipToNextLine())
 			return false;
 
@@ -721,6 +913,21 @@ lex_GetNextDirective(void) {
 
 bool
 lex_GetNextDirectiveUnexpanded(size_t* index) {
+	SLexerDirectives* directives = lexctx_Directives();
+	if (directives != NULL && lexbuf_RewindUnputChars(&lex_Context->buffer)) {
+		size_t start = lex_Context->buffer.index;
+		const SLexerDirective* directive = lexdir_NextUnexpandedDirective(directives, start + *index);
+
+		if (directive == NULL) {
+			*index = str_Length(lex_Context->buffer.text) - start + 1;
+			return false;
+		}
+
+		*index = directive->wordEnd - start;
+		acceptDirective(directive);
+		return true;
+	}
+
 	for (;;) {
 		if (!skipToNextLineIndexed(index))
 			return false;
@@ -26,8 +26,27 @@
 
 #include "lexer_context.h"
 
+//	A position in the current lexer context that can be returned to. Only the state that changes while tokens are read
+//	is saved, the rest is shared with the context.
+typedef struct {
+	SLexerContext* context;
+	SLexerBufferMark position;
+	SLexerToken token;
+	ELexerMode mode;
+	bool atLineStart;
+	uint32_t lineNumber;
+} SLexerBookmark;
+
+//	Initializes the keyword tables, tokens must be defined before the main file is opened
+extern void
+lex_Init(void);
+
+//	Registers the main file, files may be read before the main file is opened
+extern void
+lex_SetMainFile(string* filename);
+
 extern bool
-lex_Init(string* filename);
+lex_OpenMainFile(string* filename);
 
 extern void
 lex_Exit(void);
@@ -63,10 +82,10 @@ extern void
 lex_SetMode(ELexerMode mode);
 
 extern void
-lex_Bookmark(SLexerContext* bookmark);
+lex_Bookmark(SLexerBookmark* bookmark);
 
 extern void
-lex_Goto(SLexerContext* bookmark);
+lex_Goto(const SLexerBookmark* bookmark);
 
 extern string*
 lex_TokenString(void);
@@ -137,13 +137,15 @@ lexbuf_Copy(SLexerBuffer* dest, const SLexerBuffer* source) {
 }
 
 extern void
-lexbuf_ShallowCopy(SLexerBuffer* dest, const SLexerBuffer* source) {
-	chstk_Copy(&dest->charStack, &source->charStack);
-	dest->name = source->name;
-	dest->uniqueValue = source->uniqueValue;
-	dest->text = source->text;
-	dest->index = source->index;
-	dest->arguments = source->arguments;
+lexbuf_Mark(const SLexerBuffer* buffer, SLexerBufferMark* mark) {
+	chstk_Copy(&mark->charStack, &buffer->charStack);
+	mark->index = buffer->index;
+}
+
+extern void
+lexbuf_Seek(SLexerBuffer* buffer, const SLexerBufferMark* mark) {
+	chstk_Copy(&buffer->charStack, &mark->charStack);
+	buffer->index = mark->index;
 }
 
 extern void
@@ -192,6 +194,22 @@ lexbuf_CopyUnexpandedContent(SLexerBuffer* buffer, char* dest, size_t count) {
 	memcpy(dest, buffer->text->data + buffer->index, count);
 }
 
+extern bool
+lexbuf_RewindUnputChars(SLexerBuffer* buffer) {
+	size_t count = chstk_Count(&buffer->charStack);
+	if (count > buffer->index)
+		return false;
+
+	for (size_t i = 0; i < count; ++i) {
+		if (chstk_PeekAt(&buffer->charStack, i) != str_CharAt(buffer->text, buffer->index - count + i))
+			return false;
+	}
+
+	buffer->index -= count;
+	chstk_Init(&buffer->charStack);
+	return true;
+}
+
 extern void
 lexbuf_UnputChar(SLexerBuffer* buffer, char ch) {
 	chstk_Push(&buffer->charStack, ch);
@@ -33,6 +33,12 @@ typedef struct LexerBuffer {
 	vec_t* arguments;
 } SLexerBuffer;
 
+//	A read position in a buffer. Only the characters currently unput are saved, the text itself is shared with the buffer.
+typedef struct LexerBufferMark {
+	SCharStack charStack;
+	size_t index;
+} SLexerBufferMark;
+
 extern void
 lexbuf_Init(SLexerBuffer* fileBuffer, string* name, string* buffer, vec_t* arguments);
 
@@ -55,11 +61,19 @@ extern void
 lexbuf_Copy(SLexerBuffer* dest, const SLexerBuffer* source);
 
 extern void
-lexbuf_ShallowCopy(SLexerBuffer* dest, const SLexerBuffer* source);
+lexbuf_Mark(const SLexerBuffer* buffer, SLexerBufferMark* mark);
+
+extern void
+lexbuf_Seek(SLexerBuffer* buffer, const SLexerBufferMark* mark);
 
 extern void
 lexbuf_ContinueFrom(SLexerBuffer* dest, const SLexerBuffer* source);
 
+//	Moves the read position back over the unput characters if they are the same as the text preceding the position,
+//	leaving the character stack empty. Returns false if the stack holds characters not from the text.
+extern bool
+lexbuf_RewindUnputChars(SLexerBuffer* buffer);
+
 extern void
 lexbuf_CopyUnexpandedContent(SLexerBuffer* fbuffer, char* dest, size_t count);
 
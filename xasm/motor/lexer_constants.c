@@ -25,32 +25,24 @@
 #include "tokens.h"
 
 // From util
-#include "lists.h"
 #include "mem.h"
 
-/* Private defines */
-
-#define HASH(hash, key)                  \
-	{                                    \
-		(hash) = ((hash) << 1u) + (key); \
-		(hash) ^= (hash) >> 3u;          \
-		(hash) &= WORDS_HASH_SIZE - 1u;  \
-	}
-
-#define WORDS_HASH_SIZE 1024u
-
 /* Private structures */
 
-typedef struct ConstantWord {
-	list_Data(struct ConstantWord);
-	SLexConstantsWord definition;
-	size_t nameLength;
-} SConstantWord;
+//	The words are stored in a trie of upper case characters. The children of the root are indexed by character, the
+//	children of other nodes are kept in a list, as they are few.
+struct LexConstantsNode {
+	struct LexConstantsNode* nextSibling;
+	struct LexConstantsNode* firstChild;
+	SLexConstantsWord definition; // The word ending at this node, name is NULL if no word ends here
+	char ch;
+};
 
 /* Private variables */
 
-static SConstantWord* g_wordsHashTable[WORDS_HASH_SIZE];
-static size_t g_maxWordLength;
+static SLexConstantsNode g_root;
+static SLexConstantsNode* g_rootChildren[256];
+static uint32_t g_generation;
 
 /* Private functions */
 
@@ -66,124 +58,138 @@ isNotLowerCase(const char* str) {
 }
 #endif
 
-static uint32_t
-hashString(const char* str) {
-	uint32_t result = 0;
+static SLexConstantsNode*
+findChild(const SLexConstantsNode* node, char ch) {
+	ch = (char) toupper((uint8_t) ch);
+
+	if (node == &g_root)
+		return g_rootChildren[(uint8_t) ch];
 
-	while (*str) {
-		HASH(result, toupper((uint8_t) *str));
-		++str;
+	for (SLexConstantsNode* child = node->firstChild; child != NULL; child = child->nextSibling) {
+		if (child->ch == ch)
+			return child;
 	}
 
-	return result;
+	return NULL;
 }
 
-#ifndef NDEBUG
-static bool
-doesNotExist(const char* name) {
-	for (SConstantWord* word = g_wordsHashTable[hashString(name)]; word != NULL; word = list_GetNext(word)) {
-		if (strcmp(name, word->definition.name) == 0)
-			return false;
+static SLexConstantsNode*
+createChild(SLexConstantsNode* node, char ch) {
+	ch = (char) toupper((uint8_t) ch);
+
+	SLexConstantsNode* child = (SLexConstantsNode*) mem_Alloc(sizeof(SLexConstantsNode));
+	child->firstChild = NULL;
+	child->definition.name = NULL;
+	child->definition.token = 0;
+	child->ch = ch;
+
+	if (node == &g_root) {
+		child->nextSibling = NULL;
+		g_rootChildren[(uint8_t) ch] = child;
+	} else {
+		child->nextSibling = node->firstChild;
+		node->firstChild = child;
 	}
-	return true;
+
+	return child;
 }
-#endif
 
-/* Public functions */
+static SLexConstantsNode*
+findNode(const char* name, size_t length) {
+	const SLexConstantsNode* node = &g_root;
+	for (size_t i = 0; i < length && node != NULL; ++i)
+		node = findChild(node, name[i]);
 
-const SLexConstantsWord*
-lex_ConstantsMatchWord(void) {
-	const SConstantWord* result = NULL;
-	lex_Context->token.length = 0;
-
-	uint32_t hashCode = 0;
-	while (lex_Context->token.length < g_maxWordLength) {
-		char ch = lex_GetChar();
-		if (ch == 0)
-			break;
-
-		lex_Context->token.value.string[lex_Context->token.length++] = ch;
-
-		if (isspace(ch))
-			break;
-
-		HASH(hashCode, toupper(ch));
-		for (SConstantWord* candidate = g_wordsHashTable[hashCode]; candidate != NULL; candidate = list_GetNext(candidate)) {
-			if (candidate->nameLength == lex_Context->token.length &&
-			    _strnicmp(lex_Context->token.value.string, candidate->definition.name, candidate->nameLength) == 0) {
-				result = candidate;
-				break;
-			}
-		}
+	return (SLexConstantsNode*) node;
+}
+
+static void
+removeChild(SLexConstantsNode* node, SLexConstantsNode* child) {
+	if (node == &g_root) {
+		g_rootChildren[(uint8_t) child->ch] = NULL;
+	} else {
+		SLexConstantsNode** link = &node->firstChild;
+		while (*link != child)
+			link = &(*link)->nextSibling;
+		*link = child->nextSibling;
 	}
 
-	const SLexConstantsWord* definition = NULL;
-	size_t nameLength = 0;
-	if (result != NULL) {
-		definition = &result->definition;
-		nameLength = result->nameLength;
-		lex_Context->token.id = definition->token;
+	mem_Free(child);
+}
+
+//	Remove the nodes at the end of the path that no longer lead to a word. Callers only hold on to nodes while matching a
+//	single token, the generation change tells everyone else that the trie changed.
+static void
+pruneNodes(const char* name, size_t length) {
+	SLexConstantsNode* node = findNode(name, length);
+
+	while (length > 0 && node->firstChild == NULL && node->definition.name == NULL) {
+		SLexConstantsNode* parent = findNode(name, --length);
+		removeChild(parent, node);
+		node = parent;
 	}
+}
 
-	while (lex_Context->token.length > nameLength) {
-		lex_UnputChar(lex_Context->token.value.string[--lex_Context->token.length]);
+static void
+freeChildren(SLexConstantsNode* node) {
+	SLexConstantsNode* child = node->firstChild;
+	while (child != NULL) {
+		SLexConstantsNode* next = child->nextSibling;
+		freeChildren(child);
+		mem_Free(child);
+		child = next;
 	}
+}
+
+/* Public functions */
 
-	return definition;
+const SLexConstantsNode*
+lex_ConstantsRoot(void) {
+	return &g_root;
+}
+
+const SLexConstantsNode*
+lex_ConstantsNextNode(const SLexConstantsNode* node, char ch) {
+	return findChild(node, ch);
 }
 
 const SLexConstantsWord*
-lex_ConstantsMatchTokenString(void) {
-	uint32_t hashCode = 0;
-	for (size_t i = 0; i < lex_Context->token.length; ++i) {
-		HASH(hashCode, toupper(lex_Context->token.value.string[i]));
-	}
+lex_ConstantsNodeWord(const SLexConstantsNode* node) {
+	return node->definition.name != NULL ? &node->definition : NULL;
+}
 
-	for (SConstantWord* candidate = g_wordsHashTable[hashCode]; candidate != NULL; candidate = list_GetNext(candidate)) {
-		if (candidate->nameLength == lex_Context->token.length &&
-		    _strnicmp(lex_Context->token.value.string, candidate->definition.name, candidate->nameLength) == 0) {
-			lex_Context->token.id = candidate->definition.token;
-			return &candidate->definition;
-		}
-	}
+uint32_t
+lex_ConstantsGeneration(void) {
+	return g_generation;
+}
 
-	return NULL;
+const SLexConstantsWord*
+lex_ConstantsFindWord(const char* name, size_t length) {
+	const SLexConstantsNode* node = findNode(name, length);
+	return node != NULL && node->definition.name != NULL ? &node->definition : NULL;
 }
 
-void
-lex_PrintMaxTokensPerHash(void) {
-	int maxWithSameHash = 0;
-	int slotsInUse = 0;
-	int totalStrings = 0;
-
-	for (uint32_t i = 0; i < WORDS_HASH_SIZE; ++i) {
-		int wordsInList = 0;
-		const SConstantWord* word = g_wordsHashTable[i];
-		if (word != NULL) {
-			++slotsInUse;
-			while (word != NULL) {
-				++totalStrings;
-				++wordsInList;
-				word = list_GetNext(word);
-			}
-		}
-		if (wordsInList > maxWithSameHash)
-			maxWithSameHash = wordsInList;
-	}
+const SLexConstantsWord*
+lex_ConstantsMatchTokenString(void) {
+	const SLexConstantsWord* word = lex_ConstantsFindWord(lex_Context->token.value.string, lex_Context->token.length);
 
-	printf("Total strings %d, max %d strings with same hash, %d slots in use\n", totalStrings, maxWithSameHash, slotsInUse);
+	if (word != NULL)
+		lex_Context->token.id = word->token;
+
+	return word;
 }
 
 void
 lex_ConstantsUndefineWord(const char* name, uint32_t token) {
-	SConstantWord** hashTableEntry = &g_wordsHashTable[hashString(name)];
-
-	for (SConstantWord* word = *hashTableEntry; word != NULL; word = list_GetNext(word)) {
-		if (word->definition.token == token && strcmp(word->definition.name, name) == 0) {
-			list_Remove(*hashTableEntry, word);
-			mem_Free(word);
-			return;
-		}
+	size_t length = strlen(name);
+	SLexConstantsNode* node = findNode(name, length);
+
+	if (node != NULL && node->definition.name != NULL && node->definition.token == token &&
+	    strcmp(node->definition.name, name) == 0) {
+		node->definition.name = NULL;
+		pruneNodes(name, length);
+		g_generation += 1;
+		return;
 	}
 	internalerror("token not found");
 }
@@ -199,22 +205,18 @@ lex_ConstantsUndefineWords(const SLexConstantsWord* words) {
 void
 lex_ConstantsDefineWord(const char* name, uint32_t token) {
 	assert(isNotLowerCase(name));
-	assert(doesNotExist(name));
 
-	/*printf("%s has hashvalue %d\n", lex->tzName, hash);*/
-
-	SConstantWord* pNew = (SConstantWord*) mem_Alloc(sizeof(SConstantWord));
-	list_Init(pNew);
-
-	pNew->definition.name = name;
-	pNew->definition.token = (EToken) token;
-	pNew->nameLength = strlen(name);
+	SLexConstantsNode* node = &g_root;
+	for (const char* ch = name; *ch != 0; ++ch) {
+		SLexConstantsNode* child = findChild(node, *ch);
+		node = child != NULL ? child : createChild(node, *ch);
+	}
 
-	if (pNew->nameLength > g_maxWordLength)
-		g_maxWordLength = pNew->nameLength;
+	assert(node->definition.name == NULL);
 
-	SConstantWord** hashTableEntry = &g_wordsHashTable[hashString(name)];
-	list_Insert(*hashTableEntry, pNew);
+	node->definition.name = name;
+	node->definition.token = (EToken) token;
+	g_generation += 1;
 }
 
 void
@@ -223,28 +225,25 @@ lex_ConstantsDefineWords(const SLexConstantsWord* lex) {
 		lex_ConstantsDefineWord(lex->name, lex->token);
 		lex += 1;
 	}
-
-	// lex_PrintMaxTokensPerHash();
 }
 
 void
 lex_ConstantsInit(void) {
-	for (uint32_t i = 0; i < WORDS_HASH_SIZE; ++i)
-		g_wordsHashTable[i] = NULL;
+	for (uint32_t i = 0; i < 256; ++i)
+		g_rootChildren[i] = NULL;
 
-	g_maxWordLength = 0;
+	g_root.nextSibling = NULL;
+	g_root.firstChild = NULL;
+	g_root.definition.name = NULL;
 }
 
 void
 lex_ConstantsExit(void) {
-	for (uint32_t i = 0; i < WORDS_HASH_SIZE; ++i) {
-		SConstantWord* word = g_wordsHashTable[i];
-		while (word != NULL) {
-			SConstantWord* next = list_GetNext(word);
-			mem_Free(word);
-			word = next;
+	for (uint32_t i = 0; i < 256; ++i) {
+		if (g_rootChildren[i] != NULL) {
+			freeChildren(g_rootChildren[i]);
+			mem_Free(g_rootChildren[i]);
+			g_rootChildren[i] = NULL;
 		}
 	}
-
-	g_maxWordLength = 0;
 }
@@ -19,6 +19,7 @@
 #ifndef XASM_MOTOR_LEXER_CONSTANTS_H_INCLUDED_
 #define XASM_MOTOR_LEXER_CONSTANTS_H_INCLUDED_
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct {
@@ -26,6 +27,8 @@ typedef struct {
 	uint32_t token;
 } SLexConstantsWord;
 
+typedef struct LexConstantsNode SLexConstantsNode;
+
 extern void
 lex_ConstantsDefineWord(const char* name, uint32_t token);
 
@@ -38,8 +41,27 @@ lex_ConstantsUndefineWord(const char* name, uint32_t token);
 extern void
 lex_ConstantsUndefineWords(const SLexConstantsWord* lex);
 
+//	Returns the node the words are matched from, a word is matched one character at a time using
+//	lex_ConstantsNextNode
+extern const SLexConstantsNode*
+lex_ConstantsRoot(void);
+
+//	Returns the node following the node when matching the character, case insensitively, or NULL if no word continues
+//	with the character
+extern const SLexConstantsNode*
+lex_ConstantsNextNode(const SLexConstantsNode* node, char ch);
+
+//	Returns the word ending at the node, or NULL
+extern const SLexConstantsWord*
+lex_ConstantsNodeWord(const SLexConstantsNode* node);
+
+//	Returns a number that changes whenever a word is defined or undefined
+extern uint32_t
+lex_ConstantsGeneration(void);
+
+//	Returns the word matching the name case insensitively, or NULL
 extern const SLexConstantsWord*
-lex_ConstantsMatchWord(void);
+lex_ConstantsFindWord(const char* name, size_t length);
 
 extern const SLexConstantsWord*
 lex_ConstantsMatchTokenString(void);
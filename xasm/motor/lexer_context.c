@@ -23,7 +23,6 @@
 #include <string.h>
 
 // From util
-#include "file.h"
 #include "lists.h"
 #include "map.h"
 #include "mem.h"
@@ -34,12 +33,14 @@
 #include "vec.h"
 
 // From xasm
-#include "crc32.h"
 #include "dependency.h"
 #include "errors.h"
 #include "includes.h"
 #include "lexer_buffer.h"
+#include "lexer_constants.h"
 #include "lexer_context.h"
+#include "lexer_directives.h"
+#include "lexer_tokens.h"
 #include "options.h"
 #include "symbol.h"
 
@@ -57,6 +58,8 @@ static SLexerContext*
 createContext(void) {
 	SLexerContext* ctx = (SLexerContext*) mem_Alloc(sizeof(SLexerContext));
 	list_Init(ctx);
+	ctx->tokens = NULL;
+	ctx->directives = NULL;
 	return ctx;
 }
 
@@ -281,6 +284,12 @@ lexctx_Destroy(SLexerContext* context) {
 			strvec_Free(context->buffer.arguments);
 		}
 
+		if (context->tokens != NULL)
+			lextok_Free(context->tokens);
+
+		if (context->directives != NULL)
+			lexdir_Free(context->directives);
+
 		lexbuf_Destroy(&context->buffer);
 	} else {
 		internalerror("Argument must not be NULL");
@@ -307,39 +316,53 @@ lexctx_CreateMemoryContext(string* name, string* memory, vec_t* arguments) {
 	return ctx;
 }
 
+static SFileInfo*
+getFileInfo(SIncludeFile* file) {
+	SFileInfo* fileInfo = createFileInfo(file->name);
+
+	if (opt_Current->enableDebugInfo)
+		fileInfo->crc32 = inc_FileCrc32(file);
+
+	return fileInfo;
+}
+
+//	A file wrapped in an include guard is skipped without lexing when the guard symbol is defined
+static bool
+isGuarded(SIncludeFile* file) {
+	if (!file->hasGuardSymbol || file->guardKeywordsGeneration != lex_ConstantsGeneration()) {
+		str_Free(file->guardSymbol);
+		file->guardSymbol = lexdir_IncludeGuard(file->content);
+		file->guardKeywordsGeneration = lex_ConstantsGeneration();
+		file->hasGuardSymbol = true;
+	}
+
+	return file->guardSymbol != NULL && sym_IsDefined(file->guardSymbol);
+}
+
 SLexerContext*
-lexctx_CreateFileContext(FILE* fileHandle, string* name) {
+lexctx_CreateFileContext(SIncludeFile* file) {
 	SLexerContext* ctx = createContext();
 
-	size_t size = fsize(fileHandle);
-	string* fileContent = str_ReadFile(fileHandle, size);
-	string* canonicalizedContent = str_CanonicalizeLineEndings(fileContent);
-	str_Free(fileContent);
-
-	lexbuf_Init(&ctx->buffer, name, canonicalizedContent, strvec_Create());
+	lexbuf_Init(&ctx->buffer, file->name, file->content, strvec_Create());
 	ctx->type = CONTEXT_FILE;
 	ctx->atLineStart = true;
 	ctx->mode = LEXER_MODE_NORMAL;
 	ctx->lineNumber = 1;
-	ctx->fileInfo = createFileInfo(name);
-
-	if (opt_Current->enableDebugInfo)
-		ctx->fileInfo->crc32 = crc32((const uint8_t*) str_String(fileContent), size);
-
-	str_Free(canonicalizedContent);
+	ctx->fileInfo = getFileInfo(file);
 
 	return ctx;
 }
 
 extern void
 lexctx_ProcessIncludeFile(string* name) {
-	FILE* fileHandle;
-	if (name != NULL && (fileHandle = fopen(str_String(name), "rb")) != NULL) {
-		SLexerContext* newContext = lexctx_CreateFileContext(fileHandle, name);
-		fclose(fileHandle);
-
-		dep_AddDependency(newContext->buffer.name);
-		pushContext(newContext);
+	SIncludeFile* file;
+	if (name != NULL && (file = inc_ReadFile(name)) != NULL) {
+		dep_AddDependency(file->name);
+
+		if (isGuarded(file))
+			getFileInfo(file);
+		else
+			pushContext(lexctx_CreateFileContext(file));
 	} else {
 		err_Fail(ERROR_NO_FILE);
 	}
@@ -357,6 +380,13 @@ lexctx_ProcessRepeatBlock(uint32_t count) {
 	newContext->block.repeat.remaining = count - 1;
 	newContext->block.repeat.bookmark = lex_Context;
 
+	//	The iterations replay the tokens recorded by the first. A block in a macro or another block shares the tokens
+	//	recorded from the same text.
+	if (lex_Context->tokens != NULL)
+		newContext->tokens = lextok_Reference(lex_Context->tokens);
+	else
+		newContext->tokens = lextok_Create(newContext->buffer.text, newContext->buffer.index);
+
 	pushContext(newContext);
 }
 
@@ -379,13 +409,22 @@ lexctx_ProcessMacro(string* macroName) {
 		newContext->lineNumber = symbol->lineNumber;
 		newContext->block.macro.symbol = symbol;
 
+		if (symbol->value.macro != NULL) {
+			if (symbol->macroTokens == NULL || symbol->macroTokens->text != symbol->value.macro) {
+				if (symbol->macroTokens != NULL)
+					lextok_Free(symbol->macroTokens);
+				symbol->macroTokens = lextok_Create(symbol->value.macro, 0);
+			}
+			newContext->tokens = lextok_Reference(symbol->macroTokens);
+		}
+
 		pushContext(newContext);
 	} else {
 		err_Error(ERROR_NO_MACRO);
 	}
 }
 
-extern bool
+extern void
 lexctx_ContextInit(string* fileName) {
 	g_newMacroArguments = strvec_Create();
 	strvec_PushBack(g_newMacroArguments, NULL);
@@ -397,22 +436,40 @@ lexctx_ContextInit(string* fileName) {
 	string* symbolName = str_Create("__FILE");
 	sym_CreateEqus(symbolName, fileName);
 	str_Free(symbolName);
+}
 
+extern SIncludeFile*
+lexctx_ReadFile(string* fileName) {
 	string* name = NULL;
 	inc_FindFile(&name, fileName);
 	if (name != NULL) {
-		FILE* fileHandle = fopen(str_String(name), "rb");
-		if (fileHandle != NULL) {
-			lex_Context = lexctx_CreateFileContext(fileHandle, name);
-			str_Free(name);
-			fclose(fileHandle);
-			return true;
-		}
+		SIncludeFile* file = inc_ReadFile(name);
 		str_Free(name);
+		if (file != NULL)
+			return file;
 	}
 
 	err_Fail(ERROR_NO_FILE);
-	return false;
+	return NULL;
+}
+
+extern void
+lexctx_OpenFile(SIncludeFile* file) {
+	assert(lex_Context == NULL);
+	lex_Context = lexctx_CreateFileContext(file);
+}
+
+extern void
+lexctx_CloseFile(void) {
+	assert(list_IsLast(lex_Context));
+	lexctx_FreeContext(lex_Context);
+	lex_Context = NULL;
+}
+
+extern SFileInfo*
+lexctx_AddFile(SIncludeFile* file) {
+	dep_AddDependency(file->name);
+	return getFileInfo(file);
 }
 
 extern void
@@ -451,30 +508,30 @@ lexctx_GetFileInfo(size_t* totalFiles) {
 	return result;
 }
 
-extern void
-lexctx_Copy(SLexerContext* dest, const SLexerContext* source) {
-	copyToken(&dest->token, &source->token);
-	dest->type = source->type;
-	dest->mode = source->mode;
-	lexbuf_Copy(&dest->buffer, &source->buffer);
-	dest->atLineStart = source->atLineStart;
-	dest->fileInfo = source->fileInfo;
-	dest->lineNumber = source->lineNumber;
-	dest->block = source->block;
+extern struct LexerDirectives*
+lexctx_Directives(void) {
+	//	A repeat block reads the text of the file it is in
+	SLexerContext* context = lex_Context;
+	while (context->type == CONTEXT_REPT)
+		context = context->block.repeat.bookmark;
+
+	if (context->type != CONTEXT_FILE || context->buffer.text != lex_Context->buffer.text)
+		return NULL;
+
+	if (context->directives == NULL)
+		context->directives = lexdir_Create(context->buffer.text);
+
+	return context->directives;
 }
 
 extern void
-lexctx_ShallowCopy(SLexerContext* dest, const SLexerContext* source) {
-	*dest = *source;
-	/*
+lexctx_Copy(SLexerContext* dest, const SLexerContext* source) {
 	copyToken(&dest->token, &source->token);
-	dest->token.tokenString = source->token.tokenString;
 	dest->type = source->type;
 	dest->mode = source->mode;
-	lexbuf_ShallowCopy(&dest->buffer, &source->buffer);
+	lexbuf_Copy(&dest->buffer, &source->buffer);
 	dest->atLineStart = source->atLineStart;
 	dest->fileInfo = source->fileInfo;
 	dest->lineNumber = source->lineNumber;
 	dest->block = source->block;
-	*/
 }
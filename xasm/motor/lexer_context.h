@@ -26,6 +26,7 @@
 #include "vec.h"
 #include "xasm.h"
 
+#include "includes.h"
 #include "lexer_buffer.h"
 
 typedef enum {
@@ -58,6 +59,8 @@ typedef struct {
 } SLexerToken;
 
 struct Symbol;
+struct LexerDirectives;
+struct LexerTokens;
 
 typedef struct LexerContext {
 	list_Data(struct LexerContext);
@@ -73,6 +76,9 @@ typedef struct LexerContext {
 	SFileInfo* fileInfo;
 	uint32_t lineNumber;
 
+	struct LexerTokens* tokens;         // Tokens recorded from the buffer text, or NULL
+	struct LexerDirectives* directives; // The directive lines of a file, or NULL until needed
+
 	union {
 		struct {
 			struct LexerContext* bookmark;
@@ -112,9 +118,26 @@ lexctx_EndCurrentBuffer(void);
 extern bool
 lexctx_EndReptBlock(void);
 
-extern bool
+//	Registers the main file, before any file is opened
+extern void
 lexctx_ContextInit(string* filename);
 
+//	Returns the file found in the include paths. It is an error if the file cannot be found or read.
+extern SIncludeFile*
+lexctx_ReadFile(string* filename);
+
+//	Makes the file the outermost context
+extern void
+lexctx_OpenFile(SIncludeFile* file);
+
+//	Closes the outermost context, once it has been read
+extern void
+lexctx_CloseFile(void);
+
+//	Records that the file is read by the assembly, as if it had been included
+extern SFileInfo*
+lexctx_AddFile(SIncludeFile* file);
+
 extern void
 lexctx_Cleanup(void);
 
@@ -133,17 +156,18 @@ lexctx_TokenFileInfo(void);
 extern uint32_t
 lexctx_TokenLineNumber(void);
 
-extern void
-lexctx_Copy(SLexerContext* dest, const SLexerContext* source);
+//	Returns the directive lines of the file the current context reads, or NULL if it does not read a file
+extern struct LexerDirectives*
+lexctx_Directives(void);
 
 extern void
-lexctx_ShallowCopy(SLexerContext* dest, const SLexerContext* source);
+lexctx_Copy(SLexerContext* dest, const SLexerContext* source);
 
 extern SLexerContext*
 lexctx_CreateMemoryContext(string* name, string* content, vec_t* arguments);
 
 extern SLexerContext*
-lexctx_CreateFileContext(FILE* f, string* name);
+lexctx_CreateFileContext(SIncludeFile* file);
 
 void
 lexctx_Destroy(SLexerContext* context);
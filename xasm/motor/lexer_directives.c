@@ -0,0 +1,463 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ctype.h>
+#include <string.h>
+
+// From util
+#include "mem.h"
+#include "str.h"
+
+// From xasm
+#include "lexer_constants.h"
+#include "lexer_directives.h"
+#include "tokens.h"
+
+#define NO_DIRECTIVE UINT32_MAX
+
+/* Private functions */
+
+INLINE bool
+isBlank(char ch) {
+	return ch == ' ' || ch == '\t';
+}
+
+//	The directives that begin or end a block, the callers of lex_GetNextDirective skip past any other keyword
+static bool
+isBlockDirective(uint32_t token) {
+	switch (token) {
+		case T_DIRECTIVE_IF:
+		case T_DIRECTIVE_IFC:
+		case T_DIRECTIVE_IFD:
+		case T_DIRECTIVE_IFEQ:
+		case T_DIRECTIVE_IFGE:
+		case T_DIRECTIVE_IFGT:
+		case T_DIRECTIVE_IFLE:
+		case T_DIRECTIVE_IFLT:
+		case T_DIRECTIVE_IFNC:
+		case T_DIRECTIVE_IFND:
+		case T_DIRECTIVE_ELSE:
+		case T_DIRECTIVE_ENDC:
+		case T_SYM_MACRO:
+		case T_DIRECTIVE_ENDM:
+		case T_DIRECTIVE_REPT:
+		case T_DIRECTIVE_ENDR:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static size_t
+skipWord(const char* text, size_t position) {
+	while (isalpha((unsigned char) text[position]))
+		++position;
+	return position;
+}
+
+//	Returns the position following the blanks
+static size_t
+skipBlanks(const char* text, size_t position) {
+	while (isBlank(text[position]))
+		++position;
+	return position;
+}
+
+static uint32_t
+findBlockDirective(const char* text, size_t start, size_t end) {
+	const SLexConstantsWord* word = lex_ConstantsFindWord(text + start, end - start);
+	return word != NULL && isBlockDirective(word->token) ? word->token : T_NONE;
+}
+
+//	Returns the index of the first line starting after the position
+static uint32_t
+lineAfter(const SLexerDirectives* directives, size_t position) {
+	uint32_t low = 0;
+	uint32_t high = directives->totalLines;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+		if (directives->lineStarts[middle] <= position)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+static void
+findLines(SLexerDirectives* directives) {
+	//	The lexer stops at the first zero character
+	const char* text = str_String(directives->text);
+	size_t length = strlen(text);
+
+	uint32_t totalLines = 1;
+	for (size_t i = 0; i < length; ++i) {
+		if (text[i] == '\n')
+			++totalLines;
+	}
+	if (length > 0 && text[length - 1] == '\n')
+		--totalLines;
+
+	directives->lineStarts = (uint32_t*) mem_Alloc(totalLines * sizeof(uint32_t));
+	directives->totalLines = 0;
+	for (size_t i = 0; i < length; ++i) {
+		if (text[i] == '\n')
+			directives->lineStarts[directives->totalLines++] = (uint32_t) i + 1;
+	}
+	if (directives->totalLines < totalLines)
+		directives->lineStarts[directives->totalLines++] = (uint32_t) length;
+}
+
+//	Finds the block directive on a line as lex_GetNextDirective would, returns T_NONE if there is none
+static uint32_t
+lineDirective(const char* text, size_t start, size_t* wordStart, size_t* wordEnd) {
+	char ch = text[start];
+	if (ch == ';' || ch == '*')
+		return T_NONE;
+
+	size_t labelEnd = start;
+	while (text[labelEnd] != 0 && text[labelEnd] != '\n' && !isBlank(text[labelEnd]))
+		++labelEnd;
+
+	*wordStart = skipBlanks(text, labelEnd);
+
+	ch = text[*wordStart];
+	if ((*wordStart > labelEnd && ch == '*') || ch == ';')
+		return T_NONE;
+
+	*wordEnd = skipWord(text, *wordStart);
+	return findBlockDirective(text, *wordStart, *wordEnd);
+}
+
+//	Finds the block directive on a line with a '\' as lex_GetNextDirective would in a file, where there are no macro
+//	arguments and the unique value is an underscore followed by digits. The character following an argument is not
+//	expanded.
+static uint32_t
+expandedLineDirective(const char* text, size_t start) {
+	size_t end = start + strcspn(text + start, "\n");
+	char* line = (char*) mem_Alloc(end - start + 1);
+	size_t length = 0;
+
+	for (size_t i = start; i < end; ++i) {
+		if (text[i] == '\\' && isdigit((unsigned char) text[i + 1])) {
+			i += 2;
+			if (i < end)
+				line[length++] = text[i];
+		} else if (text[i] == '\\' && text[i + 1] == '@') {
+			++i;
+			line[length++] = '_';
+			line[length++] = '0';
+		} else {
+			line[length++] = text[i];
+		}
+	}
+	line[length] = 0;
+
+	size_t wordStart, wordEnd;
+	uint32_t token = lineDirective(line, 0, &wordStart, &wordEnd);
+	mem_Free(line);
+
+	return token;
+}
+
+static bool
+findDirective(const SLexerDirectives* directives, uint32_t line, SLexerDirective* directive) {
+	const char* text = str_String(directives->text);
+	size_t start = directives->lineStarts[line];
+	size_t end = start + strcspn(text + start, "\n");
+
+	directive->line = line;
+
+	//	Macro arguments and unique values are expanded by lex_GetNextDirective
+	if (memchr(text + start, '\\', end - start) != NULL) {
+		directive->wordStart = directive->wordEnd = (uint32_t) start;
+		directive->token = T_NONE;
+		return true;
+	}
+
+	size_t wordStart, wordEnd;
+	directive->token = lineDirective(text, start, &wordStart, &wordEnd);
+	directive->wordStart = (uint32_t) wordStart;
+	directive->wordEnd = (uint32_t) wordEnd;
+	return directive->token != T_NONE;
+}
+
+static void
+findDirectives(SLexerDirectives* directives) {
+	directives->directives = (SLexerDirective*) mem_Alloc(directives->totalLines * sizeof(SLexerDirective));
+	directives->totalDirectives = 0;
+
+	for (uint32_t line = 0; line < directives->totalLines; ++line) {
+		if (findDirective(directives, line, &directives->directives[directives->totalDirectives]))
+			++directives->totalDirectives;
+	}
+}
+
+//	Finds the block directive as lex_GetNextDirectiveUnexpanded would, scanning from the start of the line. A label is only
+//	ended by a blank, so the directive may be found on a following line. Returns false if there is none, and sets next
+//	to the position the scan continues from.
+static bool
+findUnexpandedDirective(const char* text, size_t start, size_t labelEnd, SLexerDirective* directive, size_t* next) {
+	char ch = text[start];
+	if (ch == ';' || ch == '*') {
+		*next = start;
+		return false;
+	}
+
+	size_t position = labelEnd;
+	ch = text[position];
+	while (ch != 0 && isBlank(ch)) {
+		ch = text[++position];
+		if (ch == '*') {
+			*next = position;
+			return false;
+		}
+	}
+	if (ch == ';' || ch == 0) {
+		*next = position;
+		return false;
+	}
+
+	size_t wordEnd = skipWord(text, position);
+	uint32_t token = findBlockDirective(text, position, wordEnd);
+	if (token == T_NONE) {
+		*next = wordEnd;
+		return false;
+	}
+
+	directive->wordStart = (uint32_t) position;
+	directive->wordEnd = (uint32_t) wordEnd;
+	directive->token = token;
+	return true;
+}
+
+static void
+findUnexpandedDirectives(SLexerDirectives* directives) {
+	const char* text = str_String(directives->text);
+	size_t length = strlen(text);
+	uint32_t totalLines = directives->totalLines;
+
+	directives->unexpandedDirectives = (SLexerDirective*) mem_Alloc(totalLines * sizeof(SLexerDirective));
+	directives->totalUnexpandedDirectives = 0;
+	directives->nextUnexpandedDirective = (uint32_t*) mem_Alloc(totalLines * sizeof(uint32_t));
+
+	//	The lines are scanned backwards, as the scan of a line continues with a following line
+	size_t blank = length;
+	size_t position = length;
+	for (uint32_t line = totalLines; line-- > 0;) {
+		size_t start = directives->lineStarts[line];
+		while (position > start) {
+			if (isBlank(text[--position]))
+				blank = position;
+		}
+
+		SLexerDirective* directive = &directives->unexpandedDirectives[directives->totalUnexpandedDirectives];
+		size_t next;
+		if (findUnexpandedDirective(text, start, blank, directive, &next)) {
+			directive->line = line;
+			directives->nextUnexpandedDirective[line] = directives->totalUnexpandedDirectives++;
+		} else {
+			uint32_t nextLine = lineAfter(directives, next);
+			directives->nextUnexpandedDirective[line] =
+			    nextLine < totalLines ? directives->nextUnexpandedDirective[nextLine] : NO_DIRECTIVE;
+		}
+	}
+}
+
+static void
+freeIndex(SLexerDirectives* directives) {
+	mem_Free(directives->lineStarts);
+	mem_Free(directives->directives);
+	mem_Free(directives->unexpandedDirectives);
+	mem_Free(directives->nextUnexpandedDirective);
+}
+
+static void
+createIndex(SLexerDirectives* directives) {
+	directives->keywordsGeneration = lex_ConstantsGeneration();
+	findLines(directives);
+	findDirectives(directives);
+	findUnexpandedDirectives(directives);
+}
+
+//	The directives depend on the keywords, which may be changed by options and symbol definitions
+static void
+updateIndex(SLexerDirectives* directives) {
+	if (directives->keywordsGeneration != lex_ConstantsGeneration()) {
+		freeIndex(directives);
+		createIndex(directives);
+	}
+}
+
+//	Returns true if the rest of the line from the position holds only blanks or a comment
+static bool
+isBlankToLineEnd(const char* text, size_t position, bool lineStart) {
+	size_t next = skipBlanks(text, position);
+	char ch = text[next];
+	return ch == 0 || ch == '\n' || ch == ';' || (ch == '*' && (lineStart || next > position));
+}
+
+static size_t
+skipLine(const char* text, size_t position) {
+	const char* lineEnd = strchr(text + position, '\n');
+	return lineEnd != NULL ? (size_t) (lineEnd - text) + 1 : position + strlen(text + position);
+}
+
+//	Returns the index of the directive ending the block the way parse_block skips it, or totalDirectives if there is
+//	none. The lines with a '\' are expanded, the directive returned may be on such a line.
+static uint32_t
+findBlockEnd(const SLexerDirectives* directives, uint32_t index, uint32_t endToken, bool elseEnds) {
+	for (; index < directives->totalDirectives; ++index) {
+		const SLexerDirective* directive = &directives->directives[index];
+		uint32_t token = directive->token;
+		if (token == T_NONE)
+			token = expandedLineDirective(str_String(directives->text), directives->lineStarts[directive->line]);
+
+		if (token == endToken || (elseEnds && token == T_DIRECTIVE_ELSE))
+			return index;
+
+		uint32_t nestedEndToken;
+		switch (token) {
+			case T_NONE:
+			case T_DIRECTIVE_ELSE:
+			case T_DIRECTIVE_ENDC:
+			case T_DIRECTIVE_ENDM:
+			case T_DIRECTIVE_ENDR:
+				continue;
+			case T_SYM_MACRO:
+				nestedEndToken = T_DIRECTIVE_ENDM;
+				break;
+			case T_DIRECTIVE_REPT:
+				nestedEndToken = T_DIRECTIVE_ENDR;
+				break;
+			default:
+				nestedEndToken = T_DIRECTIVE_ENDC;
+				break;
+		}
+
+		index = findBlockEnd(directives, index + 1, nestedEndToken, false);
+	}
+	return directives->totalDirectives;
+}
+
+/* Public functions */
+
+extern SLexerDirectives*
+lexdir_Create(string* text) {
+	SLexerDirectives* directives = (SLexerDirectives*) mem_Alloc(sizeof(SLexerDirectives));
+
+	directives->text = NULL;
+	str_Assign(&directives->text, text);
+	createIndex(directives);
+
+	return directives;
+}
+
+extern void
+lexdir_Free(SLexerDirectives* directives) {
+	freeIndex(directives);
+	str_Free(directives->text);
+	mem_Free(directives);
+}
+
+extern const SLexerDirective*
+lexdir_NextDirective(SLexerDirectives* directives, size_t position, uint32_t* lines) {
+	updateIndex(directives);
+
+	uint32_t line = lineAfter(directives, position);
+
+	uint32_t low = 0;
+	uint32_t high = directives->totalDirectives;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+		if (directives->directives[middle].line < line)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	if (low == directives->totalDirectives) {
+		*lines = directives->totalLines - line;
+		return NULL;
+	}
+
+	*lines = directives->directives[low].line - line;
+	return &directives->directives[low];
+}
+
+extern const SLexerDirective*
+lexdir_NextUnexpandedDirective(SLexerDirectives* directives, size_t position) {
+	updateIndex(directives);
+
+	uint32_t line = lineAfter(directives, position);
+	if (line == directives->totalLines || directives->nextUnexpandedDirective[line] == NO_DIRECTIVE)
+		return NULL;
+
+	return &directives->unexpandedDirectives[directives->nextUnexpandedDirective[line]];
+}
+
+extern string*
+lexdir_IncludeGuard(string* text) {
+	const char* chars = str_String(text);
+
+	size_t lineStart = 0;
+	while (chars[lineStart] != 0 && isBlankToLineEnd(chars, lineStart, true))
+		lineStart = skipLine(chars, lineStart);
+
+	//	The first line must be IFND followed by a symbol, without a label
+	size_t wordStart = skipBlanks(chars, lineStart);
+	size_t wordEnd = skipWord(chars, wordStart);
+	const SLexConstantsWord* word = lex_ConstantsFindWord(chars + wordStart, wordEnd - wordStart);
+	if (wordStart == lineStart || word == NULL || word->token != T_DIRECTIVE_IFND)
+		return NULL;
+
+	size_t symbolStart = skipBlanks(chars, wordEnd);
+	size_t symbolEnd = symbolStart;
+	if (symbolStart == wordEnd || !(isalpha((unsigned char) chars[symbolStart]) || chars[symbolStart] == '_'))
+		return NULL;
+	while (isalnum((unsigned char) chars[symbolEnd]) || chars[symbolEnd] == '_')
+		++symbolEnd;
+
+	size_t nextLine = skipLine(chars, symbolEnd);
+	if (!isBlankToLineEnd(chars, symbolEnd, false) || memchr(chars + lineStart, '\\', nextLine - lineStart) != NULL ||
+	    lex_ConstantsFindWord(chars + symbolStart, symbolEnd - symbolStart) != NULL)
+		return NULL;
+
+	//	The matching ENDC must be followed by nothing but comments. An ENDC on a line with a '\' is not accepted.
+	SLexerDirectives* directives = lexdir_Create(text);
+	string* symbol = NULL;
+
+	uint32_t first = 0;
+	uint32_t firstLine = lineAfter(directives, symbolEnd);
+	while (first < directives->totalDirectives && directives->directives[first].line < firstLine)
+		++first;
+
+	uint32_t end = findBlockEnd(directives, first, T_DIRECTIVE_ENDC, true);
+	if (end < directives->totalDirectives && directives->directives[end].token == T_DIRECTIVE_ENDC &&
+	    isBlankToLineEnd(chars, directives->directives[end].wordEnd, false)) {
+		uint32_t line = directives->directives[end].line + 1;
+		while (line < directives->totalLines && isBlankToLineEnd(chars, directives->lineStarts[line], true))
+			++line;
+
+		if (line == directives->totalLines)
+			symbol = str_CreateLength(chars + symbolStart, symbolEnd - symbolStart);
+	}
+
+	lexdir_Free(directives);
+	return symbol;
+}
@@ -0,0 +1,71 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XASM_MOTOR_LEXER_DIRECTIVES_H_INCLUDED_
+#define XASM_MOTOR_LEXER_DIRECTIVES_H_INCLUDED_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "str.h"
+
+typedef struct {
+	uint32_t line;      // Index of the line in lineStarts
+	uint32_t wordStart; // Position of the directive
+	uint32_t wordEnd;   // Position following the directive
+	uint32_t token;     // The directive, or T_NONE if the line contains a '\' and must be lexed
+} SLexerDirective;
+
+//	The lines of a file with a directive beginning or ending a block, used to skip conditional blocks and copy macro
+//	blocks without lexing the lines in between. The directives are found the way lex_GetNextDirective and
+//	lex_GetNextDirectiveUnexpanded find them, which differ in how a label at the end of a line is skipped.
+typedef struct LexerDirectives {
+	string* text;
+	uint32_t keywordsGeneration;
+
+	uint32_t* lineStarts; // The positions following each line feed, and the end of the text
+	uint32_t totalLines;
+
+	SLexerDirective* directives; // The directives found by lex_GetNextDirective, sorted by line
+	uint32_t totalDirectives;
+
+	SLexerDirective* unexpandedDirectives; // The directives found by lex_GetNextDirectiveUnexpanded
+	uint32_t totalUnexpandedDirectives;
+	uint32_t* nextUnexpandedDirective; // For each line, the first unexpanded directive found from it, or UINT32_MAX
+} SLexerDirectives;
+
+extern SLexerDirectives*
+lexdir_Create(string* text);
+
+extern void
+lexdir_Free(SLexerDirectives* directives);
+
+//	Returns the first directive on a line starting after the position, or NULL if there is none. lines is set to the
+//	number of lines preceding the directive's line, or to the number of remaining lines if there is none.
+extern const SLexerDirective*
+lexdir_NextDirective(SLexerDirectives* directives, size_t position, uint32_t* lines);
+
+//	Returns the first directive lex_GetNextDirectiveUnexpanded finds on a line starting after the position, or NULL
+extern const SLexerDirective*
+lexdir_NextUnexpandedDirective(SLexerDirectives* directives, size_t position);
+
+//	Returns the symbol of an IFND block wrapping all of the text, outside of which there are only comments, or NULL
+extern string*
+lexdir_IncludeGuard(string* text);
+
+#endif /* XASM_MOTOR_LEXER_DIRECTIVES_H_INCLUDED_ */
@@ -0,0 +1,200 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <assert.h>
+#include <string.h>
+
+// From util
+#include "mem.h"
+#include "str.h"
+
+// From xasm
+#include "lexer_constants.h"
+#include "lexer_tokens.h"
+#include "options.h"
+
+/* Private functions */
+
+static bool
+isStale(const SLexerTokens* tokens) {
+	return tokens->keywordsGeneration != lex_ConstantsGeneration() ||
+	       memcmp(tokens->binaryLiteralCharacters, opt_Current->binaryLiteralCharacters, 2) != 0 ||
+	       memcmp(tokens->gameboyLiteralCharacters, opt_Current->gameboyLiteralCharacters, 4) != 0;
+}
+
+static void
+clearRecords(SLexerTokens* tokens) {
+	if (tokens->recordAt != NULL)
+		memset(tokens->recordAt, 0, tokens->positions * sizeof(uint32_t));
+
+	tokens->totalRecords = 0;
+	tokens->totalValues = 0;
+	tokens->keywordsGeneration = lex_ConstantsGeneration();
+	memcpy(tokens->binaryLiteralCharacters, opt_Current->binaryLiteralCharacters, 2);
+	memcpy(tokens->gameboyLiteralCharacters, opt_Current->gameboyLiteralCharacters, 4);
+}
+
+static bool
+containsExpansion(const string* text, size_t start, size_t end) {
+	for (size_t i = start; i < end; ++i) {
+		char ch = str_CharAt(text, i);
+		if (ch == '\\' || ch == '#')
+			return true;
+	}
+	return false;
+}
+
+static uint32_t
+valueSize(const SLexerToken* token) {
+	size_t size = token->length + 1;
+	if (size < sizeof(token->value.floating))
+		return sizeof(token->value.floating);
+	else if (size > sizeof(token->value))
+		return sizeof(token->value);
+	return (uint32_t) size;
+}
+
+//	The positions are allocated as they are recorded, as only the start of a file following a REPT may be lexed in it
+static void
+growPositions(SLexerTokens* tokens, size_t start) {
+	size_t needed = start - tokens->first + 1;
+	if (needed <= tokens->positions)
+		return;
+
+	size_t maxPositions = str_Length(tokens->text) + 1 - tokens->first;
+	size_t positions = tokens->positions != 0 ? tokens->positions : 256;
+	while (positions < needed)
+		positions *= 2;
+	if (positions > maxPositions)
+		positions = maxPositions;
+
+	tokens->recordAt = (uint32_t*) mem_Realloc(tokens->recordAt, positions * sizeof(uint32_t));
+	memset(tokens->recordAt + tokens->positions, 0, (positions - tokens->positions) * sizeof(uint32_t));
+	tokens->positions = (uint32_t) positions;
+}
+
+static SLexerTokenRecord*
+allocateRecord(SLexerTokens* tokens, size_t start, uint32_t size) {
+	growPositions(tokens, start);
+
+	if (tokens->totalRecords == tokens->allocatedRecords) {
+		tokens->allocatedRecords = tokens->allocatedRecords != 0 ? tokens->allocatedRecords * 2 : 64;
+		tokens->records =
+		    (SLexerTokenRecord*) mem_Realloc(tokens->records, tokens->allocatedRecords * sizeof(SLexerTokenRecord));
+	}
+
+	if (tokens->totalValues + size > tokens->allocatedValues) {
+		while (tokens->totalValues + size > tokens->allocatedValues)
+			tokens->allocatedValues = tokens->allocatedValues != 0 ? tokens->allocatedValues * 2 : 1024;
+		tokens->values = (char*) mem_Realloc(tokens->values, tokens->allocatedValues);
+	}
+
+	SLexerTokenRecord* record = &tokens->records[tokens->totalRecords++];
+	record->value = tokens->totalValues;
+	record->valueSize = (uint16_t) size;
+	tokens->totalValues += size;
+	tokens->recordAt[start - tokens->first] = tokens->totalRecords;
+
+	return record;
+}
+
+/* Public functions */
+
+extern SLexerTokens*
+lextok_Create(string* text, size_t first) {
+	assert(first <= str_Length(text));
+
+	SLexerTokens* tokens = (SLexerTokens*) mem_Alloc(sizeof(SLexerTokens));
+	memset(tokens, 0, sizeof(SLexerTokens));
+
+	str_Assign(&tokens->text, text);
+	tokens->first = (uint32_t) first;
+	tokens->references = 1;
+	clearRecords(tokens);
+
+	return tokens;
+}
+
+extern SLexerTokens*
+lextok_Reference(SLexerTokens* tokens) {
+	tokens->references += 1;
+	return tokens;
+}
+
+extern void
+lextok_Free(SLexerTokens* tokens) {
+	assert(tokens->references > 0);
+
+	if (--tokens->references == 0) {
+		str_Free(tokens->text);
+		mem_Free(tokens->recordAt);
+		mem_Free(tokens->records);
+		mem_Free(tokens->values);
+		mem_Free(tokens);
+	}
+}
+
+extern bool
+lextok_Replay(SLexerTokens* tokens, SLexerContext* context, bool lineStart) {
+	assert(context->buffer.text == tokens->text);
+	assert(chstk_Count(&context->buffer.charStack) == 0);
+
+	if (isStale(tokens)) {
+		clearRecords(tokens);
+		return false;
+	}
+
+	size_t position = context->buffer.index - tokens->first;
+	if (context->buffer.index < tokens->first || position >= tokens->positions)
+		return false;
+
+	uint32_t index = tokens->recordAt[position];
+	if (index == 0)
+		return false;
+
+	const SLexerTokenRecord* record = &tokens->records[index - 1];
+	if (record->lineStart != lineStart)
+		return false;
+
+	context->token.id = record->id;
+	context->token.length = record->length;
+	memcpy(&context->token.value, &tokens->values[record->value], record->valueSize);
+	context->buffer.index = record->end;
+	context->atLineStart = record->atLineStart;
+
+	return true;
+}
+
+extern void
+lextok_Record(SLexerTokens* tokens, const SLexerContext* context, size_t start, size_t scanned, bool lineStart) {
+	assert(context->buffer.text == tokens->text);
+
+	if (start < tokens->first || containsExpansion(tokens->text, start, scanned) || context->buffer.index <= start)
+		return;
+
+	const SLexerToken* token = &context->token;
+	uint32_t size = valueSize(token);
+
+	SLexerTokenRecord* record = allocateRecord(tokens, start, size);
+	record->id = token->id;
+	record->length = (uint32_t) token->length;
+	record->end = (uint32_t) context->buffer.index;
+	record->lineStart = lineStart;
+	record->atLineStart = context->atLineStart;
+	memcpy(&tokens->values[record->value], &token->value, size);
+}
@@ -0,0 +1,83 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XASM_MOTOR_LEXER_TOKENS_H_INCLUDED_
+#define XASM_MOTOR_LEXER_TOKENS_H_INCLUDED_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "str.h"
+
+#include "lexer_context.h"
+
+typedef struct {
+	uint32_t id;
+	uint32_t length;
+	uint32_t end;       // Position in the text following the token
+	uint32_t value;     // Offset of the token value in the value buffer
+	uint16_t valueSize; // Bytes of the token value recorded
+	bool lineStart;     // The token was lexed at the start of a line
+	bool atLineStart;   // The token ended the line
+} SLexerTokenRecord;
+
+//	The tokens lexed from a text, such as a macro body or the part of a file following a REPT, indexed by the position
+//	in the text they start at. When the text is lexed again the tokens are replayed instead, as long as the keywords and
+//	the literal characters they were lexed with are unchanged.
+typedef struct LexerTokens {
+	string* text;
+	uint32_t references;
+
+	uint32_t first;     // The first position tokens are recorded from
+	uint32_t positions; // The number of positions in recordAt
+	uint32_t* recordAt; // Index + 1 of the record starting at each position from first, 0 if there is none
+	SLexerTokenRecord* records;
+	uint32_t totalRecords;
+	uint32_t allocatedRecords;
+
+	char* values;
+	uint32_t totalValues;
+	uint32_t allocatedValues;
+
+	uint32_t keywordsGeneration;
+	char binaryLiteralCharacters[2];
+	char gameboyLiteralCharacters[4];
+} SLexerTokens;
+
+//	Creates an empty record of the tokens in the text from the first position on
+extern SLexerTokens*
+lextok_Create(string* text, size_t first);
+
+//	Returns the tokens with an additional reference, which must be released with lextok_Free
+extern SLexerTokens*
+lextok_Reference(SLexerTokens* tokens);
+
+extern void
+lextok_Free(SLexerTokens* tokens);
+
+//	Sets the context's token to the token recorded at the current position, if there is one, and moves past it. The
+//	context's character stack must be empty.
+extern bool
+lextok_Replay(SLexerTokens* tokens, SLexerContext* context, bool lineStart);
+
+//	Records the context's token, lexed from the start position. The characters up to the scanned position were read to
+//	lex it, the token is not recorded if they contain a macro argument or string symbol expansion.
+extern void
+lextok_Record(SLexerTokens* tokens, const SLexerContext* context, size_t start, size_t scanned, bool lineStart);
+
+#endif /* XASM_MOTOR_LEXER_TOKENS_H_INCLUDED_ */
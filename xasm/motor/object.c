@@ -156,33 +156,28 @@ writeSymbols(SSection* section, FILE* fileHandle, SExpression* expression, uint3
 
 static uint32_t
 writeSymbolsWithFlags(FILE* fileHandle, SSection* section, uint32_t symbolId, uint32_t symbolFlags) {
-	for (uint_fast16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (SSymbol* sym = sym_hashedSymbols[i]; sym; sym = list_GetNext(sym)) {
-			if (sym->type != SYM_GROUP)
-				sym->id = UINT32_MAX;
-
-			if (sym->section == section && (sym->flags & symbolFlags)) {
-				sym->id = symbolId++;
-
-				fputsz(str_String(sym->name), fileHandle);
-				if (sym->flags & SYMF_EXPORT)
-					fputll(0, fileHandle); //	EXPORT
-				else if (sym->flags & SYMF_FILE_EXPORT)
-					fputll(3, fileHandle); //	LOCALEXPORT
-				else if (sym->flags & SYMF_RELOC)
-					fputll(2, fileHandle); //	LOCAL
-				else
-					assert(false);
-
-				fputll((uint32_t) sym->value.integer, fileHandle);
-
-				if (opt_Current->enableDebugInfo) {
-					fputll(sym->fileInfo->fileId, fileHandle);
-					fputll(sym->lineNumber, fileHandle);
-				} else {
-					fputll(UINT32_MAX, fileHandle);
-					fputll(0, fileHandle);
-				}
+	for (SSymbol* sym = sym_FirstSymbolInSection(section); sym != NULL; sym = sym_NextSymbolInSection(sym)) {
+		if (sym->flags & symbolFlags) {
+			sym->id = symbolId++;
+
+			fputsz(str_String(sym->name), fileHandle);
+			if (sym->flags & SYMF_EXPORT)
+				fputll(0, fileHandle); //	EXPORT
+			else if (sym->flags & SYMF_FILE_EXPORT)
+				fputll(3, fileHandle); //	LOCALEXPORT
+			else if (sym->flags & SYMF_RELOC)
+				fputll(2, fileHandle); //	LOCAL
+			else
+				assert(false);
+
+			fputll((uint32_t) sym->value.integer, fileHandle);
+
+			if (opt_Current->enableDebugInfo) {
+				fputll(sym->fileInfo->fileId, fileHandle);
+				fputll(sym->lineNumber, fileHandle);
+			} else {
+				fputll(UINT32_MAX, fileHandle);
+				fputll(0, fileHandle);
 			}
 		}
 	}
@@ -190,6 +185,41 @@ writeSymbolsWithFlags(FILE* fileHandle, SSection* section, uint32_t symbolId, ui
 	return symbolId;
 }
 
+static void
+resetSymbolId(SSymbol* symbol) {
+	if (symbol->type != SYM_GROUP)
+		symbol->id = UINT32_MAX;
+}
+
+static void
+resetSymbolIdsInExpression(SExpression* expression) {
+	if (expression != NULL) {
+		resetSymbolIdsInExpression(expression->left);
+		resetSymbolIdsInExpression(expression->right);
+
+		if (expr_Type(expression) == EXPR_SYMBOL ||
+		    (xasm_Configuration->supportBanks && expr_IsOperator(expression, T_FUNC_BANK))) {
+			resetSymbolId(expression->value.symbol);
+		}
+	}
+}
+
+//	Resets the ids assigned while writing the section, the ids of symbols are local to the section they are written in
+static void
+resetSectionSymbolIds(SSection* section) {
+	for (SSymbol* sym = sym_FirstSymbolInSection(section); sym != NULL; sym = sym_NextSymbolInSection(sym))
+		resetSymbolId(sym);
+
+	for (SPatch* patch = section->patches; patch; patch = list_GetNext(patch))
+		resetSymbolIdsInExpression(patch->expression);
+}
+
+static void
+resetSymbolIds(void) {
+	for (SSymbol* sym = sym_FirstSymbol(); sym != NULL; sym = sym_NextSymbol(sym))
+		resetSymbolId(sym);
+}
+
 static void
 markLocalExportsInExpression(SSection* section, SExpression* expression) {
 	if (expression != NULL) {
@@ -378,13 +408,11 @@ writeGroups(FILE* fileHandle) {
 	fputll(0, fileHandle);
 
 	uint32_t groupCount = 0;
-	for (uint_fast16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (SSymbol* sym = sym_hashedSymbols[i]; sym != NULL; sym = list_GetNext(sym)) {
-			if (sym->type == SYM_GROUP) {
-				sym->id = groupCount++;
-				fputsz(str_String(sym->name), fileHandle);
-				fputll(sym->value.groupType | (sym->flags & (SYMF_SHARED | SYMF_DATA)), fileHandle);
-			}
+	for (SSymbol* sym = sym_FirstSymbol(); sym != NULL; sym = sym_NextSymbol(sym)) {
+		if (sym->type == SYM_GROUP) {
+			sym->id = groupCount++;
+			fputsz(str_String(sym->name), fileHandle);
+			fputll(sym->value.groupType | (sym->flags & (SYMF_SHARED | SYMF_DATA)), fileHandle);
 		}
 	}
 
@@ -409,21 +437,19 @@ writeExportedConstantsSection(FILE* fileHandle) {
 	fputll(0, fileHandle); //	Number of symbols
 	uint32_t integerExportCount = 0;
 
-	for (uint_fast16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (SSymbol* sym = sym_hashedSymbols[i]; sym; sym = list_GetNext(sym)) {
-			if ((sym->type == SYM_EQU || sym->type == SYM_SET) && (sym->flags & SYMF_EXPORT)) {
-				++integerExportCount;
-				fputsz(str_String(sym->name), fileHandle);
-				fputll(0, fileHandle); /* EXPORT */
-				fputll((uint32_t) sym->value.integer, fileHandle);
-
-				if (opt_Current->enableDebugInfo) {
-					fputll(sym->fileInfo->fileId, fileHandle);
-					fputll(sym->lineNumber, fileHandle);
-				} else {
-					fputll(UINT32_MAX, fileHandle);
-					fputll(0, fileHandle);
-				}
+	for (SSymbol* sym = sym_FirstSymbol(); sym != NULL; sym = sym_NextSymbol(sym)) {
+		if ((sym->type == SYM_EQU || sym->type == SYM_SET) && (sym->flags & SYMF_EXPORT)) {
+			++integerExportCount;
+			fputsz(str_String(sym->name), fileHandle);
+			fputll(0, fileHandle); /* EXPORT */
+			fputll((uint32_t) sym->value.integer, fileHandle);
+
+			if (opt_Current->enableDebugInfo) {
+				fputll(sym->fileInfo->fileId, fileHandle);
+				fputll(sym->lineNumber, fileHandle);
+			} else {
+				fputll(UINT32_MAX, fileHandle);
+				fputll(0, fileHandle);
 			}
 		}
 	}
@@ -561,11 +587,13 @@ obj_Write(string* fileName) {
 	writeExportedConstantsSection(fileHandle);
 
 	markLocalExports();
+	resetSymbolIds();
 
 	uint32_t sectionId = 0;
 	for (SSection* section = sect_Sections; section; section = list_GetNext(section)) {
 		section->id = sectionId++;
 		writeSection(fileHandle, section);
+		resetSectionSymbolIds(section);
 	}
 
 	fclose(fileHandle);
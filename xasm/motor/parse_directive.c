@@ -42,6 +42,7 @@
 #include "tokens.h"
 
 static set_t* includeOnceFilenames = NULL;
+static bool printed = false;
 
 static bool
 mayIncludeFile(string* filename) {
@@ -265,6 +266,7 @@ handlePrintt(intptr_t _) {
 
 	string* result = parse_ExpectStringExpression();
 	if (result != NULL) {
+		printed = true;
 		printf("%s", str_String(result));
 		str_Free(result);
 		return true;
@@ -276,6 +278,7 @@ handlePrintt(intptr_t _) {
 static bool
 handlePrintv(intptr_t _) {
 	parse_GetToken();
+	printed = true;
 	printf("$%X", parse_ConstantExpression());
 	return true;
 }
@@ -285,6 +288,7 @@ handlePrintf(intptr_t _) {
 	parse_GetToken();
 
 	int32_t i = parse_ConstantExpression();
+	printed = true;
 	if (i < 0) {
 		printf("-");
 		i = -i;
@@ -531,10 +535,41 @@ handleFileCore(intptr_t intProcess) {
 	return false;
 }
 
+//	INCBIN "file"[,offset[,length]]
 static bool
-handleFile(intptr_t intProcess) {
+handleIncbin(intptr_t _) {
 	parse_GetToken();
-	return handleFileCore(intProcess);
+
+	string* filename = NULL;
+	getFilename(&filename);
+	if (filename == NULL) {
+		err_Error(ERROR_NO_FILE);
+		return false;
+	}
+
+	int32_t offset = 0;
+	int32_t length = 0;
+	bool rest = true;
+	if (lex_Context->token.id == ',') {
+		parse_GetToken();
+		offset = parse_ConstantExpression();
+
+		if (lex_Context->token.id == ',') {
+			parse_GetToken();
+			length = parse_ConstantExpression();
+			rest = false;
+		}
+	}
+
+	if (offset < 0 || length < 0) {
+		err_Error(ERROR_EXPR_POSITIVE);
+		str_Free(filename);
+	} else if (mayIncludeFile(filename)) {
+		sect_OutputBinaryFile(filename, (uint32_t) offset, rest ? UINT32_MAX : (uint32_t) length);
+	} else {
+		str_Free(filename);
+	}
+	return true;
 }
 
 static bool
@@ -543,7 +578,7 @@ handleInclude(intptr_t intProcess) {
 
 	if (lex_Context->token.id == T_INCLUDE_ONCE) {
 		parse_GetToken();
-		strset_Insert(includeOnceFilenames, lex_Context->fileInfo->fileName);
+		parse_SetIncludeOnce(lex_Context->fileInfo->fileName);
 		return true;
 	} else {
 		return handleFileCore(intProcess);
@@ -786,7 +821,7 @@ static SDirective g_Directives[T_DIRECTIVE_LAST - T_DIRECTIVE_FIRST + 1] = {
     {handleAssert,    (intptr_t) err_Fail                },
     {handleAssert,    (intptr_t) err_Warn                },
     {handleInclude,   (intptr_t) includeFile             },
-    {handleFile,      (intptr_t) sect_OutputBinaryFile   },
+    {handleIncbin,    0                                  },
     {defineSpace,     1                                  },
     {defineSpace,     2                                  },
     {defineSpace,     4                                  },
@@ -837,3 +872,21 @@ parse_Directive(void) {
 	}
 	return false;
 }
+
+void
+parse_SetIncludeOnce(const string* filename) {
+	if (includeOnceFilenames == NULL)
+		includeOnceFilenames = strset_Create();
+
+	strset_Insert(includeOnceFilenames, filename);
+}
+
+set_t*
+parse_IncludeOnceFilenames(void) {
+	return includeOnceFilenames;
+}
+
+bool
+parse_Printed(void) {
+	return printed;
+}
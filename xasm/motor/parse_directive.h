@@ -21,7 +21,22 @@
 
 #include <stdbool.h>
 
+#include "set.h"
+#include "str.h"
+
 extern bool
 parse_Directive(void);
 
+//	Marks the file as included with INCLUDE ONCE, it is not included again
+extern void
+parse_SetIncludeOnce(const string* filename);
+
+//	Returns the names of the files marked with INCLUDE ONCE, or NULL
+extern set_t*
+parse_IncludeOnceFilenames(void);
+
+//	Returns true if the source has printed text with PRINTT, PRINTV or PRINTF
+extern bool
+parse_Printed(void);
+
 #endif // PROJECT_PARSE_DIRECTIVES_H
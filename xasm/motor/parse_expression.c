@@ -155,7 +155,7 @@ expressionPriority9(size_t maxStringConstLength) {
 			return expression;
 		}
 		case T_LEFT_PARENS: {
-			SLexerContext bookmark;
+			SLexerBookmark bookmark;
 			lex_Bookmark(&bookmark);
 
 			parse_GetToken();
@@ -256,7 +256,7 @@ handleStringMemberFunctionReturningInt(string* s) {
 
 static SExpression*
 expressionPriority8(size_t maxStringConstLength) {
-	SLexerContext bm;
+	SLexerBookmark bm;
 	lex_Bookmark(&bm);
 
 	string* s = parse_StringExpression();
@@ -548,7 +548,7 @@ expressionPriority3(size_t maxStringConstLength) {
 		switch (lex_Context->token.id) {
 			case T_OP_ADD: {
 				SExpression* t2;
-				SLexerContext mark;
+				SLexerBookmark mark;
 
 				lex_Bookmark(&mark);
 				parse_GetToken();
@@ -33,7 +33,7 @@ expressionPriority3(size_t maxStringConstLength, long double* result) {
 			return true;
 		}
 		case T_LEFT_PARENS: {
-			SLexerContext bookmark;
+			SLexerBookmark bookmark;
 			lex_Bookmark(&bookmark);
 
 			parse_GetToken();
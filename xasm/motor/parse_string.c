@@ -175,7 +175,7 @@ parseStringExpressionAndFormat(void) {
 
 static string*
 parseSubstring(void) {
-	SLexerContext bookmark;
+	SLexerBookmark bookmark;
 	lex_Bookmark(&bookmark);
 
 	string* substr;
@@ -250,7 +250,7 @@ interpolateString(const char* literal) {
 
 static string*
 stringExpressionPri2(void) {
-	SLexerContext bm;
+	SLexerBookmark bm;
 	lex_Bookmark(&bm);
 
 	switch (lex_Context->token.id) {
@@ -305,7 +305,7 @@ static string*
 stringExpressionPri1(void) {
 	string* t = stringExpressionPri2();
 
-	SLexerContext bm;
+	SLexerBookmark bm;
 	for (lex_Bookmark(&bm); parse_IsDot(); lex_Bookmark(&bm)) {
 		switch (lex_Context->token.id) {
 			case T_STR_MEMBER_SLICE: {
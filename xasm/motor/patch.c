@@ -28,6 +28,7 @@
 #include "str.h"
 #include "util.h"
 
+#include "arena.h"
 #include "errors.h"
 #include "expression.h"
 #include "lexer_context.h"
@@ -37,6 +38,8 @@
 #include "tokens.h"
 #include "xasm.h"
 
+static SArena g_patches = ARENA_INIT(SPatch);
+
 /* Private functions */
 
 typedef int32_t (*binaryOperation)(int32_t nLeft, int32_t nRight);
@@ -453,7 +456,7 @@ static applyPatch g_patchFunctions[PATCH_BE_32 - PATCH_8 + 1] = {
 
 void
 patch_Create(SSection* section, uint32_t offset, SExpression* expression, EPatchType type) {
-	SPatch* patch = mem_Alloc(sizeof(SPatch));
+	SPatch* patch = arena_Alloc(&g_patches);
 	memset(patch, 0, sizeof(SPatch));
 
 	if (section->patches) {
@@ -466,15 +469,14 @@ patch_Create(SSection* section, uint32_t offset, SExpression* expression, EPatch
 	patch->offset = offset;
 	patch->type = type;
 	patch->expression = expression;
-	str_Assign(&patch->filename, lex_Context->buffer.name);
+	patch->fileInfo = lex_Context->fileInfo;
 	patch->lineNumber = lex_Context->lineNumber;
 }
 
 void
 patch_Free(SPatch* patch) {
-	str_Free(patch->filename);
 	expr_Free(patch->expression);
-	mem_Free(patch);
+	arena_Free(&g_patches, patch);
 }
 
 void
@@ -503,3 +505,8 @@ patch_OptimizeAll(void) {
 		}
 	}
 }
+
+void
+patch_Exit(void) {
+	arena_Release(&g_patches);
+}
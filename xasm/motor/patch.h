@@ -25,6 +25,7 @@
 #include "expression.h"
 #include "section.h"
 
+struct FileInfo;
 struct Section;
 
 typedef enum {
@@ -41,7 +42,7 @@ typedef struct Patch {
 	uint32_t offset;
 	EPatchType type;
 	SExpression* expression;
-	string* filename;
+	struct FileInfo* fileInfo;
 	uint32_t lineNumber;
 } SPatch;
 
@@ -54,6 +55,10 @@ patch_Free(SPatch* patch);
 extern void
 patch_BackPatch(void);
 
+//	Releases the memory of all patches
+extern void
+patch_Exit(void);
+
 extern void
 patch_OptimizeAll(void);
 
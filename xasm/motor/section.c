@@ -31,6 +31,7 @@
 #include "dependency.h"
 #include "errors.h"
 #include "expression.h"
+#include "includes.h"
 #include "linemap.h"
 #include "options.h"
 #include "patch.h"
@@ -86,6 +87,7 @@ static SSection*
 createSection(const string* name) {
 	SSection* newSection = mem_Alloc(sizeof(SSection));
 	memset(newSection, 0, sizeof(SSection));
+	newSection->firstShrinkable = UINT32_MAX;
 
 	str_Assign(&newSection->name, name);
 
@@ -159,6 +161,38 @@ checkAvailableSpace(uint32_t count) {
 	}
 }
 
+//	Returns the index of the first removed range that does not end at or before the offset
+static uint32_t
+findRemovedRange(const uint32_t* offsets, uint32_t totalOffsets, uint32_t count, uint32_t offset) {
+	uint32_t low = 0;
+	uint32_t high = totalOffsets;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+		if (offsets[middle] + count <= offset)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+//	Returns the number of removed bytes before the offset. An offset inside a removed range is moved to the start of
+//	the range.
+static uint32_t
+removedBefore(const uint32_t* offsets, uint32_t totalOffsets, uint32_t count, uint32_t offset) {
+	uint32_t index = findRemovedRange(offsets, totalOffsets, count, offset);
+	uint32_t removed = index * count;
+	if (index < totalOffsets && offsets[index] < offset)
+		removed += offset - offsets[index];
+	return removed;
+}
+
+static uint32_t
+removedBeforeCpuOffset(const uint32_t* offsets, uint32_t totalOffsets, uint32_t count, uint32_t cpuOffset) {
+	uint32_t wordSize = xasm_Configuration->minimumWordSize;
+	return removedBefore(offsets, totalOffsets, count, cpuOffset * wordSize) / wordSize;
+}
+
 /* Public functions */
 
 uint32_t
@@ -169,6 +203,56 @@ sect_CurrentSize(void) {
 	return sect_Current->usedSpace;
 }
 
+void
+sect_RemoveBytes(SSection* section, const uint32_t* offsets, uint32_t totalOffsets, uint32_t count) {
+	if (totalOffsets == 0 || count == 0)
+		return;
+
+	assert(count % xasm_Configuration->minimumWordSize == 0);
+
+	if (section->data != NULL) {
+		uint32_t destination = offsets[0];
+		for (uint32_t i = 0; i < totalOffsets; ++i) {
+			uint32_t start = offsets[i] + count;
+			uint32_t end = i + 1 < totalOffsets ? offsets[i + 1] : section->usedSpace;
+			memmove(&section->data[destination], &section->data[start], end - start);
+			destination += end - start;
+		}
+	}
+
+	for (SSymbol* symbol = section->symbols; symbol != NULL; symbol = sym_NextSymbolInSection(symbol)) {
+		if (symbol->type == SYM_LABEL && (symbol->flags & SYMF_RELOC)) {
+			uint32_t value = (uint32_t) symbol->value.integer;
+			symbol->value.integer = (int32_t) (value - removedBeforeCpuOffset(offsets, totalOffsets, count, value));
+		}
+	}
+
+	SPatch* patch = section->patches;
+	while (patch != NULL) {
+		SPatch* next = list_GetNext(patch);
+		uint32_t index = findRemovedRange(offsets, totalOffsets, count, patch->offset);
+		if (index < totalOffsets && offsets[index] <= patch->offset) {
+			list_Remove(section->patches, patch);
+			patch_Free(patch);
+		} else {
+			patch->offset -= index * count;
+		}
+		patch = next;
+	}
+
+	if (section->lineMap != NULL) {
+		for (uint32_t i = 0; i < section->lineMap->totalEntries; ++i) {
+			SLineMapEntry* entry = &section->lineMap->entries[i];
+			entry->offset -= removedBeforeCpuOffset(offsets, totalOffsets, count, entry->offset);
+		}
+	}
+
+	section->evenAlignedSpace -= removedBefore(offsets, totalOffsets, count, section->evenAlignedSpace);
+	section->alignedSpace -= removedBefore(offsets, totalOffsets, count, section->alignedSpace);
+	section->usedSpace -= totalOffsets * count;
+	section->cpuProgramCounter -= totalOffsets * count / xasm_Configuration->minimumWordSize;
+}
+
 void
 sect_OutputConst16At(uint16_t value, uint32_t offset) {
 	if (offset + 2 <= sect_CurrentSize()) {
@@ -468,41 +552,40 @@ sect_OutputFloat64(long double value) {
 }
 
 void
-sect_OutputBinaryFile(string* filename) {
-	FILE* fileHandle;
+sect_OutputBinaryFile(string* filename, uint32_t offset, uint32_t length) {
+	const string* content = inc_ReadBinaryFile(filename);
 
-	if ((fileHandle = fopen(str_String(filename), "rb")) != NULL) {
+	if (content != NULL) {
 		dep_AddDependency(filename);
 
-		fseek(fileHandle, 0, SEEK_END);
-		uint32_t size = ftell(fileHandle);
-		fseek(fileHandle, 0, SEEK_SET);
+		uint32_t size = (uint32_t) str_Length(content);
+		if (offset > size || (length != UINT32_MAX && length > size - offset)) {
+			err_Error(ERROR_OPERAND_RANGE);
+		} else {
+			if (length == UINT32_MAX)
+				length = size - offset;
 
-		if (checkAvailableSpace(size)) {
-			switch (currentSectionType()) {
-				case GROUP_TEXT: {
-					linemap_AddCurrent();
+			if (checkAvailableSpace(length)) {
+				switch (currentSectionType()) {
+					case GROUP_TEXT: {
+						linemap_AddCurrent();
 
-					size_t read = fread(&sect_Current->data[sect_Current->usedSpace], sizeof(uint8_t), size, fileHandle);
-					sect_Current->usedSpace += size;
-					sect_Current->cpuProgramCounter += size / xasm_Configuration->minimumWordSize;
-					if (read != size) {
-						err_Fail(ERROR_READ);
+						memcpy(&sect_Current->data[sect_Current->usedSpace], str_String(content) + offset, length);
+						sect_Current->usedSpace += length;
+						sect_Current->cpuProgramCounter += length / xasm_Configuration->minimumWordSize;
+						break;
+					}
+					case GROUP_BSS: {
+						err_Error(ERROR_SECTION_DATA);
+						break;
+					}
+					default: {
+						internalerror("Unknown GROUP type");
+						break;
 					}
-					break;
-				}
-				case GROUP_BSS: {
-					err_Error(ERROR_SECTION_DATA);
-					break;
-				}
-				default: {
-					internalerror("Unknown GROUP type");
-					break;
 				}
 			}
 		}
-
-		fclose(fileHandle);
 	} else {
 		err_Error(ERROR_NO_FILE);
 	}
@@ -516,6 +599,11 @@ sect_Align(uint32_t alignment) {
 
 	uint32_t t = alignToNext(sect_Current->usedSpace, alignment);
 	sect_SkipBytes(t - sect_Current->usedSpace);
+
+	if (alignment > 2)
+		sect_Current->alignedSpace = sect_Current->usedSpace;
+	else if (alignment == 2)
+		sect_Current->evenAlignedSpace = sect_Current->usedSpace;
 }
 
 void
@@ -530,13 +618,9 @@ sect_SkipBytes(uint32_t count) {
 
 		switch (currentSectionType()) {
 			case GROUP_TEXT: {
-				while (count >= 2) {
-					sect_OutputConst16((opt_Current->uninitializedValue << 8) | opt_Current->uninitializedValue);
-					count -= 2;
-				}
-				while (count--) {
-					sect_OutputConst8((uint8_t) opt_Current->uninitializedValue);
-				}
+				memset(&sect_Current->data[sect_Current->usedSpace], (uint8_t) opt_Current->uninitializedValue, count);
+				sect_Current->usedSpace += count;
+				sect_Current->cpuProgramCounter += count / xasm_Configuration->minimumWordSize;
 				break;
 			}
 			case GROUP_BSS: {
@@ -51,9 +51,15 @@ struct Section {
 	uint32_t align;
 	uint32_t page;
 
+	uint32_t evenAlignedSpace; // usedSpace after the last alignment to two bytes
+	uint32_t alignedSpace;     // usedSpace after the last alignment to more than two bytes
+	uint32_t firstShrinkable;  // CPU offset of the first instruction that may shrink, UINT32_MAX if none
+	uint32_t lastShrinkable;   // CPU offset of the last instruction that may shrink
+
 	struct LineMapSection* lineMap;
 
 	struct Patch* patches;
+	struct Symbol* symbols; // Symbols defined in this section, see sym_FirstSymbolInSection
 
 	uint8_t* data;
 };
@@ -101,6 +107,11 @@ sect_Align(uint32_t align);
 extern uint32_t
 sect_CurrentSize(void);
 
+//	Removes count bytes at each of the offsets, which must be sorted in ascending order and not overlap. Labels, patches
+//	and line map entries following the removed bytes are moved, patches inside them are deleted.
+extern void
+sect_RemoveBytes(SSection* section, const uint32_t* offsets, uint32_t totalOffsets, uint32_t count);
+
 extern void
 sect_OutputExpr8(struct Expression* expr);
 
@@ -110,8 +121,9 @@ sect_OutputExpr16(struct Expression* expr);
 extern void
 sect_OutputExpr32(struct Expression* expr);
 
+//	Outputs length bytes of the file from the offset, or the rest of the file if length is UINT32_MAX
 extern void
-sect_OutputBinaryFile(string* pFile);
+sect_OutputBinaryFile(string* filename, uint32_t offset, uint32_t length);
 
 extern void
 sect_OutputConst8(uint8_t value);
@@ -0,0 +1,403 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+// From util
+#include "crc32.h"
+#include "file.h"
+#include "mem.h"
+#include "set.h"
+#include "str.h"
+#include "strcoll.h"
+
+// From xasm
+#include "includes.h"
+#include "lexer_context.h"
+#include "options.h"
+#include "parse.h"
+#include "parse_directive.h"
+#include "parse_symbol.h"
+#include "section.h"
+#include "snapshot.h"
+#include "symbol.h"
+#include "xasm.h"
+
+#define SNAPSHOT_ID "XSN\1"
+
+//	A snapshot is a cache, when it cannot be read or is out of date the file is assembled instead. It holds:
+//
+//	  SNAPSHOT_ID, options checksum, number of lines, random seed
+//	  number of files, followed by the name and CRC of every file read, in the order they were first read
+//	  number of INCLUDE ONCE file names, followed by the names
+//	  number of symbols, followed by the name, type, flags, file index, line number and value of every symbol
+
+typedef struct {
+	const uint8_t* data;
+	size_t size;
+	size_t position;
+	bool valid;
+} SReader;
+
+/* Internal functions */
+
+static uint32_t
+readLong(SReader* reader) {
+	if (reader->size - reader->position < 4) {
+		reader->valid = false;
+		return 0;
+	}
+
+	const uint8_t* data = &reader->data[reader->position];
+	reader->position += 4;
+	return data[0] | (uint32_t) data[1] << 8u | (uint32_t) data[2] << 16u | (uint32_t) data[3] << 24u;
+}
+
+static string*
+readString(SReader* reader) {
+	uint32_t length = readLong(reader);
+	if (!reader->valid || reader->size - reader->position < length) {
+		reader->valid = false;
+		return NULL;
+	}
+
+	string* result = str_CreateLength((const char*) &reader->data[reader->position], length);
+	reader->position += length;
+	return result;
+}
+
+static void
+writeString(FILE* fileHandle, const string* str) {
+	fputll((uint32_t) str_Length(str), fileHandle);
+	fwrite(str_String(str), 1, str_Length(str), fileHandle);
+}
+
+static bool
+isStringSymbol(ESymbolType type) {
+	return type == SYM_EQUS || type == SYM_MACRO;
+}
+
+static bool
+isSupportedType(ESymbolType type) {
+	return type == SYM_EQU || type == SYM_SET || type == SYM_GROUP || isStringSymbol(type);
+}
+
+//	The symbols defined by the file are those whose definition is in one of the files read since firstFile
+static bool
+isDefinedByFile(const SSymbol* symbol, uint32_t firstFile) {
+	return symbol->fileInfo != NULL && symbol->fileInfo->fileId >= firstFile;
+}
+
+static bool
+canWriteSymbols(uint32_t firstFile) {
+	for (const SSymbol* symbol = sym_FirstSymbol(); symbol != NULL; symbol = sym_NextSymbol(symbol)) {
+		if (isDefinedByFile(symbol, firstFile) &&
+		    (!isSupportedType(symbol->type) || symbol->scope != NULL || symbol->callback.integer != NULL)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void
+writeIncludeOnce(set_t* _, intptr_t element, intptr_t data) {
+	writeString((FILE*) data, (const string*) element);
+}
+
+static void
+countIncludeOnce(set_t* _, intptr_t element, intptr_t data) {
+	*(uint32_t*) data += 1;
+}
+
+static void
+writeSymbols(FILE* fileHandle, uint32_t firstFile) {
+	uint32_t totalSymbols = 0;
+	for (const SSymbol* symbol = sym_FirstSymbol(); symbol != NULL; symbol = sym_NextSymbol(symbol)) {
+		if (isDefinedByFile(symbol, firstFile))
+			++totalSymbols;
+	}
+
+	fputll(totalSymbols, fileHandle);
+	for (const SSymbol* symbol = sym_FirstSymbol(); symbol != NULL; symbol = sym_NextSymbol(symbol)) {
+		if (isDefinedByFile(symbol, firstFile)) {
+			writeString(fileHandle, symbol->name);
+			fputll(symbol->type, fileHandle);
+			fputll(symbol->flags, fileHandle);
+			fputll(symbol->fileInfo->fileId - firstFile, fileHandle);
+			fputll(symbol->lineNumber, fileHandle);
+
+			if (isStringSymbol(symbol->type))
+				writeString(fileHandle, symbol->value.macro);
+			else if (symbol->type == SYM_GROUP)
+				fputll(symbol->value.groupType, fileHandle);
+			else
+				fputll((uint32_t) symbol->value.integer, fileHandle);
+		}
+	}
+}
+
+static void
+writeSnapshot(const string* snapshotName, uint32_t optionsChecksum, uint32_t firstFile, uint32_t totalLines) {
+	if (!canWriteSymbols(firstFile))
+		return;
+
+	//	Assemblies running at the same time may write the snapshot, each writes a file of its own and renames it
+	string* tempName = str_CreateFormat("%s.%d.tmp", str_String(snapshotName), (int) getpid());
+	FILE* fileHandle = fopen(str_String(tempName), "wb");
+	if (fileHandle != NULL) {
+		fwrite(SNAPSHOT_ID, 1, 4, fileHandle);
+		fputll(optionsChecksum, fileHandle);
+		fputll(totalLines, fileHandle);
+		fputll(s_randseed, fileHandle);
+
+		size_t totalFiles;
+		SFileInfo** files = lexctx_GetFileInfo(&totalFiles);
+		fputll((uint32_t) totalFiles - firstFile, fileHandle);
+		for (size_t i = firstFile; i < totalFiles; ++i) {
+			writeString(fileHandle, files[i]->fileName);
+			fputll(inc_FileCrc32(inc_ReadFile(files[i]->fileName)), fileHandle);
+		}
+		mem_Free(files);
+
+		set_t* includeOnce = parse_IncludeOnceFilenames();
+		uint32_t totalIncludeOnce = 0;
+		if (includeOnce != NULL)
+			set_ForEachElement(includeOnce, countIncludeOnce, (intptr_t) &totalIncludeOnce);
+		fputll(totalIncludeOnce, fileHandle);
+		if (includeOnce != NULL)
+			set_ForEachElement(includeOnce, writeIncludeOnce, (intptr_t) fileHandle);
+
+		writeSymbols(fileHandle, firstFile);
+
+		bool written = ferror(fileHandle) == 0;
+		fclose(fileHandle);
+
+#if defined(_WIN32)
+		if (written)
+			remove(str_String(snapshotName));
+#endif
+		if (!written || rename(str_String(tempName), str_String(snapshotName)) != 0)
+			remove(str_String(tempName));
+	}
+
+	str_Free(tempName);
+}
+
+//	Reads the symbols, and defines them if the files are given. Returns false if the snapshot is malformed.
+static bool
+readSymbols(SReader* reader, SFileInfo** files, uint32_t totalFiles) {
+	uint32_t totalSymbols = readLong(reader);
+	for (uint32_t i = 0; i < totalSymbols && reader->valid; ++i) {
+		string* name = readString(reader);
+		ESymbolType type = (ESymbolType) readLong(reader);
+		uint32_t flags = readLong(reader);
+		uint32_t fileIndex = readLong(reader);
+		uint32_t lineNumber = readLong(reader);
+
+		string* value = NULL;
+		uint32_t integer = 0;
+		if (isStringSymbol(type))
+			value = readString(reader);
+		else
+			integer = readLong(reader);
+
+		if (!isSupportedType(type) || fileIndex >= totalFiles)
+			reader->valid = false;
+
+		if (reader->valid && files != NULL) {
+			SSymbol* symbol = NULL;
+			switch (type) {
+				case SYM_EQU:
+					symbol = sym_CreateEqu(name, (int32_t) integer);
+					break;
+				case SYM_SET:
+					symbol = sym_CreateSet(name, (int32_t) integer);
+					break;
+				case SYM_GROUP:
+					symbol = sym_CreateGroup(name, (EGroupType) integer);
+					break;
+				case SYM_EQUS:
+					symbol = sym_CreateEqus(name, value);
+					break;
+				case SYM_MACRO:
+					symbol = sym_CreateMacro(name, value, lineNumber);
+					break;
+				default:
+					break;
+			}
+
+			if (symbol != NULL) {
+				symbol->flags = flags;
+				symbol->fileInfo = files[fileIndex];
+				symbol->lineNumber = lineNumber;
+
+				if (type == SYM_SET && str_EqualConst(name, "__RS"))
+					g_rsSymbol = symbol;
+			}
+		}
+
+		str_Free(value);
+		str_Free(name);
+	}
+
+	return reader->valid && reader->position == reader->size;
+}
+
+static bool
+readSnapshot(SReader* reader, uint32_t optionsChecksum) {
+	if (reader->size < 4 || memcmp(reader->data, SNAPSHOT_ID, 4) != 0)
+		return false;
+
+	reader->position = 4;
+	if (readLong(reader) != optionsChecksum)
+		return false;
+
+	uint32_t totalLines = readLong(reader);
+	uint32_t randomSeed = readLong(reader);
+
+	//	The snapshot is out of date if any of the files read has changed
+	uint32_t totalFiles = readLong(reader);
+	if (!reader->valid || totalFiles == 0 || totalFiles > reader->size)
+		return false;
+
+	SIncludeFile** includeFiles = mem_Alloc(totalFiles * sizeof(SIncludeFile*));
+	bool upToDate = true;
+	for (uint32_t i = 0; i < totalFiles && upToDate; ++i) {
+		string* name = readString(reader);
+		uint32_t crc = readLong(reader);
+		includeFiles[i] = reader->valid ? inc_ReadFile(name) : NULL;
+		upToDate = includeFiles[i] != NULL && inc_FileCrc32(includeFiles[i]) == crc;
+		str_Free(name);
+	}
+
+	size_t includeOncePosition = reader->position;
+	uint32_t totalIncludeOnce = readLong(reader);
+	for (uint32_t i = 0; i < totalIncludeOnce && reader->valid && upToDate; ++i)
+		str_Free(readString(reader));
+
+	//	The symbols are only defined when the whole snapshot can be read
+	size_t symbolsPosition = reader->position;
+	if (upToDate && readSymbols(reader, NULL, totalFiles)) {
+		SFileInfo** files = mem_Alloc(totalFiles * sizeof(SFileInfo*));
+		for (uint32_t i = 0; i < totalFiles; ++i)
+			files[i] = lexctx_AddFile(includeFiles[i]);
+
+		reader->position = includeOncePosition;
+		totalIncludeOnce = readLong(reader);
+		for (uint32_t i = 0; i < totalIncludeOnce; ++i) {
+			string* name = readString(reader);
+			parse_SetIncludeOnce(name);
+			str_Free(name);
+		}
+
+		reader->position = symbolsPosition;
+		readSymbols(reader, files, totalFiles);
+		mem_Free(files);
+
+		xasm_TotalLines += totalLines;
+		s_randseed = randomSeed;
+	} else {
+		upToDate = false;
+	}
+
+	mem_Free(includeFiles);
+	return upToDate;
+}
+
+static bool
+loadSnapshot(const string* snapshotName, uint32_t optionsChecksum) {
+	FILE* fileHandle = fopen(str_String(snapshotName), "rb");
+	if (fileHandle == NULL)
+		return false;
+
+	string* content = str_ReadFile(fileHandle, fsize(fileHandle));
+	fclose(fileHandle);
+
+	SReader reader = {(const uint8_t*) str_String(content), str_Length(content), 0, true};
+	bool loaded = readSnapshot(&reader, optionsChecksum);
+
+	str_Free(content);
+	return loaded;
+}
+
+static bool
+sameOptions(const SOptions* options1, const SOptions* options2) {
+	return options1->endianness == options2->endianness &&
+	       memcmp(options1->binaryLiteralCharacters, options2->binaryLiteralCharacters,
+	              sizeof(options1->binaryLiteralCharacters)) == 0 &&
+	       memcmp(options1->gameboyLiteralCharacters, options2->gameboyLiteralCharacters,
+	              sizeof(options1->gameboyLiteralCharacters)) == 0 &&
+	       options1->uninitializedValue == options2->uninitializedValue &&
+	       options1->sectionAlignment == options2->sectionAlignment &&
+	       options1->disabledWarningsCount == options2->disabledWarningsCount &&
+	       memcmp(options1->disabledWarnings, options2->disabledWarnings,
+	              options1->disabledWarningsCount * sizeof(options1->disabledWarnings[0])) == 0 &&
+	       options1->allowReservedKeywordLabels == options2->allowReservedKeywordLabels &&
+	       options1->enableDebugInfo == options2->enableDebugInfo && options1->createGroups == options2->createGroups;
+}
+
+//	Assembles the file, and writes the snapshot if the file only defined symbols and macros
+static bool
+assembleFile(SIncludeFile* file, const string* snapshotName, uint32_t optionsChecksum) {
+	size_t firstFile;
+	mem_Free(lexctx_GetFileInfo(&firstFile));
+
+	SOptions* options = opt_Current;
+	SOptions initialOptions = *opt_Current;
+	uint32_t totalErrors = xasm_TotalErrors;
+	uint32_t totalWarnings = xasm_TotalWarnings;
+	uint32_t totalLines = xasm_TotalLines;
+
+	lexctx_AddFile(file);
+	lexctx_OpenFile(file);
+	bool result = parse_Do();
+	lexctx_CloseFile();
+
+	if (result && xasm_TotalErrors == totalErrors && xasm_TotalWarnings == totalWarnings && sect_Sections == NULL &&
+	    opt_Current == options && sameOptions(&initialOptions, opt_Current)) {
+		writeSnapshot(snapshotName, optionsChecksum, (uint32_t) firstFile, xasm_TotalLines - totalLines);
+	}
+
+	return result;
+}
+
+/* Exported functions */
+
+extern bool
+snap_PreInclude(string* fileName, uint32_t optionsChecksum) {
+	SIncludeFile* file = lexctx_ReadFile(fileName);
+	if (file == NULL)
+		return false;
+
+	string* snapshotName = str_CreateFormat("%s.snapshot", str_String(file->name));
+
+	bool result = loadSnapshot(snapshotName, optionsChecksum) || assembleFile(file, snapshotName, optionsChecksum);
+
+	str_Free(snapshotName);
+	return result;
+}
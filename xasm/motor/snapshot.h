@@ -0,0 +1,33 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XASM_MOTOR_SNAPSHOT_H_INCLUDED_
+#define XASM_MOTOR_SNAPSHOT_H_INCLUDED_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "str.h"
+
+//	Includes the file before the main file is opened. The symbols and macros it defines are read from the snapshot
+//	written next to it when the snapshot is up to date. Otherwise the file is assembled, and the snapshot is written if
+//	the file only defined symbols. The options checksum must cover all options that affect the assembly.
+extern bool
+snap_PreInclude(string* fileName, uint32_t optionsChecksum);
+
+#endif /* XASM_MOTOR_SNAPSHOT_H_INCLUDED_ */
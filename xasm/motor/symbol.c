@@ -26,6 +26,7 @@
 
 #include "errors.h"
 #include "lexer_context.h"
+#include "lexer_tokens.h"
 #include "parse_symbol.h"
 #include "section.h"
 #include "str.h"
@@ -51,6 +52,8 @@ static uint32_t defaultSymbolFlags[] = {
 
 #define DELIMITERS " \t\n$%%+-*/()[]:@;,"
 
+#define SYMBOL_TABLE_INITIAL_SIZE 1024U
+
 static const char* token;
 static size_t tokenLength;
 
@@ -58,7 +61,10 @@ SSymbol* sym_CurrentScope = NULL;
 
 uint32_t s_randseed = 0x1337C0DE;
 
-SSymbol* sym_hashedSymbols[SYMBOL_HASH_SIZE];
+//	The symbol table uses open addressing with linear probing, its size is always a power of two
+static SSymbol** s_symbolTable = NULL;
+static uint32_t s_symbolTableSize = 0;
+static uint32_t s_totalSymbols = 0;
 
 // Machine definition parsers
 
@@ -216,18 +222,136 @@ freeSymbol(SSymbol* symbol) {
 	if ((symbol->type == SYM_MACRO || symbol->type == SYM_EQUS) && symbol->callback.string == NULL) {
 		str_Free(symbol->value.macro);
 	}
+	if (symbol->macroTokens != NULL) {
+		lextok_Free(symbol->macroTokens);
+	}
 	mem_Free(symbol);
 }
 
 static uint32_t
-hash(const string* name) {
-	return str_JenkinsHash(name) & (SYMBOL_HASH_SIZE - 1);
+hash(const string* name, const SSymbol* scope) {
+	uint32_t nameHash = str_JenkinsHash(name);
+	return scope != NULL ? nameHash ^ (scope->hash * 0x9E3779B1u) : nameHash;
+}
+
+static void
+insertSymbol(SSymbol* symbol) {
+	uint32_t mask = s_symbolTableSize - 1;
+	uint32_t slot = symbol->hash & mask;
+
+	while (s_symbolTable[slot] != NULL)
+		slot = (slot + 1) & mask;
+
+	s_symbolTable[slot] = symbol;
+	symbol->slot = slot;
+}
+
+static void
+growSymbolTable(void) {
+	SSymbol** oldTable = s_symbolTable;
+	uint32_t oldSize = s_symbolTableSize;
+
+	s_symbolTableSize = oldSize == 0 ? SYMBOL_TABLE_INITIAL_SIZE : oldSize * 2;
+	s_symbolTable = (SSymbol**) mem_Alloc(sizeof(SSymbol*) * s_symbolTableSize);
+	memset(s_symbolTable, 0, sizeof(SSymbol*) * s_symbolTableSize);
+
+	for (uint32_t i = 0; i < oldSize; ++i) {
+		if (oldTable[i] != NULL)
+			insertSymbol(oldTable[i]);
+	}
+
+	mem_Free(oldTable);
+}
+
+static void
+addToSection(SSymbol* symbol, SSection* section) {
+	symbol->section = section;
+	symbol->nextInSection = section->symbols;
+	section->symbols = symbol;
+}
+
+static void
+removeFromSection(SSymbol* symbol) {
+	SSymbol** link = &symbol->section->symbols;
+	while (*link != symbol)
+		link = &(*link)->nextInSection;
+
+	*link = symbol->nextInSection;
+	symbol->section = NULL;
+	symbol->nextInSection = NULL;
+}
+
+//	Sorts a list of symbols by their slot in the symbol table
+static SSymbol*
+sortBySlot(SSymbol* list) {
+	if (list == NULL || list->nextInSection == NULL)
+		return list;
+
+	SSymbol* half = list;
+	for (SSymbol* fast = list->nextInSection; fast->nextInSection != NULL && fast->nextInSection->nextInSection != NULL;
+	     fast = fast->nextInSection->nextInSection) {
+		half = half->nextInSection;
+	}
+
+	SSymbol* left = list;
+	SSymbol* right = half->nextInSection;
+	half->nextInSection = NULL;
+
+	left = sortBySlot(left);
+	right = sortBySlot(right);
+
+	SSymbol* result = NULL;
+	SSymbol** tail = &result;
+	while (left != NULL && right != NULL) {
+		if (left->slot < right->slot) {
+			*tail = left;
+			left = left->nextInSection;
+		} else {
+			*tail = right;
+			right = right->nextInSection;
+		}
+		tail = &(*tail)->nextInSection;
+	}
+	*tail = left != NULL ? left : right;
+
+	return result;
+}
+
+static void
+removeSymbol(SSymbol* symbol) {
+	if (symbol->section != NULL)
+		removeFromSection(symbol);
+
+	uint32_t mask = s_symbolTableSize - 1;
+	uint32_t hole = symbol->slot;
+
+	//	Move the following symbols of the probe sequence back, so no probe sequence is broken by the hole
+	for (uint32_t slot = (hole + 1) & mask; s_symbolTable[slot] != NULL; slot = (slot + 1) & mask) {
+		SSymbol* next = s_symbolTable[slot];
+		uint32_t home = next->hash & mask;
+
+		if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+			s_symbolTable[hole] = next;
+			next->slot = hole;
+			hole = slot;
+		}
+	}
+
+	s_symbolTable[hole] = NULL;
+	--s_totalSymbols;
 }
 
 static SSymbol*
 getSymbol(const string* name, const SSymbol* scope) {
-	for (SSymbol* symbol = sym_hashedSymbols[hash(name)]; symbol; symbol = list_GetNext(symbol)) {
-		if (symbol->scope == scope && str_Equal(symbol->name, name))
+	if (s_totalSymbols == 0)
+		return NULL;
+
+	uint32_t nameHash = hash(name, scope);
+	uint32_t mask = s_symbolTableSize - 1;
+
+	for (uint32_t slot = nameHash & mask; s_symbolTable[slot] != NULL; slot = (slot + 1) & mask) {
+		SSymbol* symbol = s_symbolTable[slot];
+		if (symbol->hash == nameHash && symbol->scope == scope && str_Equal(symbol->name, name))
 			return symbol;
 	}
 
@@ -241,16 +365,31 @@ createSymbol(const string* name, SSymbol* scope) {
 
 	SET_TYPE_AND_FLAGS(newSymbol, SYM_UNDEFINED);
 	str_Assign(&newSymbol->name, name);
+	newSymbol->hash = hash(name, scope);
 	newSymbol->scope = scope;
 	newSymbol->fileInfo = lexctx_TokenFileInfo();
 	newSymbol->lineNumber = lexctx_TokenLineNumber();
 
-	SSymbol** hashTableEntry = &sym_hashedSymbols[hash(name)];
-	list_Insert(*hashTableEntry, newSymbol);
+	//	Keep the load factor below 3/4
+	if ((s_totalSymbols + 1) * 4 > s_symbolTableSize * 3)
+		growSymbolTable();
+
+	insertSymbol(newSymbol);
+	++s_totalSymbols;
 
 	return newSymbol;
 }
 
+static SSymbol*
+findSymbolFromSlot(uint32_t slot) {
+	for (; slot < s_symbolTableSize; ++slot) {
+		if (s_symbolTable[slot] != NULL)
+			return s_symbolTable[slot];
+	}
+
+	return NULL;
+}
+
 static bool
 isLocalName(const string* name) {
 	return str_CharAt(name, 0) == '$' || str_CharAt(name, 0) == '.' || str_CharAt(name, -1) == '$';
@@ -468,7 +607,11 @@ sym_CreateLabel(const string* name) {
 				symbol->value.integer = sect_Current->cpuProgramCounter + sect_Current->cpuAdjust + sect_Current->cpuOrigin;
 			} else {
 				SET_TYPE_AND_FLAGS(symbol, SYM_LABEL);
-				symbol->section = sect_Current;
+				if (symbol->section != sect_Current) {
+					if (symbol->section != NULL)
+						removeFromSection(symbol);
+					addToSection(symbol, sect_Current);
+				}
 				symbol->value.integer = sect_Current->cpuProgramCounter;
 			}
 			return symbol;
@@ -565,11 +708,10 @@ sym_Global(const string* name) {
 
 extern bool
 sym_Purge(const string* name) {
-	SSymbol** hashTableEntry = &sym_hashedSymbols[hash(name)];
 	SSymbol* symbol = getSymbol(name, assumedScopeOf(name));
 
 	if (symbol != NULL) {
-		list_Remove(*hashTableEntry, symbol);
+		removeSymbol(symbol);
 		freeSymbol(symbol);
 	}
 
@@ -578,21 +720,36 @@ sym_Purge(const string* name) {
 
 extern void
 sym_PurgeWhere(bool (*predicate)(SSymbol* symbol)) {
-	for (uint32_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		SSymbol** list = &sym_hashedSymbols[i];
-		SSymbol* sym = *list;
-
-		while (sym != NULL) {
-			SSymbol* next = list_GetNext(sym);
-			if (predicate(sym)) {
-				list_Remove(*list, sym);
-				freeSymbol(sym);
-			}
-			sym = next;
+	uint32_t slot = 0;
+	while (slot < s_symbolTableSize) {
+		SSymbol* symbol = s_symbolTable[slot];
+
+		//	Removing a symbol may move another symbol into its slot, so the slot is examined again
+		if (symbol != NULL && predicate(symbol)) {
+			removeSymbol(symbol);
+			freeSymbol(symbol);
+		} else {
+			++slot;
 		}
 	}
 }
 
+extern SSymbol*
+sym_FirstSymbol(void) {
+	return findSymbolFromSlot(0);
+}
+
+extern SSymbol*
+sym_NextSymbol(const SSymbol* symbol) {
+	return findSymbolFromSlot(symbol->slot + 1);
+}
+
+extern SSymbol*
+sym_FirstSymbolInSection(SSection* section) {
+	section->symbols = sortBySlot(section->symbols);
+	return section->symbols;
+}
+
 extern bool
 sym_IsString(const string* name) {
 	SSymbol* symbol = getSymbol(name, assumedScopeOf(name));
@@ -669,11 +826,9 @@ extern void
 sym_ErrorOnUndefined(void) {
 	markUsedSymbols();
 
-	for (uint_fast16_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		for (SSymbol* symbol = sym_hashedSymbols[i]; symbol; symbol = list_GetNext(symbol)) {
-			if (symbol->type == SYM_UNDEFINED && (symbol->flags & SYMF_USED))
-				err_SymbolError(symbol, ERROR_SYMBOL_UNDEFINED, str_String(symbol->name));
-		}
+	for (SSymbol* symbol = sym_FirstSymbol(); symbol != NULL; symbol = sym_NextSymbol(symbol)) {
+		if (symbol->type == SYM_UNDEFINED && (symbol->flags & SYMF_USED))
+			err_SymbolError(symbol, ERROR_SYMBOL_UNDEFINED, str_String(symbol->name));
 	}
 }
 
@@ -741,12 +896,13 @@ sym_Init(void) {
 
 extern void
 sym_Exit(void) {
-	for (size_t i = 0; i < SYMBOL_HASH_SIZE; ++i) {
-		SSymbol* symbol = sym_hashedSymbols[i];
-		while (symbol != NULL) {
-			SSymbol* next = list_GetNext(symbol);
-			freeSymbol(symbol);
-			symbol = next;
-		}
+	for (uint32_t i = 0; i < s_symbolTableSize; ++i) {
+		if (s_symbolTable[i] != NULL)
+			freeSymbol(s_symbolTable[i]);
 	}
+
+	mem_Free(s_symbolTable);
+	s_symbolTable = NULL;
+	s_symbolTableSize = 0;
+	s_totalSymbols = 0;
 }
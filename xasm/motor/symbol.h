@@ -21,12 +21,9 @@
 
 #include <stdbool.h>
 
-#include "lists.h"
 #include "str.h"
 #include "util.h"
 
-#define SYMBOL_HASH_SIZE 1024U
-
 struct FileInfo;
 
 typedef enum {
@@ -62,9 +59,9 @@ typedef enum {
 #define SYMF_USED        0x10000000u
 
 typedef struct Symbol {
-	list_Data(struct Symbol);
-
 	string* name;
+	uint32_t hash; // hash of the name and scope
+	uint32_t slot; // index in the symbol table
 	ESymbolType type;
 	uint32_t flags;
 
@@ -73,6 +70,7 @@ typedef struct Symbol {
 
 	struct Symbol* scope;
 	struct Section* section;
+	struct Symbol* nextInSection; // next symbol in the section's list of symbols
 
 	union {
 		int32_t (*integer)(struct Symbol*);
@@ -86,6 +84,8 @@ typedef struct Symbol {
 		string* macro;
 	} value;
 
+	struct LexerTokens* macroTokens; // tokens recorded while the macro was expanded, or NULL
+
 	uint32_t id; // used by object output routines
 } SSymbol;
 
@@ -183,11 +183,29 @@ sym_IsStructure(const string* name);
 extern void
 sym_ErrorOnUndefined(void);
 
+//	Returns the first symbol of the symbol table, symbols are returned in no particular order
+extern SSymbol*
+sym_FirstSymbol(void);
+
+//	Returns the symbol following the symbol in the symbol table, or NULL. No symbols must be created or purged while
+//	iterating.
+extern SSymbol*
+sym_NextSymbol(const SSymbol* symbol);
+
+//	Returns the first symbol defined in the section. The symbols of a section are returned in the same order as
+//	sym_FirstSymbol and sym_NextSymbol would return them.
+extern SSymbol*
+sym_FirstSymbolInSection(struct Section* section);
+
+//	Returns the symbol following the symbol in its section, or NULL
+INLINE SSymbol*
+sym_NextSymbolInSection(const SSymbol* symbol) {
+	return symbol->nextInSection;
+}
+
 INLINE bool
 sym_IsNotDefined(const string* symbolName) {
 	return !sym_IsDefined((symbolName));
 }
 
-extern SSymbol* sym_hashedSymbols[SYMBOL_HASH_SIZE];
-
 #endif // XASM_MOTOR_SYMBOL_H_INCLUDED_
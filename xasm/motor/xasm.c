@@ -37,19 +37,32 @@
 #include <crtdbg.h>
 #endif
 
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "crc32.h"
+#include "file.h"
 #include "str.h"
+#include "strbuf.h"
 
 #include "amigaobject.h"
 #include "binaryobject.h"
+#include "cache.h"
 #include "dependency.h"
 #include "elf.h"
 #include "errors.h"
+#include "expression.h"
+#include "includes.h"
 #include "lexer.h"
 #include "object.h"
 #include "options.h"
 #include "parse.h"
+#include "parse_directive.h"
 #include "patch.h"
 #include "section.h"
+#include "snapshot.h"
 #include "symbol.h"
 #include "tokens.h"
 #include "xasm.h"
@@ -63,13 +76,18 @@ uint32_t xasm_TotalWarnings = 0;
 
 const SConfiguration* xasm_Configuration = NULL;
 
+static string* g_preIncludeFile = NULL;
+static uint32_t g_optionsChecksum = 0;
+
 static void
 printUsage(void) {
 	printf("%s v" ASMOTOR_VERSION "\n\nUsage: %s [options] asmfile\n"
+	       "       %s [options] -j<n> asmfile...\n"
 	       "Options:\n"
 	       "    -a<n>    Section alignment when writing binary file (default is %d bytes)\n"
 	       "    -b<AS>   Change the two characters used for binary constants\n"
 	       "             (default is 01)\n"
+	       "    -c<dir>  Cache assembly results in <dir>\n"
 	       "    -d<FILE> Output dependency file for GNU Make\n"
 	       "    -D<NAME> Define EQU symbol with the value 1\n"
 	       "    -e(l|b)  Change endianness\n"
@@ -78,7 +96,8 @@ printUsage(void) {
 	       "                 e - ELF object file\n"
 	       "                 b - binary file\n"
 	       "                 v - verilog readmemh file\n",
-	       xasm_Configuration->executableName, xasm_Configuration->executableName, xasm_Configuration->sectionAlignment);
+	       xasm_Configuration->executableName, xasm_Configuration->executableName, xasm_Configuration->executableName,
+	       xasm_Configuration->sectionAlignment);
 
 	if (xasm_Configuration->supportAmiga) {
 		printf("                 g - Amiga executable file\n"
@@ -88,7 +107,10 @@ printUsage(void) {
 	printf("    -g       Include debug information\n"
 	       "    -h       This text\n"
 	       "    -i<dir>  Extra include path (can appear more than once)\n"
+	       "    -j<n>    Assemble several files, running <n> assemblies at once\n"
 	       "    -o<f>    Write assembly output to <file>\n"
+	       "    -p<file> Include <file> before the source file, keeping a snapshot\n"
+	       "             of the symbols it defines\n"
 	       "    -s<file> Use section types from machine definition file\n"
 	       "    -v       Verbose text output\n"
 	       "    -w<d>    Disable warning <d> (four digits)\n"
@@ -100,6 +122,20 @@ printUsage(void) {
 	exit(EXIT_SUCCESS);
 }
 
+//	The contents of a file named by an option change the result of assembly as well as its name
+static void
+appendFileChecksum(string_buffer* text, const char* fileName) {
+	FILE* fileHandle = fopen(fileName, "rb");
+	if (fileHandle == NULL)
+		return;
+
+	string* content = str_ReadFile(fileHandle, fsize(fileHandle));
+	fclose(fileHandle);
+
+	strbuf_AppendFormat(text, " %08X", crc32((const uint8_t*) str_String(content), str_Length(content)));
+	str_Free(content);
+}
+
 static bool
 writeOutput(char format, string* outputFilename, string* sourceFilename) {
 	switch (format) {
@@ -120,12 +156,207 @@ writeOutput(char format, string* outputFilename, string* sourceFilename) {
 	}
 }
 
+static void
+initTokens(void) {
+	lex_Init();
+	tokens_Init(xasm_Configuration->supportFloat);
+	if (xasm_Configuration->supportFloat) {
+		assert(sizeof(float) == 4);
+		assert(sizeof(double) == 8);
+	}
+	xasm_Configuration->defineTokens();
+	opt_Updated();
+}
+
+static void
+assembleFile(string* sourcePath, string* outputFilename, char format, bool verbose, clock_t startClock) {
+	if (outputFilename != NULL && cache_Restore(sourcePath, outputFilename)) {
+		if (verbose)
+			printf("Success! Output restored from cache\n");
+
+		dep_SetMainOutput(outputFilename);
+		dep_WriteDependencyFile();
+		return;
+	}
+
+	lex_SetMainFile(sourcePath);
+	if (g_preIncludeFile != NULL && !snap_PreInclude(g_preIncludeFile, g_optionsChecksum))
+		return;
+
+	if (!lex_OpenMainFile(sourcePath))
+		return;
+
+	bool parseResult = parse_Do();
+
+	if (parseResult) {
+		if (xasm_Configuration->relaxSections != NULL)
+			xasm_Configuration->relaxSections();
+
+		patch_OptimizeAll();
+		patch_BackPatch();
+
+		sym_ErrorOnUndefined();
+	}
+
+	if (parseResult && xasm_TotalErrors == 0) {
+		if (verbose) {
+			clock_t endClock = clock();
+
+			float timespent = ((float) (endClock - startClock)) / CLOCKS_PER_SEC;
+			printf("Success! %u lines in %.02f seconds ", xasm_TotalLines, timespent);
+			if (timespent == 0) {
+				printf("\n");
+			} else {
+				printf("(%d lines/minute)\n", (int) (60 / timespent * xasm_TotalLines));
+			}
+			if (xasm_TotalWarnings != 0) {
+				printf("Encountered %u warnings\n", xasm_TotalWarnings);
+			}
+		}
+
+		if (outputFilename != NULL) {
+			dep_SetMainOutput(outputFilename);
+			dep_WriteDependencyFile();
+			if (!writeOutput(format, outputFilename, sourcePath)) {
+				dep_RemoveDependencyfile();
+				remove(str_String(outputFilename));
+			} else if (xasm_TotalWarnings == 0 && !parse_Printed()) {
+				//	Warnings and printed text would be lost when the result is restored
+				cache_Store(sourcePath, outputFilename);
+			}
+		}
+	}
+}
+
+static void
+exitModules(void) {
+	opt_Close();
+
+	dep_Exit();
+	inc_Exit();
+	sym_Exit();
+	lex_Exit();
+	sect_Exit();
+	patch_Exit();
+	expr_Exit();
+	cache_Exit();
+}
+
+#if !defined(_WIN32)
+
+//	Replaces the extension of the file name, or appends the extension if the name has none
+static string*
+replaceExtension(const string* fileName, const char* extension) {
+	const char* name = str_String(fileName);
+	const char* dot = strrchr(name, '.');
+	if (dot != NULL && (strchr(dot, '/') != NULL || strchr(dot, '\\') != NULL))
+		dot = NULL;
+
+	size_t length = dot != NULL ? (size_t) (dot - name) : str_Length(fileName);
+
+	string* baseName = str_Slice(fileName, 0, length);
+	string* extensionString = str_Create(extension);
+	string* result = str_Concat(baseName, extensionString);
+	str_Free(extensionString);
+	str_Free(baseName);
+
+	return result;
+}
+
+//	The extension of the output file written next to a source file by -j
+static const char*
+outputExtension(char format) {
+	switch (format) {
+		case 'b':
+			return ".bin";
+		case 'v':
+			return ".mem";
+		case 'g':
+			return ".exe";
+		default:
+			return ".o";
+	}
+}
+
+//	Assembles one of several files in a process of its own, the output is written next to the source file
+static int
+assembleUnit(const char* sourceFile, char format, bool dependencyFile, bool verbose) {
+	clock_t startClock = clock();
+
+	string* sourcePath = str_Create(sourceFile);
+	string* outputFilename = replaceExtension(sourcePath, outputExtension(format));
+
+	if (dependencyFile) {
+		string* dependencyFilename = replaceExtension(sourcePath, ".d");
+		dep_Initialize(str_String(dependencyFilename));
+		str_Free(dependencyFilename);
+	}
+
+	assembleFile(sourcePath, outputFilename, format, verbose, startClock);
+
+	str_Free(outputFilename);
+	str_Free(sourcePath);
+
+	err_PrintAll();
+	exitModules();
+
+	return xasm_TotalErrors > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static bool
+waitForUnit(void) {
+	int status;
+	return wait(&status) > 0 && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+//	Every file is assembled by a child process starting from the state set up by the options, so the output is the same
+//	as when the file is assembled on its own. The keyword tables are shared by all the child processes.
+static int
+assembleFiles(char* sourceFiles[], int totalFiles, int totalJobs, char format, bool dependencyFiles, bool verbose) {
+	initTokens();
+
+	//	Print the messages from the options now, or every child process would print them
+	err_PrintAll();
+	fflush(stdout);
+	fflush(stderr);
+
+	int rcode = EXIT_SUCCESS;
+	int runningJobs = 0;
+
+	for (int i = 0; i < totalFiles; ++i) {
+		if (runningJobs == totalJobs) {
+			if (!waitForUnit())
+				rcode = EXIT_FAILURE;
+			--runningJobs;
+		}
+
+		pid_t pid = fork();
+		if (pid == 0) {
+			exit(assembleUnit(sourceFiles[i], format, dependencyFiles, verbose));
+		} else if (pid > 0) {
+			++runningJobs;
+		} else {
+			err_Error(ERROR_BATCH_START, sourceFiles[i]);
+		}
+	}
+
+	while (runningJobs > 0) {
+		if (!waitForUnit())
+			rcode = EXIT_FAILURE;
+		--runningJobs;
+	}
+
+	return rcode;
+}
+
+#endif
+
 extern int
 xasm_Main(const SConfiguration* configuration, int argc, char* argv[]) {
 	xasm_Configuration = configuration;
 
 	int argn = 1;
-	int rcode;
+	int rcode = EXIT_SUCCESS;
 
 #if defined(_DEBUG) && defined(_WIN32) && !defined(__MINGW32__)
 	_CrtSetDbgFlag(_CrtSetDbgFlag(_CRTDBG_REPORT_FLAG) | _CRTDBG_LEAK_CHECK_DF | _CRTDBG_CHECK_ALWAYS_DF |
@@ -146,15 +377,45 @@ xasm_Main(const SConfiguration* configuration, int argc, char* argv[]) {
 
 	char format = 'x';
 	string* outputFilename = NULL;
+	const char* dependencyFilename = NULL;
+	const char* cacheDirectory = NULL;
+	int totalJobs = 0;
 	bool verbose = false;
+
+	//	The options that change how a file assembles, a snapshot is only used by assemblies with the same options
+	string_buffer* optionsText = strbuf_Create();
+	strbuf_AppendFormat(optionsText, "%s v" ASMOTOR_VERSION, xasm_Configuration->executableName);
+
 	while (argc && argv[argn][0] == '-') {
+		switch (argv[argn][1]) {
+			case 'c':
+			case 'd':
+			case 'j':
+			case 'o':
+			case 'p':
+			case 'v':
+				break;
+			case 's':
+				strbuf_AppendChar(optionsText, '\n');
+				strbuf_AppendStringZero(optionsText, argv[argn]);
+				appendFileChecksum(optionsText, &argv[argn][2]);
+				break;
+			default:
+				strbuf_AppendChar(optionsText, '\n');
+				strbuf_AppendStringZero(optionsText, argv[argn]);
+				break;
+		}
+
 		switch (argv[argn][1]) {
 			case '?':
 			case 'h':
 				printUsage();
 				break;
+			case 'c':
+				cacheDirectory = &argv[argn][2];
+				break;
 			case 'd':
-				dep_Initialize(&argv[argn][2]);
+				dependencyFilename = &argv[argn][2];
 				break;
 			case 'D': {
 				string* name = str_Create(&argv[argn][2]);
@@ -191,9 +452,20 @@ xasm_Main(const SConfiguration* configuration, int argc, char* argv[]) {
 					}
 				}
 				break;
+#if !defined(_WIN32)
+			case 'j':
+				totalJobs = atoi(&argv[argn][2]);
+				if (totalJobs <= 0)
+					err_Warn(WARN_OPTION, argv[argn]);
+				break;
+#endif
 			case 'o':
 				outputFilename = str_Create(&argv[argn][2]);
 				break;
+			case 'p':
+				str_Free(g_preIncludeFile);
+				g_preIncludeFile = str_Create(&argv[argn][2]);
+				break;
 			case 's':
 				if (sym_ReadMachineDefinitionFile(&argv[argn][2])) {
 					opt_Current->createGroups = false;
@@ -220,59 +492,41 @@ xasm_Main(const SConfiguration* configuration, int argc, char* argv[]) {
 		--argc;
 	}
 
-	if (xasm_TotalErrors == 0) {
-		xasm_Configuration->defineSymbols();
-
-		rcode = EXIT_SUCCESS;
+	g_optionsChecksum = crc32((const uint8_t*) strbuf_Data(optionsText), strbuf_Size(optionsText));
 
-		if (argc == 1) {
-			string* sourcePath = str_Create(argv[argn]);
+	//	The pre-included file changes the result of assembly, but not the snapshot of the file itself
+	if (cacheDirectory != NULL) {
+		if (g_preIncludeFile != NULL)
+			strbuf_AppendFormat(optionsText, "\n-p%s", str_String(g_preIncludeFile));
 
-			if (lex_Init(sourcePath)) {
-				tokens_Init(configuration->supportFloat);
-				if (configuration->supportFloat) {
-					assert(sizeof(float) == 4);
-					assert(sizeof(double) == 8);
-				}
-				xasm_Configuration->defineTokens();
-				opt_Updated();
+		string* options = strbuf_String(optionsText);
+		cache_Initialize(cacheDirectory, options);
+		str_Free(options);
+	}
+	strbuf_Free(optionsText);
 
-				bool parseResult = parse_Do();
+	if (xasm_TotalErrors == 0) {
+		xasm_Configuration->defineSymbols();
 
-				if (parseResult) {
-					patch_OptimizeAll();
-					patch_BackPatch();
+		if (argc == 1 && (totalJobs == 0 || outputFilename != NULL)) {
+			string* sourcePath = str_Create(argv[argn]);
 
-					sym_ErrorOnUndefined();
-				}
+			if (dependencyFilename != NULL)
+				dep_Initialize(dependencyFilename);
 
-				if (parseResult && xasm_TotalErrors == 0) {
-					if (verbose) {
-						clock_t endClock = clock();
-
-						float timespent = ((float) (endClock - startClock)) / CLOCKS_PER_SEC;
-						printf("Success! %u lines in %.02f seconds ", xasm_TotalLines, timespent);
-						if (timespent == 0) {
-							printf("\n");
-						} else {
-							printf("(%d lines/minute)\n", (int) (60 / timespent * xasm_TotalLines));
-						}
-						if (xasm_TotalWarnings != 0) {
-							printf("Encountered %u warnings\n", xasm_TotalWarnings);
-						}
-					}
+			initTokens();
+			assembleFile(sourcePath, outputFilename, format, verbose, startClock);
 
-					if (outputFilename != NULL) {
-						dep_SetMainOutput(outputFilename);
-						dep_WriteDependencyFile();
-						if (!writeOutput(format, outputFilename, sourcePath)) {
-							dep_RemoveDependencyfile();
-							remove(str_String(outputFilename));
-						}
-					}
-				}
-			}
 			str_Free(sourcePath);
+#if !defined(_WIN32)
+		} else if (argc >= 1 && totalJobs > 0) {
+			if (outputFilename != NULL)
+				err_Error(ERROR_BATCH_OPTION, "-o");
+			else if (dependencyFilename != NULL && dependencyFilename[0] != 0)
+				err_Error(ERROR_BATCH_OPTION, "-d");
+			else
+				rcode = assembleFiles(&argv[argn], argc, totalJobs, format, dependencyFilename != NULL, verbose);
+#endif
 		} else if (argc > 1) {
 			err_Error(ERROR_TOO_MANY_FILES, argv[argn]);
 		}
@@ -284,12 +538,8 @@ xasm_Main(const SConfiguration* configuration, int argc, char* argv[]) {
 	}
 
 	str_Free(outputFilename);
-	opt_Close();
-
-	dep_Exit();
-	sym_Exit();
-	lex_Exit();
-	sect_Exit();
+	str_Free(g_preIncludeFile);
+	exitModules();
 
 	//	mem_ShowLeaks();
 
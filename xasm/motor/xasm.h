@@ -94,6 +94,8 @@ typedef struct Configuration {
 	void (*assignSection)(SSection* section);
 
 	bool (*isValidLocalName)(const string* name);
+
+	void (*relaxSections)(void); // Optional, called before patching to shrink instructions
 } SConfiguration;
 
 extern const SConfiguration* xasm_Configuration;
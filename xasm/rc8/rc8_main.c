@@ -63,6 +63,8 @@ static SConfiguration g_xasmConfiguration = {
     rc8_AssignSection,
 
     rc8_IsValidLocalName,
+
+    NULL,
 };
 
 extern int
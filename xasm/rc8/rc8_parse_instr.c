@@ -900,7 +900,7 @@ static SRegisterMode g_RegisterModes[T_RC8_REG_HL_IND_PRE_DEC - T_RC8_REG_F + 1]
 
 static bool
 parseAddressingMode(SAddressingMode* addrMode, int allowedModes) {
-	SLexerContext bm;
+	SLexerBookmark bm;
 	lex_Bookmark(&bm);
 
 	if (allowedModes & MODE_REGISTER_MASK) {
@@ -62,6 +62,8 @@ static SConfiguration g_xasmConfiguration = {
     schip_AssignSection,
 
     schip_IsValidLocalName,
+
+    NULL,
 };
 
 extern int
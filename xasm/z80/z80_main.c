@@ -61,6 +61,8 @@ SConfiguration z80_XasmConfiguration = {
     z80_AssignSection,
 
     z80_IsValidLocalName,
+
+    NULL,
 };
 
 extern int
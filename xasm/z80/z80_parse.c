@@ -1129,7 +1129,7 @@ parse_AddrMode(SAddressingMode* addrMode) {
 
 	if (lex_Context->token.id == '[' || lex_Context->token.id == '(') {
 		char endToken = (char) (lex_Context->token.id == '[' ? ']' : ')');
-		SLexerContext bm;
+		SLexerBookmark bm;
 
 		lex_Bookmark(&bm);
 		parse_GetToken();
@@ -1161,7 +1161,7 @@ parse_AddrMode(SAddressingMode* addrMode) {
 	}
 
 	if (lex_Context->token.id == '[') {
-		SLexerContext bm;
+		SLexerBookmark bm;
 		lex_Bookmark(&bm);
 
 		parse_GetToken();
@@ -1178,7 +1178,7 @@ parse_AddrMode(SAddressingMode* addrMode) {
 		lex_Goto(&bm);
 	}
 
-	SLexerContext bm;
+	SLexerBookmark bm;
 	lex_Bookmark(&bm);
 
 	SExpression* expression = parse_Expression(2);
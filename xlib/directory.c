@@ -0,0 +1,230 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ *	Symbol directory entry:
+ *
+ *	uint32_t	DataOffset	; File offset of the module's data
+ *	uint8_t		Flags		; Bit 0 set = always link, the module has rooted sections or could not be indexed
+ *	uint32_t	TotalExports
+ *	REPT	TotalExports
+ *		ASCIIZ	Name
+ *	ENDR
+ *
+ *	The exported names are found by walking the module's XOB sections, see xlink/object.c for the format.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "file.h"
+#include "mem.h"
+
+#include "directory.h"
+
+#define XOB_MAX_VERSION 6
+
+#define XOB_SYM_EXPORT      0
+#define XOB_SYM_IMPORT      1
+#define XOB_SYM_LOCALIMPORT 4
+
+#define XOB_GROUP_TEXT       0
+#define XOB_GROUP_FLAGS_MASK 0x60000000u
+
+typedef struct {
+	const uint8_t* data;
+	uint32_t size;
+	uint32_t index;
+	bool valid;
+} SReader;
+
+typedef struct {
+	bool alwaysLink;
+	uint32_t totalExports;
+	uint32_t allocatedExports;
+	const char** exports;
+} SModuleExports;
+
+static uint8_t
+readByte(SReader* reader) {
+	if (reader->index + 1 > reader->size) {
+		reader->valid = false;
+		return 0;
+	}
+
+	return reader->data[reader->index++];
+}
+
+static uint32_t
+readLong(SReader* reader) {
+	uint32_t value = readByte(reader);
+	value |= (uint32_t) readByte(reader) << 8u;
+	value |= (uint32_t) readByte(reader) << 16u;
+	value |= (uint32_t) readByte(reader) << 24u;
+
+	return value;
+}
+
+static const char*
+readString(SReader* reader) {
+	const char* s = (const char*) &reader->data[reader->index];
+	while (reader->valid && readByte(reader) != 0) {
+	}
+
+	return reader->valid ? s : NULL;
+}
+
+static void
+skipBytes(SReader* reader, uint32_t count) {
+	if (count > reader->size - reader->index) {
+		reader->valid = false;
+		return;
+	}
+
+	reader->index += count;
+}
+
+static void
+addExport(SModuleExports* exports, const char* name) {
+	if (exports->totalExports == exports->allocatedExports) {
+		exports->allocatedExports = exports->allocatedExports * 2 + 16;
+		exports->exports = mem_Realloc(exports->exports, sizeof(const char*) * exports->allocatedExports);
+	}
+
+	exports->exports[exports->totalExports++] = name;
+}
+
+static void
+readSymbols(SReader* reader, SModuleExports* exports, uint8_t version) {
+	uint32_t totalSymbols = readLong(reader);
+
+	for (uint32_t i = 0; i < totalSymbols && reader->valid; ++i) {
+		const char* name = readString(reader);
+		uint32_t type = readLong(reader);
+
+		if (type != XOB_SYM_IMPORT && type != XOB_SYM_LOCALIMPORT)
+			readLong(reader); // Value
+
+		if (version >= 5) {
+			readLong(reader); // File info
+			readLong(reader); // Line number
+		}
+
+		if (type == XOB_SYM_EXPORT && reader->valid)
+			addExport(exports, name);
+	}
+}
+
+static void
+readSection(SReader* reader, SModuleExports* exports, uint8_t version, const bool* textGroups, uint32_t totalGroups) {
+	uint32_t groupId = readLong(reader);
+	readString(reader);
+	readLong(reader); // Bank
+	readLong(reader); // Position
+
+	if (version >= 1)
+		readLong(reader); // Base PC
+	if (version >= 3)
+		readLong(reader); // Byte align
+	if (version >= 4 && readByte(reader) != 0)
+		exports->alwaysLink = true;
+	if (version >= 6)
+		readLong(reader); // Page
+
+	readSymbols(reader, exports, version);
+
+	if (version >= 2) {
+		uint32_t totalLineMappings = readLong(reader);
+		for (uint32_t i = 0; i < totalLineMappings && reader->valid; ++i)
+			skipBytes(reader, 12);
+	}
+
+	uint32_t size = readLong(reader);
+	if (groupId < totalGroups && textGroups[groupId]) {
+		skipBytes(reader, size);
+
+		uint32_t totalPatches = readLong(reader);
+		for (uint32_t i = 0; i < totalPatches && reader->valid; ++i) {
+			readLong(reader); // Offset
+			readLong(reader); // Type
+			skipBytes(reader, readLong(reader));
+		}
+	}
+}
+
+static bool
+readExports(SReader* reader, SModuleExports* exports) {
+	if (reader->size < 4 || memcmp(reader->data, "XOB", 3) != 0)
+		return false;
+
+	uint8_t version = reader->data[3];
+	if (version > XOB_MAX_VERSION)
+		return false;
+
+	reader->index = 4;
+
+	if (version >= 1)
+		readByte(reader); // Minimum word size
+
+	if (version >= 2) {
+		uint32_t totalFiles = readLong(reader);
+		for (uint32_t i = 0; i < totalFiles && reader->valid; ++i) {
+			readString(reader);
+			readLong(reader); // CRC32
+		}
+	}
+
+	uint32_t totalGroups = readLong(reader);
+	if (!reader->valid || totalGroups > reader->size)
+		return false;
+
+	bool* textGroups = mem_Alloc(sizeof(bool) * (totalGroups + 1));
+	for (uint32_t i = 0; i < totalGroups; ++i) {
+		readString(reader);
+		textGroups[i] = (readLong(reader) & ~XOB_GROUP_FLAGS_MASK) == XOB_GROUP_TEXT;
+	}
+
+	uint32_t totalSections = readLong(reader);
+	for (uint32_t i = 0; i < totalSections && reader->valid; ++i)
+		readSection(reader, exports, version, textGroups, totalGroups);
+
+	mem_Free(textGroups);
+
+	return reader->valid;
+}
+
+extern void
+dir_WriteEntry(FILE* fileHandle, const SModule* module, uint32_t dataOffset) {
+	SReader reader = {module->data, module->byteLength, 0, true};
+	SModuleExports exports = {false, 0, 0, NULL};
+
+	//	Modules that can't be indexed, such as ELF objects, are always linked
+	if (!readExports(&reader, &exports)) {
+		exports.alwaysLink = true;
+		exports.totalExports = 0;
+	}
+
+	fputll(dataOffset, fileHandle);
+	fputc(exports.alwaysLink ? DIRECTORY_ALWAYS_LINK : 0, fileHandle);
+	fputll(exports.totalExports, fileHandle);
+	for (uint32_t i = 0; i < exports.totalExports; ++i)
+		fputsz(exports.exports[i], fileHandle);
+
+	mem_Free(exports.exports);
+}
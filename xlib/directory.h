@@ -0,0 +1,33 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XLIB_DIRECTORY_H_INCLUDED_
+#define XLIB_DIRECTORY_H_INCLUDED_
+
+#include <stdio.h>
+
+#include "module.h"
+
+#define DIRECTORY_ALWAYS_LINK 0x01u
+
+//	Writes the symbol directory entry for a module, listing the symbols it exports. dataOffset is the file offset of the
+//	module's data.
+extern void
+dir_WriteEntry(FILE* fileHandle, const SModule* module, uint32_t dataOffset);
+
+#endif
@@ -17,13 +17,18 @@
 */
 
 /*
- *	uint32_t	"XLB\0"
+ *	char	ID[3] = "XLB"
+ *	uint8_t	Version = 1
  *	uint32_t	TotalFiles
+ *	[>=v1] uint32_t	DirectoryOffset
  *	REPT	TotalFiles
  *		ASCIIZ	Name
  *		uint32_t	Size
  *		uint8_t	Data[Size]
  *	ENDR
+ *	[>=v1] REPT	TotalFiles
+ *		DirectoryEntry	; See directory.c
+ *	ENDR
  */
 
 #include <stdio.h>
@@ -36,6 +41,7 @@
 #include "types.h"
 #include "util.h"
 
+#include "directory.h"
 #include "module.h"
 
 extern void
@@ -53,6 +59,21 @@ truncateFileName(char* dest, size_t count, const char* src) {
 	dest[count - 1] = 0;
 }
 
+static SModule*
+readModule(FILE* fileHandle) {
+	SModule* module = (SModule*) mem_Alloc(sizeof(SModule));
+
+	fgetsz(module->name, MAXNAMELENGTH, fileHandle);
+	module->byteLength = fgetll(fileHandle);
+
+	module->data = (uint8_t*) mem_Alloc(module->byteLength);
+	if (module->byteLength != fread(module->data, sizeof(uint8_t), module->byteLength, fileHandle))
+		fatalError("File read failed");
+
+	module->nextModule = NULL;
+	return module;
+}
+
 static SModule*
 readLib0(FILE* fileHandle, size_t size) {
 	if (size) {
@@ -63,23 +84,15 @@ readLib0(FILE* fileHandle, size_t size) {
 		size -= 4; //	Skip count
 
 		while (size > 0) {
+			SModule* module = readModule(fileHandle);
 			if (l == NULL) {
-				first = l = (SModule*) mem_Alloc(sizeof(SModule));
+				first = l = module;
 			} else {
-				l->nextModule = (SModule*) mem_Alloc(sizeof(SModule));
+				l->nextModule = module;
 				l = l->nextModule;
 			}
 
-			size -= fgetsz(l->name, MAXNAMELENGTH, fileHandle);
-			l->byteLength = fgetll(fileHandle);
-			size -= 4;
-
-			l->data = (uint8_t*) mem_Alloc(l->byteLength);
-			if (l->byteLength != fread(l->data, sizeof(uint8_t), l->byteLength, fileHandle))
-				fatalError("File read failed");
-			size -= l->byteLength;
-
-			l->nextModule = NULL;
+			size -= strlen(module->name) + 1 + 4 + module->byteLength;
 		}
 		return first;
 	}
@@ -87,6 +100,22 @@ readLib0(FILE* fileHandle, size_t size) {
 	return NULL;
 }
 
+static SModule*
+readLib1(FILE* fileHandle) {
+	SModule* first = NULL;
+	SModule** next = &first;
+
+	uint32_t count = fgetll(fileHandle);
+	fgetll(fileHandle); //	Skip directory offset, the directory is recreated when writing
+
+	while (count--) {
+		*next = readModule(fileHandle);
+		next = &(*next)->nextModule;
+	}
+
+	return first;
+}
+
 SModule*
 lib_Read(const char* filename) {
 	FILE* fileHandle = fopen(filename, "rb");
@@ -108,6 +137,10 @@ lib_Read(const char* filename) {
 			SModule* result = readLib0(fileHandle, size);
 			fclose(fileHandle);
 			return result;
+		} else if (memcmp(ID, "XLB\1", 4) == 0) {
+			SModule* result = readLib1(fileHandle);
+			fclose(fileHandle);
+			return result;
 		} else {
 			fclose(fileHandle);
 			fatalError("Not a valid xLib library");
@@ -123,20 +156,35 @@ lib_Write(SModule* library, const char* filename) {
 	FILE* fileHandle = fopen(filename, "w+b");
 
 	if (fileHandle != NULL) {
-		fwrite("XLB\0", sizeof(char), 4, fileHandle);
+		fwrite("XLB\1", sizeof(char), 4, fileHandle);
+		fputll(0, fileHandle);
 		fputll(0, fileHandle);
 
 		uint32_t count = 0;
-		while (library != NULL) {
-			fputsz(library->name, fileHandle);
-			fputll(library->byteLength, fileHandle);
-			fwrite(library->data, sizeof(uint8_t), library->byteLength, fileHandle);
-			library = library->nextModule;
+		for (SModule* module = library; module != NULL; module = module->nextModule)
 			++count;
+
+		uint32_t* dataOffsets = (uint32_t*) mem_Alloc(sizeof(uint32_t) * (count + 1));
+
+		uint32_t index = 0;
+		for (SModule* module = library; module != NULL; module = module->nextModule) {
+			fputsz(module->name, fileHandle);
+			fputll(module->byteLength, fileHandle);
+			dataOffsets[index++] = (uint32_t) ftell(fileHandle);
+			fwrite(module->data, sizeof(uint8_t), module->byteLength, fileHandle);
 		}
 
+		uint32_t directoryOffset = (uint32_t) ftell(fileHandle);
+
+		index = 0;
+		for (SModule* module = library; module != NULL; module = module->nextModule)
+			dir_WriteEntry(fileHandle, module, dataOffsets[index++]);
+
+		mem_Free(dataOffsets);
+
 		fseek(fileHandle, 4, SEEK_SET);
 		fputll(count, fileHandle);
+		fputll(directoryOffset, fileHandle);
 
 		fclose(fileHandle);
 		return true;
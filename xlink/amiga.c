@@ -56,7 +56,7 @@ longSize(uint32_t size) {
 }
 
 static void
-writeString(FILE* fileHandle, char* string, uint32_t extFlags) {
+writeString(FILE* fileHandle, const char* string, uint32_t extFlags) {
 	uint32_t stringLength = (uint32_t) strlen(string);
 
 	fputbl(longSize(stringLength) | extFlags, fileHandle);
@@ -93,7 +93,7 @@ writeSectionSizes(FILE* fileHandle) {
 }
 
 static void
-writeStringHunk(FILE* fileHandle, uint32_t hunkType, char* hunkName) {
+writeStringHunk(FILE* fileHandle, uint32_t hunkType, const char* hunkName) {
 	fputbl(hunkType, fileHandle);
 	writeString(fileHandle, hunkName != NULL ? hunkName : "", 0);
 }
@@ -104,7 +104,7 @@ writeHunkUnit(FILE* fileHandle, char* hunkName) {
 }
 
 static void
-writeHunkName(FILE* fileHandle, char* hunkName) {
+writeHunkName(FILE* fileHandle, const char* hunkName) {
 	writeStringHunk(fileHandle, HUNK_NAME, hunkName);
 }
 
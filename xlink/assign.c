@@ -19,23 +19,65 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#include "mem.h"
+
+#include "assign.h"
 #include "group.h"
 #include "object.h"
 #include "section.h"
 #include "xlink.h"
 
+#define PACK_ATTEMPTS 64
+
 typedef bool (*sectionPredicate)(SSection*);
 
+typedef struct {
+	SSection* section;
+	uint32_t index;    // Position in the section list
+	uint32_t pools;    // The number of pools the section can be placed in
+	uint32_t priority; // Raised every time the section could not be placed when packing
+
+	//	The requested placement, restored before packing again
+	int32_t cpuBank;
+	int32_t cpuByteLocation;
+	int32_t cpuLocation;
+	int32_t imageLocation;
+	uint32_t overlay;
+	bool assigned;
+} SPlacement;
+
+static EPlacement g_placement;
+static SPlacement* g_placements;
+static uint32_t g_totalPlacements;
+static SSection* g_unplacedSection;
+
+static void
+allocateSection(SSection* section) {
+	bool allocated;
+	if (g_placement == PLACEMENT_FIRST_FIT)
+		allocated = group_AllocateAligned(section->group->name, section->size, section->cpuBank, section->byteAlign, section->page,
+		                                  &section->cpuByteLocation, &section->cpuBank, &section->imageLocation, &section->overlay);
+	else
+		allocated = group_AllocateBestFit(section->group->name, section->size, section->cpuBank, section->byteAlign, section->page,
+		                                  &section->cpuByteLocation, &section->cpuBank, &section->imageLocation, &section->overlay);
+
+	if (!allocated) {
+		if (g_placement != PLACEMENT_PACK)
+			error("No space for section \"%s\"", section->name);
+
+		g_unplacedSection = section;
+		return;
+	}
+
+	section->cpuLocation = section->cpuByteLocation / section->minimumWordSize;
+	section->assigned = true;
+}
+
 static void
 assignSectionCore(SSection* section, intptr_t data) {
 	sectionPredicate predicate = (sectionPredicate) data;
 	if (predicate(section)) {
-		if (!group_AllocateAligned(section->group->name, section->size, section->cpuBank, section->byteAlign, section->page,
-		                           &section->cpuByteLocation, &section->cpuBank, &section->imageLocation, &section->overlay))
-			error("No space for section \"%s\"", section->name);
-
-		section->cpuLocation = section->cpuByteLocation / section->minimumWordSize;
-		section->assigned = true;
+		allocateSection(section);
 	}
 }
 
@@ -119,12 +161,7 @@ assignSection(SSection* section, intptr_t data) {
 			section->imageLocation = -1;
 			section->assigned = true;
 		} else if (predicate(section)) {
-			if (!group_AllocateAligned(section->group->name, section->size, section->cpuBank, section->byteAlign, section->page,
-			                           &section->cpuByteLocation, &section->cpuBank, &section->imageLocation, &section->overlay))
-				error("No space for section \"%s\"", section->name);
-
-			section->cpuLocation = section->cpuByteLocation / section->minimumWordSize;
-			section->assigned = true;
+			allocateSection(section);
 		}
 	}
 }
@@ -173,22 +210,128 @@ static sectionPredicate sectionPredicates[TOTAL_PREDICATES] = {
     isCodeShared, isCode, isDataShared, isData, isBSSShared, isBSS,
 };
 
-void
-assign_Process(void) {
+static int
+comparePlacements(const void* p1, const void* p2) {
+	const SPlacement* placement1 = (const SPlacement*) p1;
+	const SPlacement* placement2 = (const SPlacement*) p2;
+
+	if (placement1->priority != placement2->priority)
+		return placement1->priority > placement2->priority ? -1 : 1;
+
+	if (placement1->pools != placement2->pools)
+		return placement1->pools < placement2->pools ? -1 : 1;
+
+	if (placement1->section->size != placement2->section->size)
+		return placement1->section->size > placement2->section->size ? -1 : 1;
+
+	return placement1->index < placement2->index ? -1 : 1;
+}
+
+static uint32_t
+totalPools(SSection* section) {
+	if (section->cpuBank != -1)
+		return 1;
+
+	MemoryGroup* group = section->group != NULL ? group_Find(section->group->name) : NULL;
+	return group != NULL ? (uint32_t) group->totalPools : 0;
+}
+
+static void
+collectPlacements(void) {
+	g_placements = (SPlacement*) mem_Alloc(sizeof(SPlacement) * sect_TotalSections());
+	g_totalPlacements = 0;
+
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		if (section->used) {
+			SPlacement* placement = &g_placements[g_totalPlacements];
+
+			placement->section = section;
+			placement->index = g_totalPlacements++;
+			placement->pools = totalPools(section);
+			placement->priority = 0;
+			placement->cpuBank = section->cpuBank;
+			placement->cpuByteLocation = section->cpuByteLocation;
+			placement->cpuLocation = section->cpuLocation;
+			placement->imageLocation = section->imageLocation;
+			placement->overlay = section->overlay;
+			placement->assigned = section->assigned;
+		}
+	}
+}
+
+static void
+restorePlacements(void) {
+	for (uint32_t i = 0; i < g_totalPlacements; ++i) {
+		SPlacement* placement = &g_placements[i];
+		SSection* section = placement->section;
+
+		section->cpuBank = placement->cpuBank;
+		section->cpuByteLocation = placement->cpuByteLocation;
+		section->cpuLocation = placement->cpuLocation;
+		section->imageLocation = placement->imageLocation;
+		section->overlay = placement->overlay;
+		section->assigned = placement->assigned;
+	}
+
+	group_InitMemoryChunks();
+}
+
+static void
+raisePriority(SSection* section) {
+	for (uint32_t i = 0; i < g_totalPlacements; ++i) {
+		if (g_placements[i].section == section)
+			++g_placements[i].priority;
+	}
+}
+
+static void
+forEachPlacement(void (*function)(SSection*, intptr_t), intptr_t data) {
+	for (uint32_t i = 0; i < g_totalPlacements && g_unplacedSection == NULL; ++i)
+		function(g_placements[i].section, data);
+}
+
+static void
+assignSections(void) {
 	for (int i = 0; i < TOTAL_PREDICATES; ++i) {
 		intptr_t pred = (intptr_t) sectionPredicates[i];
 
-		sect_ForEachUsedSection(assignOrgAndBankFixedSection, pred);
-		sect_ForEachUsedSection(assignOrgFixedSection, pred);
-		sect_ForEachUsedSection(assignBankedAlignedPagedSection, pred);
-		sect_ForEachUsedSection(assignBankedAlignedSection, pred);
-		sect_ForEachUsedSection(assignBankedPagedSection, pred);
-		sect_ForEachUsedSection(assignAlignedPagedSection, pred);
-		sect_ForEachUsedSection(assignAlignedSection, pred);
-		sect_ForEachUsedSection(assignPagedSection, pred);
-		sect_ForEachUsedSection(assignSection, pred);
-	}
-	sect_ForEachUsedSection(assignSection, (intptr_t) truePredicate);
+		forEachPlacement(assignOrgAndBankFixedSection, pred);
+		forEachPlacement(assignOrgFixedSection, pred);
+		forEachPlacement(assignBankedAlignedPagedSection, pred);
+		forEachPlacement(assignBankedAlignedSection, pred);
+		forEachPlacement(assignBankedPagedSection, pred);
+		forEachPlacement(assignAlignedPagedSection, pred);
+		forEachPlacement(assignAlignedSection, pred);
+		forEachPlacement(assignPagedSection, pred);
+		forEachPlacement(assignSection, pred);
+	}
+	forEachPlacement(assignSection, (intptr_t) truePredicate);
+}
+
+void
+assign_Process(EPlacement placement) {
+	g_placement = placement;
+	collectPlacements();
+
+	for (uint32_t attempt = 1;; ++attempt) {
+		if (placement != PLACEMENT_FIRST_FIT)
+			qsort(g_placements, g_totalPlacements, sizeof(SPlacement), comparePlacements);
+
+		g_unplacedSection = NULL;
+		assignSections();
+
+		if (g_unplacedSection == NULL)
+			break;
+
+		//	Try again, placing the section that did not fit before the sections it competes with
+		if (attempt == PACK_ATTEMPTS)
+			error("No space for section \"%s\"", g_unplacedSection->name);
+
+		raisePriority(g_unplacedSection);
+		restorePlacements();
+	}
+
+	mem_Free(g_placements);
 
 	sect_SortSections();
 }
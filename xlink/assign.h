@@ -19,7 +19,13 @@
 #ifndef XLINK_ASSIGN_H_INCLUDED_
 #define XLINK_ASSIGN_H_INCLUDED_
 
+typedef enum {
+	PLACEMENT_FIRST_FIT, // Sections are placed in input order, in the first free chunk that fits
+	PLACEMENT_BEST_FIT,  // The largest and most constrained sections are placed first, in the smallest chunk that fits
+	PLACEMENT_PACK       // As best fit, retrying with the sections that did not fit placed earlier
+} EPlacement;
+
 extern void
-assign_Process(void);
+assign_Process(EPlacement placement);
 
 #endif
@@ -119,7 +119,7 @@ commodore_WritePrg(const char* outputFilename, const char* entry, uint32_t heade
 
 	writeHeader(fileHandle, entry, headerAddress);
 
-	image_WriteBinaryToFile(fileHandle, -1);
+	image_WriteBinaryToFile(fileHandle, -1, NULL, 0);
 }
 
 static void
@@ -140,7 +140,7 @@ commodore_WriteMega65Prg(const char* outputFilename, const char* entry) {
 
 	writeMega65Header(fileHandle, entry);
 
-	image_WriteBinaryToFile(fileHandle, -1);
+	image_WriteBinaryToFile(fileHandle, -1, NULL, 0);
 }
 
 extern void
@@ -28,6 +28,7 @@
 
 // from xlink
 #include "elf.h"
+#include "intern.h"
 #include "object.h"
 #include "patch.h"
 #include "section.h"
@@ -670,7 +671,7 @@ addElfSymbolToProgbits(ElfProgBitsSection* symbolSectionProgBits, const ElfSymbo
 	}
 
 	SSymbol* xlinkSymbol = &xlinkSymbolSection->symbols[xlinkSymbolSection->totalSymbols];
-	strncpy(xlinkSymbol->name, elfSymbol->name, MAX_SYMBOL_NAME_LENGTH - 1);
+	xlinkSymbol->name = intern_String(elfSymbol->name);
 	xlinkSymbol->resolved = false;
 	xlinkSymbol->section = xlinkSymbolSection;
 	xlinkSymbol->value = elfSymbol->st_value;
@@ -800,6 +801,7 @@ relocsToXlink(const ElfHeader* elf, const ElfSectionHeader* relocs) {
 		patch->offset = rela->r_offset;
 		patch->expressionSize = exprSize;
 		patch->expression = mem_Alloc(patch->expressionSize);
+		patch->ownsExpression = true;
 		memcpy(patch->expression, g_relocExpr, exprSize);
 		patch->expression[EXPR_SYMBOL_OFFSET + 0] = xlinkSymbolIndex & 0xFF;
 		patch->expression[EXPR_SYMBOL_OFFSET + 1] = (xlinkSymbolIndex >> 8) & 0xFF;
@@ -852,7 +854,7 @@ sectionToXlink(const ElfHeader* elf, const ElfSectionHeader* header, uint32_t se
 	section->byteAlign = header->sh_addralign >= 2 ? (int32_t) header->sh_addralign : -1;
 	section->page = -1;
 	section->root = false;
-	strncpy(section->name, header->name, MAX_SYMBOL_NAME_LENGTH - 1);
+	section->name = intern_String(header->name);
 
 	section->totalSymbols = 0;
 	section->symbols = NULL;
@@ -896,6 +898,14 @@ elfToXlink(const ElfHeader* elf, uint32_t fileId) {
 				relocsToXlink(elf, header);
 		}
 	}
+
+	//	Symbols are added to the sections while converting relocations, compile the patches once all are known
+	for (uint32_t i = 0; i < elf->totalSectionHeaders; ++i) {
+		const ElfSectionHeader* header = &elf->headers[i];
+		if ((header->sh_type == SHT_PROGBITS || header->sh_type == SHT_NOBITS) &&
+		    header->data.progbits->xlinkSection != NULL)
+			patch_Compile(header->data.progbits->xlinkSection);
+	}
 }
 
 void
@@ -22,6 +22,7 @@
 #include <stdlib.h>
 
 #include "error.h"
+#include "parallel.h"
 #include "util.h"
 #include "xlink.h"
 
@@ -33,6 +34,8 @@ error(const char* fmt, ...) {
 
 	va_start(list, fmt);
 
+	parallel_AbandonJob(fmt, list);
+
 	printf("ERROR: ");
 	vprintf(fmt, list);
 	printf("\n");
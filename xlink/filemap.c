@@ -0,0 +1,90 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "file.h"
+#include "mem.h"
+
+#include "filemap.h"
+#include "xlink.h"
+
+static uint8_t*
+readFile(const char* filename, size_t* outSize) {
+	FILE* fileHandle = fopen(filename, "rb");
+	if (fileHandle == NULL)
+		return NULL;
+
+	size_t size = fsize(fileHandle);
+	uint8_t* data = (uint8_t*) mem_Alloc(size + 1);
+	if (data == NULL)
+		error("Out of memory");
+
+	if (size != fread(data, 1, size, fileHandle))
+		error("File read failed");
+
+	fclose(fileHandle);
+
+	*outSize = size;
+	return data;
+}
+
+#if !defined(_WIN32)
+
+//	The mapping is private, pages are only copied when written to, which happens when a section is patched
+static uint8_t*
+mapFile(const char* filename, size_t* outSize) {
+	int fileDescriptor = open(filename, O_RDONLY);
+	if (fileDescriptor == -1)
+		return NULL;
+
+	struct stat status;
+	if (fstat(fileDescriptor, &status) != 0 || status.st_size == 0) {
+		close(fileDescriptor);
+		return NULL;
+	}
+
+	void* data = mmap(NULL, (size_t) status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0);
+	close(fileDescriptor);
+
+	if (data == MAP_FAILED)
+		return NULL;
+
+	*outSize = (size_t) status.st_size;
+	return (uint8_t*) data;
+}
+
+#endif
+
+extern uint8_t*
+fmap_Open(const char* filename, size_t* outSize) {
+#if !defined(_WIN32)
+	uint8_t* data = mapFile(filename, outSize);
+	if (data != NULL)
+		return data;
+#endif
+
+	return readFile(filename, outSize);
+}
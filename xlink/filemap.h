@@ -0,0 +1,30 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XLINK_FILEMAP_H_INCLUDED_
+#define XLINK_FILEMAP_H_INCLUDED_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//	Maps a file into memory for the rest of the link. The memory may be written to, changes are private to the process
+//	and not written back to the file. Returns NULL if the file can't be opened.
+extern uint8_t*
+fmap_Open(const char* filename, size_t* outSize);
+
+#endif
@@ -25,6 +25,7 @@
 
 #include "error.h"
 #include "group.h"
+#include "image.h"
 #include "object.h"
 #include "section.h"
 #include "symbol.h"
@@ -80,45 +81,36 @@ writePGZSections(FILE* fileHandle) {
 	}
 }
 
-static void
-writeRepeatedBytes(FILE* fileHandle, uint32_t offset, int bytes) {
-	fseek(fileHandle, offset, SEEK_SET);
-	ffill(0xFF, bytes, fileHandle);
-}
-
 static void
 writeKUPSections(FILE* fileHandle, int firstSlot, bool pad) {
-	int imageStart = firstSlot * 8192;
-	uint32_t currentFileSize = ftell(fileHandle);
+	int32_t imageStart = firstSlot * F256_SLOT_SIZE;
 
 	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
-		//	This is a special exported EQU symbol section
-		if (sect_IsEquSection(section))
-			continue;
-
-		if (section->used && section->assigned && section->imageLocation != -1 && section->group->type != GROUP_BSS) {
-			if (section->imageLocation < imageStart + F256_HEADER_SIZE) {
-				error("Section \"%s\" overlaps header", section->name);
-			}
-
-			uint32_t startOffset = section->imageLocation - imageStart;
-			uint32_t endOffset = startOffset + section->size;
-
-			if (startOffset > currentFileSize) {
-				fseek(fileHandle, currentFileSize, SEEK_SET);
-				writeRepeatedBytes(fileHandle, currentFileSize, startOffset - currentFileSize);
-			}
-
-			fseek(fileHandle, startOffset, SEEK_SET);
-			fwrite(section->data, 1, section->size, fileHandle);
-			if (endOffset > currentFileSize)
-				currentFileSize = endOffset;
+		if (!sect_IsEquSection(section) && section->used && section->assigned && section->imageLocation != -1 &&
+		    section->group->type != GROUP_BSS && section->imageLocation < imageStart + F256_HEADER_SIZE) {
+			error("Section \"%s\" overlaps header", section->name);
 		}
 	}
 
+	//	Only the main image is written, a kernel user program is a single file
+	if (group_NeedsOverlay())
+		error("Kernel user programs cannot contain overlays");
+
+	SImage* image = image_Create(UINT32_MAX);
+	uint32_t currentFileSize = F256_HEADER_SIZE;
+
+	if (image->size > (uint32_t) imageStart + F256_HEADER_SIZE) {
+		uint32_t size = image->size - (uint32_t) imageStart - F256_HEADER_SIZE;
+		if (size != fwrite(&image->data[imageStart + F256_HEADER_SIZE], 1, size, fileHandle))
+			error("Disk possibly full");
+		currentFileSize += size;
+	}
+
+	image_Free(image);
+
 	if (pad) {
 		int bytesToPad = F256_SLOT_SIZE - currentFileSize % F256_SLOT_SIZE;
-		writeRepeatedBytes(fileHandle, currentFileSize, bytesToPad);
+		ffill(0xFF, bytesToPad, fileHandle);
 	}
 }
 
@@ -16,7 +16,8 @@
     along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include "file.h"
+#include <string.h>
+
 #include "types.h"
 
 #include "gameboy.h"
@@ -36,114 +37,69 @@ static uint8_t g_nintendoChar[48] = {
     0xBB, 0xBB, 0x67, 0x63, 0x6E, 0x0E, 0xEC, 0xCC, 0xDD, 0xDC, 0x99, 0x9F, 0xBB, 0xB9, 0x33, 0x3E,
 };
 
+#define HEADER_END 0x0150L
+
 static void
-updateNintendoCharacterArea(FILE* fileHandle) {
-	fseek(fileHandle, POS_NINTENDO_LOGO, SEEK_SET);
-	fwrite(g_nintendoChar, sizeof(uint8_t), sizeof(g_nintendoChar), fileHandle);
+updateNintendoCharacterArea(SImage* image) {
+	memcpy(&image->data[POS_NINTENDO_LOGO], g_nintendoChar, sizeof(g_nintendoChar));
 }
 
 static void
-updateRomSize(FILE* fileHandle) {
-	fflush(fileHandle);
-	fseek(fileHandle, POS_ROM_SIZE, SEEK_SET);
-
-	int cartRomSize = fgetc(fileHandle);
-	if (cartRomSize == EOF)
-		cartRomSize = 0x00;
-
+updateRomSize(SImage* image) {
 	uint8_t calculatedRomSize = 0;
-	size_t romSize = fsize(fileHandle);
-	while (romSize > (0x8000UL << calculatedRomSize))
+	while (image->size > (0x8000UL << calculatedRomSize))
 		++calculatedRomSize;
 
-	if (calculatedRomSize != cartRomSize) {
-		fseek(fileHandle, POS_ROM_SIZE, SEEK_SET);
-		fwrite(&calculatedRomSize, 1, 1, fileHandle);
-	}
+	image->data[POS_ROM_SIZE] = calculatedRomSize;
 }
 
 static void
-updateCartridgeType(FILE* fileHandle) {
-	fseek(fileHandle, POS_CARTRIDGE_TYPE, SEEK_SET);
-
-	int cartType = fgetc(fileHandle);
-	if (cartType == EOF)
-		cartType = 0x00;
-
-	if (fsize(fileHandle) <= 0x8000UL || cartType != 0x00) {
+updateCartridgeType(SImage* image) {
+	if (image->size <= 0x8000UL || image->data[POS_CARTRIDGE_TYPE] != 0x00) {
 		// cart type byte can be anything
 		return;
 	}
 
-	cartType = 0x01;
-	fseek(fileHandle, POS_CARTRIDGE_TYPE, SEEK_SET);
-	fwrite(&cartType, 1, 1, fileHandle);
+	image->data[POS_CARTRIDGE_TYPE] = 0x01;
 }
 
 static void
-updateChecksum(FILE* fileHandle) {
-	size_t romSize = fsize(fileHandle);
-
-	uint16_t cartChecksum = 0;
+updateChecksum(SImage* image) {
 	uint16_t calculatedChecksum = 0;
-	uint8_t cartCompChecksum = 0;
 	uint8_t calculatedCompChecksum = 0;
 
-	fseek(fileHandle, 0, SEEK_SET);
-
-	for (size_t i = 0; i < romSize; ++i) {
-		int ch = fgetc(fileHandle);
-		if (ch == EOF)
-			ch = 0;
+	for (uint32_t i = 0; i < image->size; ++i) {
+		uint8_t ch = image->data[i];
 
 		if (i < 0x0134L) {
-			calculatedChecksum += (uint16_t) ch;
-		} else if (i < 0x014DL) {
-			calculatedCompChecksum += (uint8_t) ch;
-			calculatedChecksum += (uint16_t) ch;
-		} else if (i == 0x014DL) {
-			cartCompChecksum = (uint8_t) ch;
-		} else if (i == 0x014EL) {
-			cartChecksum = (uint16_t) ch << 8U;
-		} else if (i == 0x014FL) {
-			cartChecksum |= (uint16_t) ch;
-		} else {
-			calculatedChecksum += (uint16_t) ch;
+			calculatedChecksum += ch;
+		} else if (i < POS_COMP_CHECKSUM) {
+			calculatedCompChecksum += ch;
+			calculatedChecksum += ch;
+		} else if (i > POS_CHECKSUM + 1) {
+			calculatedChecksum += ch;
 		}
 	}
 
 	calculatedCompChecksum = (uint8_t) (0xE7U - calculatedCompChecksum);
 	calculatedChecksum += calculatedCompChecksum;
 
-	if (cartChecksum != calculatedChecksum) {
-		fseek(fileHandle, POS_CHECKSUM, SEEK_SET);
-		fputc(calculatedChecksum >> 8U, fileHandle);
-		fputc(calculatedChecksum & 0xFFU, fileHandle);
-	}
-
-	if (cartCompChecksum != calculatedCompChecksum) {
-		fseek(fileHandle, POS_COMP_CHECKSUM, SEEK_SET);
-		fwrite(&calculatedCompChecksum, 1, 1, fileHandle);
-	}
+	image->data[POS_CHECKSUM] = (uint8_t) (calculatedChecksum >> 8U);
+	image->data[POS_CHECKSUM + 1] = (uint8_t) calculatedChecksum;
+	image->data[POS_COMP_CHECKSUM] = calculatedCompChecksum;
 }
 
 static void
-updateGameBoyHeader(FILE* fileHandle) {
-	updateNintendoCharacterArea(fileHandle);
-	updateRomSize(fileHandle);
-	updateCartridgeType(fileHandle);
-	updateChecksum(fileHandle);
+updateGameBoyHeader(SImage* image, intptr_t data) {
+	image_Extend(image, HEADER_END, 0);
+
+	updateNintendoCharacterArea(image);
+	updateRomSize(image);
+	updateCartridgeType(image);
+	updateChecksum(image);
 }
 
 extern void
 gameboy_WriteImage(const char* outputFilename) {
-	image_WriteBinary(outputFilename, 0);
-
-	FILE* fileHandle = fopen(outputFilename, "r+b");
-	if (fileHandle == NULL)
-		error("Unable to open \"%s\" for writing", outputFilename);
-
-	updateGameBoyHeader(fileHandle);
-
-	fclose(fileHandle);
+	image_WriteBinary(outputFilename, 0, updateGameBoyHeader, 0);
 }
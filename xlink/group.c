@@ -93,24 +93,65 @@ group_GetFirstAndLastSection(MemoryGroup* group, SSection** begin, SSection** en
 	return true;
 }
 
-static bool
-pool_AllocateMemory(MemoryPool* pool, uint32_t size, int32_t* cpuByteLocation) {
-	for (MemoryChunk* chunk = pool->freeChunks; chunk != NULL; chunk = chunk->nextChunk) {
-		if (chunk->size >= size) {
-			*cpuByteLocation = chunk->cpuByteLocation;
+static uint32_t
+pool_LowerBound(const MemoryPool* pool, uint32_t size, uint32_t cpuByteLocation) {
+	uint32_t low = 0;
+	uint32_t high = pool->totalChunks;
+
+	while (low < high) {
+		uint32_t middle = (low + high) / 2;
+		const MemoryChunk* chunk = pool->chunksBySize[middle];
+
+		if (chunk->size < size || (chunk->size == size && chunk->cpuByteLocation < cpuByteLocation))
+			low = middle + 1;
+		else
+			high = middle;
+	}
 
-			chunk->cpuByteLocation += size;
-			chunk->size -= size;
+	return low;
+}
 
-			return true;
-		}
+static void
+pool_IndexChunk(MemoryPool* pool, MemoryChunk* chunk) {
+	if (pool->totalChunks == pool->allocatedChunks) {
+		pool->allocatedChunks = pool->allocatedChunks == 0 ? 16 : pool->allocatedChunks * 2;
+		pool->chunksBySize = (MemoryChunk**) mem_Realloc(pool->chunksBySize, sizeof(MemoryChunk*) * pool->allocatedChunks);
 	}
 
-	return false;
+	uint32_t index = pool_LowerBound(pool, chunk->size, chunk->cpuByteLocation);
+	memmove(&pool->chunksBySize[index + 1], &pool->chunksBySize[index], sizeof(MemoryChunk*) * (pool->totalChunks - index));
+
+	pool->chunksBySize[index] = chunk;
+	++pool->totalChunks;
+}
+
+static void
+pool_UnindexChunk(MemoryPool* pool, MemoryChunk* chunk) {
+	uint32_t index = pool_LowerBound(pool, chunk->size, chunk->cpuByteLocation);
+	while (pool->chunksBySize[index] != chunk)
+		++index;
+
+	--pool->totalChunks;
+	memmove(&pool->chunksBySize[index], &pool->chunksBySize[index + 1], sizeof(MemoryChunk*) * (pool->totalChunks - index));
+}
+
+static void
+pool_FreeChunks(MemoryPool* pool) {
+	MemoryChunk* chunk = pool->freeChunks;
+	while (chunk != NULL) {
+		MemoryChunk* next = chunk->nextChunk;
+		mem_Free(chunk);
+		chunk = next;
+	}
+
+	pool->freeChunks = NULL;
+	pool->totalChunks = 0;
 }
 
 static void
-pool_CarveRange(MemoryChunk* chunk, uint32_t size, uint32_t cpuByteLocation) {
+pool_CarveRange(MemoryPool* pool, MemoryChunk* chunk, uint32_t size, uint32_t cpuByteLocation) {
+	pool_UnindexChunk(pool, chunk);
+
 	if (cpuByteLocation == chunk->cpuByteLocation) {
 		chunk->cpuByteLocation += size;
 		chunk->size -= size;
@@ -124,7 +165,11 @@ pool_CarveRange(MemoryChunk* chunk, uint32_t size, uint32_t cpuByteLocation) {
 		newChunk->size = chunk->cpuByteLocation + chunk->size - (cpuByteLocation + size);
 
 		chunk->size = cpuByteLocation - chunk->cpuByteLocation;
+
+		pool_IndexChunk(pool, newChunk);
 	}
+
+	pool_IndexChunk(pool, chunk);
 }
 
 static bool
@@ -132,7 +177,7 @@ pool_AllocateAbsolute(MemoryPool* pool, uint32_t size, uint32_t cpuByteLocation)
 	for (MemoryChunk* chunk = pool->freeChunks; chunk != NULL; chunk = chunk->nextChunk) {
 		if (cpuByteLocation >= chunk->cpuByteLocation && cpuByteLocation + size <= chunk->cpuByteLocation + chunk->size) {
 
-			pool_CarveRange(chunk, size, cpuByteLocation);
+			pool_CarveRange(pool, chunk, size, cpuByteLocation);
 			return true;
 		}
 	}
@@ -141,68 +186,90 @@ pool_AllocateAbsolute(MemoryPool* pool, uint32_t size, uint32_t cpuByteLocation)
 }
 
 static bool
-pool_AllocateAligned(MemoryPool* pool, uint32_t size, uint32_t byteAlign, uint32_t pageSize, int32_t* resultLocation) {
-	if (byteAlign == UINT32_MAX && pageSize == UINT32_MAX) {
-		return pool_AllocateMemory(pool, size, resultLocation);
-	}
-
-	for (MemoryChunk* chunk = pool->freeChunks; chunk != NULL; chunk = chunk->nextChunk) {
-		if (pageSize != UINT32_MAX) {
-			// The requested memory is page aligned and possible byte aligned
-			if (size > pageSize) {
-				return false;
-			}
-
-			uint32_t page = chunk->cpuByteLocation;
-
-			while (page < chunk->cpuByteLocation + chunk->size) {
-				uint32_t remainingChunkSize = chunk->cpuByteLocation + chunk->size - page;
-				uint32_t remainingPageSize = pageSize - page % pageSize;
-				if (remainingPageSize > remainingChunkSize) {
-					remainingPageSize = remainingChunkSize;
-				}
-
-				if (size <= remainingPageSize) {
-					if (byteAlign != UINT32_MAX) {
-						uint32_t cpuByteLocation = page + byteAlign - 1;
-						cpuByteLocation -= cpuByteLocation % byteAlign;
+chunk_FindAligned(const MemoryChunk* chunk, uint32_t size, uint32_t byteAlign, uint32_t pageSize, uint32_t* resultLocation) {
+	if (pageSize != UINT32_MAX) {
+		// The requested memory is page aligned and possible byte aligned
+		if (size > pageSize) {
+			return false;
+		}
 
-						if (cpuByteLocation >= chunk->cpuByteLocation &&
-						    cpuByteLocation + size <= chunk->cpuByteLocation + chunk->size) {
+		uint32_t page = chunk->cpuByteLocation;
 
-							pool_CarveRange(chunk, size, cpuByteLocation);
+		while (page < chunk->cpuByteLocation + chunk->size) {
+			uint32_t remainingChunkSize = chunk->cpuByteLocation + chunk->size - page;
+			uint32_t remainingPageSize = pageSize - page % pageSize;
+			if (remainingPageSize > remainingChunkSize) {
+				remainingPageSize = remainingChunkSize;
+			}
 
-							*resultLocation = cpuByteLocation;
-							return true;
-						}
-					} else {
-						pool_CarveRange(chunk, size, page);
+			if (size <= remainingPageSize) {
+				if (byteAlign != UINT32_MAX) {
+					uint32_t cpuByteLocation = page + byteAlign - 1;
+					cpuByteLocation -= cpuByteLocation % byteAlign;
 
-						*resultLocation = page;
+					if (cpuByteLocation >= chunk->cpuByteLocation &&
+					    cpuByteLocation + size <= chunk->cpuByteLocation + chunk->size) {
+						*resultLocation = cpuByteLocation;
 						return true;
 					}
+				} else {
+					*resultLocation = page;
+					return true;
 				}
-				page += remainingPageSize;
 			}
-
-			return false;
+			page += remainingPageSize;
 		}
 
-		// Requested memory is byte aligned
-		uint32_t cpuByteLocation = chunk->cpuByteLocation + byteAlign - 1;
-		cpuByteLocation -= cpuByteLocation % byteAlign;
-		if (cpuByteLocation >= chunk->cpuByteLocation && cpuByteLocation + size <= chunk->cpuByteLocation + chunk->size) {
+		return false;
+	}
 
-			pool_CarveRange(chunk, size, cpuByteLocation);
+	if (byteAlign == UINT32_MAX) {
+		*resultLocation = chunk->cpuByteLocation;
+		return chunk->size >= size;
+	}
+
+	// Requested memory is byte aligned
+	uint32_t cpuByteLocation = chunk->cpuByteLocation + byteAlign - 1;
+	cpuByteLocation -= cpuByteLocation % byteAlign;
+	if (cpuByteLocation >= chunk->cpuByteLocation && cpuByteLocation + size <= chunk->cpuByteLocation + chunk->size) {
+		*resultLocation = cpuByteLocation;
+		return true;
+	}
+
+	return false;
+}
+
+static bool
+pool_AllocateAligned(MemoryPool* pool, uint32_t size, uint32_t byteAlign, uint32_t pageSize, int32_t* resultLocation) {
+	for (MemoryChunk* chunk = pool->freeChunks; chunk != NULL; chunk = chunk->nextChunk) {
+		uint32_t cpuByteLocation;
+		if (chunk_FindAligned(chunk, size, byteAlign, pageSize, &cpuByteLocation)) {
+			pool_CarveRange(pool, chunk, size, cpuByteLocation);
 
 			*resultLocation = cpuByteLocation;
 			return true;
 		}
+
+		// Paged memory is only allocated from the first free chunk
+		if (pageSize != UINT32_MAX) {
+			return false;
+		}
 	}
 
 	return false;
 }
 
+static MemoryChunk*
+pool_FindBestFit(MemoryPool* pool, uint32_t size, uint32_t byteAlign, uint32_t pageSize, uint32_t* resultLocation) {
+	for (uint32_t i = pool_LowerBound(pool, size, 0); i < pool->totalChunks; ++i) {
+		MemoryChunk* chunk = pool->chunksBySize[i];
+		if (chunk_FindAligned(chunk, size, byteAlign, pageSize, resultLocation))
+			return chunk;
+	}
+
+	return NULL;
+}
+
 static void
 group_InitCommonGameboy(void) {
 	MemoryGroup* group;
@@ -272,16 +339,57 @@ group_AllocateAlignedFromGroup(MemoryGroup* group, uint32_t size, int32_t bankId
 	return false;
 }
 
+static bool
+group_AllocateBestFitFromGroup(MemoryGroup* group, uint32_t size, int32_t bankId, int32_t byteAlign, int32_t pageSize,
+                               int32_t* cpuByteLocation, int32_t* cpuBank, int32_t* imageLocation, uint32_t* overlay) {
+	MemoryPool* bestPool = NULL;
+	MemoryChunk* bestChunk = NULL;
+	uint32_t bestLocation = 0;
+
+	for (int32_t i = 0; i < group->totalPools; ++i) {
+		MemoryPool* pool = group->pools[i];
+
+		if (bankId == -1 || bankId == pool->cpuBank) {
+			uint32_t location;
+			MemoryChunk* chunk = pool_FindBestFit(pool, size, byteAlign, pageSize, &location);
+			if (chunk != NULL && (bestChunk == NULL || chunk->size < bestChunk->size)) {
+				bestPool = pool;
+				bestChunk = chunk;
+				bestLocation = location;
+
+				if (chunk->size == size)
+					break;
+			}
+		}
+	}
+
+	if (bestChunk == NULL)
+		return false;
+
+	pool_CarveRange(bestPool, bestChunk, size, bestLocation);
+
+	*cpuByteLocation = bestLocation;
+	*cpuBank = bestPool->cpuBank;
+	*imageLocation =
+	    bestPool->imageLocation == -1 ? -1 : bestPool->imageLocation + *cpuByteLocation - (int32_t) bestPool->cpuByteLocation;
+	*overlay = bestPool->overlay;
+	return true;
+}
+
 extern void
 group_InitMemoryChunks(void) {
 	for (MemoryGroup* group = s_machineGroups; group != NULL; group = group->nextGroup) {
 		for (int32_t i = 0; i < group->totalPools; ++i) {
 			MemoryPool* pool = group->pools[i];
 
+			pool_FreeChunks(pool);
+
 			if ((pool->freeChunks = (MemoryChunk*) mem_Alloc(sizeof(MemoryChunk))) != NULL) {
 				pool->freeChunks->cpuByteLocation = pool->cpuByteLocation;
 				pool->freeChunks->size = pool->size;
 				pool->freeChunks->nextChunk = NULL;
+
+				pool_IndexChunk(pool, pool->freeChunks);
 			}
 		}
 	}
@@ -360,19 +468,18 @@ pool_Create(int32_t imageLocation, uint32_t overlay, uint32_t cpuByteLocation, i
 	pool->onlyAbs = onlyAbs;
 
 	pool->freeChunks = NULL;
+	pool->chunksBySize = NULL;
+	pool->totalChunks = 0;
+	pool->allocatedChunks = 0;
 
 	return pool;
 }
 
 extern void
 pool_Free(MemoryPool* pool) {
-	MemoryChunk* chunk = pool->freeChunks;
-	while (chunk != NULL) {
-		MemoryChunk* next = chunk->nextChunk;
-		mem_Free(chunk);
-		chunk = next;
-	}
+	pool_FreeChunks(pool);
 
+	mem_Free(pool->chunksBySize);
 	mem_Free(pool);
 }
 
@@ -391,6 +498,14 @@ group_AllocateAligned(const char* groupName, uint32_t size, int32_t bankId, int3
 	                                      overlay);
 }
 
+bool
+group_AllocateBestFit(const char* groupName, uint32_t size, int32_t bankId, int32_t byteAlign, int32_t pageSize,
+                      int32_t* cpuByteLocation, int32_t* cpuBank, int32_t* imageLocation, uint32_t* overlay) {
+	MemoryGroup* group = group_FindByName(groupName);
+	return group_AllocateBestFitFromGroup(group, size, bankId, byteAlign, pageSize, cpuByteLocation, cpuBank, imageLocation,
+	                                      overlay);
+}
+
 void
 group_SetupGameboy(void) {
 	MemoryPool* codepools[256];
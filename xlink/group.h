@@ -36,7 +36,10 @@ typedef struct {
 	uint32_t size;            // Size of pool seen from the CPU
 	bool onlyAbs;             // Only allow absolute placement, never allocate dynamically
 
-	struct MemoryChunk_* freeChunks;
+	struct MemoryChunk_* freeChunks;    // Free chunks ordered by address
+	struct MemoryChunk_** chunksBySize; // Free chunks ordered by size, then address
+	uint32_t totalChunks;
+	uint32_t allocatedChunks;
 } MemoryPool;
 
 typedef struct MemoryGroup_ {
@@ -112,6 +115,11 @@ extern bool
 group_AllocateAligned(const char* groupName, uint32_t size, int32_t bankId, int32_t byteAlign, int32_t pageSize,
                       int32_t* cpuByteLocation, int32_t* cpuBank, int32_t* imageLocation, uint32_t* overlay);
 
+//	Allocates memory like group_AllocateAligned, but places it in the smallest free chunk of the group that can hold it
+extern bool
+group_AllocateBestFit(const char* groupName, uint32_t size, int32_t bankId, int32_t byteAlign, int32_t pageSize,
+                      int32_t* cpuByteLocation, int32_t* cpuBank, int32_t* imageLocation, uint32_t* overlay);
+
 extern bool
 group_NeedsOverlay(void);
 
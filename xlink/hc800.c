@@ -161,36 +161,26 @@ hc800_WriteExecutable(const char* outputFilename, uint8_t* configuration) {
 	fclose(fileHandle);
 }
 
+#define KERNAL_CHECKSUM 7
+
 static void
-updateKernalHeader(FILE* f) {
+updateKernalHeader(SImage* image, intptr_t data) {
+	image_Extend(image, KERNAL_CHECKSUM + 1, 0);
+
 	// Zero checksum byte
-	fseek(f, 7, SEEK_SET);
-	fputc(0, f);
+	image->data[KERNAL_CHECKSUM] = 0;
 
 	// Calculate checksum
-
-	fseek(f, 0, SEEK_SET);
-	int c;
 	int8_t checksum = 0;
-	while ((c = fgetc(f)) != EOF) {
-		checksum += c;
+	for (uint32_t i = 0; i < image->size; ++i) {
+		checksum += image->data[i];
 	}
-	checksum = 0xA5 - checksum;
 
 	// Update checksum in image
-	fseek(f, 7, SEEK_SET);
-	fputc(checksum, f);
+	image->data[KERNAL_CHECKSUM] = (uint8_t) (0xA5 - checksum);
 }
 
 extern void
 hc800_WriteKernal(const char* outputFilename) {
-	image_WriteBinary(outputFilename, 0);
-
-	FILE* fileHandle = fopen(outputFilename, "r+b");
-	if (fileHandle == NULL)
-		error("Unable to open \"%s\" for writing", outputFilename);
-
-	updateKernalHeader(fileHandle);
-
-	fclose(fileHandle);
+	image_WriteBinary(outputFilename, 0, updateKernalHeader, 0);
 }
@@ -24,138 +24,176 @@
 #include <string.h>
 
 // From util
-#include "file.h"
 #include "fmath.h"
 #include "map.h"
 #include "mem.h"
 
 // From xlink
+#include "image.h"
 #include "object.h"
 #include "section.h"
 #include "str.h"
 #include "xlink.h"
 
-#define WRITE_BLOCK_SIZE 16384
+#define INITIAL_IMAGE_SIZE 16384
+
+#define EMPTY_BYTE 0xFF
+
+static bool
+isPlaced(SSection* section) {
+	//	Exported EQU symbols are placed in a special section that has no contents
+	return !sect_IsEquSection(section) && section->used && section->assigned && section->imageLocation != -1 &&
+	       section->group->type != GROUP_BSS;
+}
+
+static SImage*
+createImage(void) {
+	SImage* image = (SImage*) mem_Alloc(sizeof(SImage));
+	image->data = NULL;
+	image->size = 0;
+	image->allocatedSize = 0;
+
+	return image;
+}
 
 static void
-freeVecFileHandle(intptr_t userData, intptr_t v) {
-	fclose((FILE*) v);
+placeSection(SImage* image, const SSection* section) {
+	image_Extend(image, section->imageLocation + section->size, EMPTY_BYTE);
+	if (section->size > 0)
+		memcpy(&image->data[section->imageLocation], section->data, section->size);
 }
 
 static void
-writeRepeatedBytes(FILE* fileHandle, void* data, uint32_t offset, int bytes) {
-	fseek(fileHandle, offset, SEEK_SET);
-	while (bytes > 0) {
-		uint32_t towrite = bytes > WRITE_BLOCK_SIZE ? WRITE_BLOCK_SIZE : bytes;
-		if (towrite != fwrite(data, 1, towrite, fileHandle))
-			error("Disk possibly full");
-		bytes -= towrite;
-	}
+padImage(SImage* image, uint32_t headerSize, int padding) {
+	//	The header written by the caller counts towards the padded size
+	uint32_t fileSize = headerSize + image->size;
+	int bytesToPad = padding == 0 ? (2u << log2n(fileSize)) - fileSize : padding - fileSize % padding;
+
+	image_Extend(image, image->size + bytesToPad, EMPTY_BYTE);
 }
 
-static void*
-allocEmptyBytes(void) {
-	void* data = (char*) mem_Alloc(WRITE_BLOCK_SIZE);
-	if (data == NULL)
-		error("Out of memory");
+static void
+writeImage(FILE* fileHandle, const SImage* image) {
+	if (image->size != fwrite(image->data, 1, image->size, fileHandle))
+		error("Disk possibly full");
+}
 
-	memset(data, 0xFF, WRITE_BLOCK_SIZE);
+static bool
+intKeyEquals(intptr_t userData, intptr_t element1, intptr_t element2) {
+	return element1 == element2;
+}
 
-	return data;
+static uint32_t
+intKeyHash(intptr_t userData, intptr_t element) {
+	return (uint32_t) element;
 }
 
-static FILE*
-getFileHandle(map_t* fileHandles, uint32_t overlay) {
-	intptr_t int_file;
-	if (map_Value(fileHandles, overlay, &int_file)) {
-		return (FILE*) int_file;
-	}
+static void
+intKeyFree(intptr_t userData, intptr_t element) {}
+
+static void
+freeImage(intptr_t userData, intptr_t element) {
+	image_Free((SImage*) element);
+}
 
-	string* name = str_CreateFormat("%s.%d", g_outputFilename, overlay);
-	FILE* new_handle = fopen(str_String(name), "w+b");
+static SImage*
+getOverlayImage(map_t* images, uint32_t overlay) {
+	intptr_t image;
+	if (map_Value(images, overlay, &image))
+		return (SImage*) image;
 
-	map_Insert(fileHandles, overlay, (intptr_t) new_handle);
-	str_Free(name);
+	SImage* newImage = createImage();
+	map_Insert(images, overlay, (intptr_t) newImage);
 
-	return new_handle;
+	return newImage;
 }
 
 static void
-internalWriteBinary(map_t* fileHandles, int padding) {
-	FILE* mainFile = getFileHandle(fileHandles, UINT32_MAX);
-	assert(mainFile != NULL);
+writeOverlayImage(map_t* images, intptr_t overlay, intptr_t image, intptr_t data) {
+	if ((uint32_t) overlay == UINT32_MAX)
+		return;
 
-	uint32_t headerSize = ftell(mainFile);
-	char* emptyBytes = allocEmptyBytes();
+	string* name = str_CreateFormat("%s.%d", g_outputFilename, (uint32_t) overlay);
+	FILE* fileHandle = fopen(str_String(name), "wb");
+	if (fileHandle == NULL)
+		error("Unable to open \"%s\" for writing", str_String(name));
 
-	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
-		//	This is a special exported EQU symbol section
-		if (sect_IsEquSection(section))
-			continue;
-
-		if (section->used && section->assigned && section->imageLocation != -1 && section->group->type != GROUP_BSS) {
-			uint32_t startOffset = section->imageLocation;
+	writeImage(fileHandle, (SImage*) image);
 
-			if (section->overlay == UINT32_MAX) {
-				startOffset += headerSize;
-			}
+	fclose(fileHandle);
+	str_Free(name);
+}
 
-			uint32_t endOffset = startOffset + section->size;
-			FILE* file = getFileHandle(fileHandles, section->overlay);
-			uint32_t currentFileSize = fsize(file);
+extern void
+image_Extend(SImage* image, uint32_t size, uint8_t fill) {
+	if (size <= image->size)
+		return;
 
-			if (startOffset > currentFileSize) {
-				fseek(file, currentFileSize, SEEK_SET);
-				writeRepeatedBytes(file, emptyBytes, currentFileSize, startOffset - currentFileSize);
-			}
+	if (size > image->allocatedSize) {
+		uint32_t allocatedSize = image->allocatedSize > 0 ? image->allocatedSize : INITIAL_IMAGE_SIZE;
+		while (allocatedSize < size)
+			allocatedSize *= 2;
 
-			fseek(file, startOffset, SEEK_SET);
-			fwrite(section->data, 1, section->size, file);
-			if (endOffset > currentFileSize)
-				currentFileSize = endOffset;
+		image->data = (uint8_t*) mem_Realloc(image->data, allocatedSize);
+		if (image->data == NULL)
+			error("Out of memory");
 
-			fflush(file);
-		}
+		image->allocatedSize = allocatedSize;
 	}
 
-	if (padding != -1) {
-		uint32_t mainFileSize = fsize(mainFile);
-		int bytesToPad = padding == 0 ? (2u << log2n(mainFileSize)) - mainFileSize : padding - mainFileSize % padding;
-		writeRepeatedBytes(mainFile, emptyBytes, mainFileSize, bytesToPad);
+	memset(&image->data[image->size], fill, size - image->size);
+	image->size = size;
+}
+
+extern SImage*
+image_Create(uint32_t overlay) {
+	SImage* image = createImage();
+
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		if (isPlaced(section) && section->overlay == overlay)
+			placeSection(image, section);
 	}
 
-	mem_Free(emptyBytes);
+	return image;
 }
 
-static bool
-intKeyEquals(intptr_t userData, intptr_t element1, intptr_t element2) {
-	return element1 == element2;
+extern void
+image_Free(SImage* image) {
+	mem_Free(image->data);
+	mem_Free(image);
 }
 
-static uint32_t
-intKeyHash(intptr_t userData, intptr_t element) {
-	return (uint32_t) element;
-}
+extern void
+image_WriteBinaryToFile(FILE* fileHandle, int padding, void (*fixup)(SImage*, intptr_t), intptr_t data) {
+	uint32_t headerSize = ftell(fileHandle);
 
-static void
-intKeyFree(intptr_t userData, intptr_t element) {}
+	map_t* images = map_Create(intKeyEquals, intKeyHash, intKeyFree, freeImage);
+	SImage* mainImage = getOverlayImage(images, UINT32_MAX);
 
-extern void
-image_WriteBinaryToFile(FILE* fileHandle, int padding) {
-	map_t* fileHandles = map_Create(intKeyEquals, intKeyHash, intKeyFree, freeVecFileHandle);
-	map_Insert(fileHandles, UINT32_MAX, (intptr_t) fileHandle);
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		if (isPlaced(section))
+			placeSection(getOverlayImage(images, section->overlay), section);
+	}
+
+	if (padding != -1)
+		padImage(mainImage, headerSize, padding);
+
+	if (fixup != NULL)
+		fixup(mainImage, data);
 
-	internalWriteBinary(fileHandles, padding);
+	writeImage(fileHandle, mainImage);
+	fclose(fileHandle);
 
-	map_Free(fileHandles);
+	map_ForEachKeyValue(images, writeOverlayImage, 0);
+	map_Free(images);
 }
 
 extern void
-image_WriteBinary(const char* outputFilename, int padding) {
+image_WriteBinary(const char* outputFilename, int padding, void (*fixup)(SImage*, intptr_t), intptr_t data) {
 	FILE* fileHandle = fopen(g_outputFilename, "w+b");
 	if (fileHandle == NULL) {
 		error("Unable to open \"%s\" for writing", g_outputFilename);
 	}
 
-	image_WriteBinaryToFile(fileHandle, padding);
+	image_WriteBinaryToFile(fileHandle, padding, fixup, data);
 }
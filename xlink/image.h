@@ -19,17 +19,39 @@
 #ifndef XLINK_IMAGE_H_INCLUDED_
 #define XLINK_IMAGE_H_INCLUDED_
 
+#include <stdint.h>
 #include <stdio.h>
 
+//	An output file's contents, built in memory
+typedef struct {
+	uint8_t* data;
+	uint32_t size;
+	uint32_t allocatedSize;
+} SImage;
+
 /* padding:
  * -1 - no padding
  *  0 - pad length to power of two
  * >0 - pad length to multiple of argument
+ *
+ * fixup, if not NULL, is called with the main image before it is written, to update headers and checksums. The file
+ * handle is closed when done.
  */
 extern void
-image_WriteBinaryToFile(FILE* fileHandle, int padding);
+image_WriteBinaryToFile(FILE* fileHandle, int padding, void (*fixup)(SImage* image, intptr_t data), intptr_t data);
+
+extern void
+image_WriteBinary(const char* outputFilename, int padding, void (*fixup)(SImage* image, intptr_t data), intptr_t data);
+
+//	Places the sections of an overlay (UINT32_MAX for the main file) in an image, gaps are filled with $FF
+extern SImage*
+image_Create(uint32_t overlay);
+
+extern void
+image_Free(SImage* image);
 
+//	Grows the image to at least size bytes, the new bytes are set to fill
 extern void
-image_WriteBinary(const char* outputFilename, int padding);
+image_Extend(SImage* image, uint32_t size, uint8_t fill);
 
 #endif
@@ -0,0 +1,136 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stddef.h>
+#include <string.h>
+
+#include "mem.h"
+
+#include "intern.h"
+#include "xlink.h"
+
+#define BLOCK_SIZE 65536
+
+typedef struct InternedString {
+	struct InternedString* nextInBucket;
+	uint32_t hash;
+	char data[];
+} SInternedString;
+
+static SInternedString** g_buckets = NULL;
+static uint32_t g_bucketMask = 0;
+static uint32_t g_totalStrings = 0;
+
+//	Strings are allocated from large blocks, they are never freed
+static uint8_t* g_block = NULL;
+static size_t g_blockRemaining = 0;
+
+static uint32_t
+hashString(const char* s, size_t length) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; ++i)
+		hash = (hash ^ (uint8_t) s[i]) * 16777619u;
+
+	return hash;
+}
+
+static void*
+allocate(size_t size) {
+	size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+	if (size > BLOCK_SIZE / 4)
+		return mem_Alloc(size);
+
+	if (size > g_blockRemaining) {
+		g_block = (uint8_t*) mem_Alloc(BLOCK_SIZE);
+		if (g_block == NULL)
+			error("Out of memory");
+		g_blockRemaining = BLOCK_SIZE;
+	}
+
+	void* result = g_block;
+	g_block += size;
+	g_blockRemaining -= size;
+
+	return result;
+}
+
+static void
+growBuckets(void) {
+	uint32_t totalBuckets = g_buckets == NULL ? 1024 : (g_bucketMask + 1) * 2;
+	SInternedString** buckets = (SInternedString**) mem_Alloc(sizeof(SInternedString*) * totalBuckets);
+	if (buckets == NULL)
+		error("Out of memory");
+
+	memset(buckets, 0, sizeof(SInternedString*) * totalBuckets);
+
+	if (g_buckets != NULL) {
+		for (uint32_t i = 0; i <= g_bucketMask; ++i) {
+			SInternedString* interned = g_buckets[i];
+			while (interned != NULL) {
+				SInternedString* next = interned->nextInBucket;
+				SInternedString** bucket = &buckets[interned->hash & (totalBuckets - 1)];
+				interned->nextInBucket = *bucket;
+				*bucket = interned;
+				interned = next;
+			}
+		}
+		mem_Free(g_buckets);
+	}
+
+	g_buckets = buckets;
+	g_bucketMask = totalBuckets - 1;
+}
+
+extern const char*
+intern_StringLength(const char* s, size_t length) {
+	if (g_buckets == NULL || g_totalStrings > g_bucketMask)
+		growBuckets();
+
+	uint32_t hash = hashString(s, length);
+	SInternedString** bucket = &g_buckets[hash & g_bucketMask];
+
+	for (SInternedString* interned = *bucket; interned != NULL; interned = interned->nextInBucket) {
+		if (interned->hash == hash && strncmp(interned->data, s, length) == 0 && interned->data[length] == 0)
+			return interned->data;
+	}
+
+	SInternedString* interned = (SInternedString*) allocate(offsetof(SInternedString, data) + length + 1);
+	if (interned == NULL)
+		error("Out of memory");
+
+	interned->hash = hash;
+	memcpy(interned->data, s, length);
+	interned->data[length] = 0;
+
+	interned->nextInBucket = *bucket;
+	*bucket = interned;
+	++g_totalStrings;
+
+	return interned->data;
+}
+
+extern const char*
+intern_String(const char* s) {
+	return intern_StringLength(s, strlen(s));
+}
+
+extern uint32_t
+intern_Hash(const char* interned) {
+	return ((const SInternedString*) (interned - offsetof(SInternedString, data)))->hash;
+}
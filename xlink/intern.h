@@ -0,0 +1,37 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XLINK_INTERN_H_INCLUDED_
+#define XLINK_INTERN_H_INCLUDED_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//	Returns the single, shared copy of a string. Interned strings live for the rest of the link, and two interned strings
+//	are equal if and only if their pointers are equal.
+extern const char*
+intern_String(const char* s);
+
+extern const char*
+intern_StringLength(const char* s, size_t length);
+
+//	Returns the hash of an interned string, computed when it was interned
+extern uint32_t
+intern_Hash(const char* interned);
+
+#endif
@@ -0,0 +1,621 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * xLink - LINKCACHE.C
+ *
+ *	The link cache records a link, so the next link can keep the section placements and reuse the patched contents of
+ *	the sections not affected by the object files that changed.
+ *
+ *	char		ID[4]="XLC0"
+ *	uint32_t	OptionsChecksum	; Checksum of the command line and machine definition
+ *	uint32_t	NumberOfSections
+ *	REPT	NumberOfSections
+ *			ASCIIZ		Key		; Input file, section name and occurrence of the name in the file
+ *			uint32_t	InputChecksum	; Checksum of the object file or library
+ *			ASCIIZ		Group		; Empty for exported EQU symbols
+ *			int32_t		RequestedBank	; Bank and position as read from the object file
+ *			int32_t		RequestedPosition
+ *			int32_t		ByteAlign
+ *			int32_t		Page
+ *			uint32_t	Size
+ *			int32_t		Bank		; Bank, position, BasePC, image location and overlay as assigned
+ *			int32_t		Position
+ *			int32_t		BasePC
+ *			int32_t		ImageLocation
+ *			uint32_t	Overlay
+ *			uint32_t	ImportsChecksum	; Checksum of the imported symbols used by the patches
+ *			uint8_t		HasContents	; != 0 if the patched contents follow
+ *			IF HasContents
+ *				uint8_t		Data[Size]
+ *				uint32_t	NumberOfRelocations
+ *				REPT	NumberOfRelocations
+ *					uint32_t	Offset
+ *					uint32_t	Section	; Index of the section relocated against, or -1
+ *					uint32_t	Symbol	; Index of the imported symbol in the section, or -1
+ *				ENDR
+ *			ENDC
+ *	ENDR
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// From util
+#include "crc32.h"
+#include "file.h"
+#include "map.h"
+#include "mem.h"
+#include "str.h"
+#include "strcoll.h"
+
+// From xlink
+#include "filemap.h"
+#include "linkcache.h"
+#include "object.h"
+#include "patch.h"
+#include "section.h"
+#include "xlink.h"
+
+#define CACHE_ID "XLC0"
+
+#define NO_INDEX UINT32_MAX
+
+typedef struct {
+	uint32_t offset;
+	uint32_t sectionIndex;
+	uint32_t symbolId;
+} SCachedRelocation;
+
+//	A section as it was linked the previous time
+typedef struct {
+	const char* key;
+	uint32_t inputChecksum;
+	const char* groupName;
+	int32_t requestedBank;
+	int32_t requestedLocation;
+	int32_t byteAlign;
+	int32_t page;
+	uint32_t size;
+	int32_t cpuBank;
+	int32_t cpuByteLocation;
+	int32_t cpuLocation;
+	int32_t imageLocation;
+	uint32_t overlay;
+	uint32_t importsChecksum;
+	bool hasContents;
+	uint8_t* data;
+	uint32_t totalRelocations;
+	SCachedRelocation* relocations;
+	SSection* section; // The section it matches in this link
+} SCachedSection;
+
+//	A section of this link
+typedef struct {
+	string* key;
+	uint32_t keyChecksum;
+	uint32_t inputChecksum;
+	int32_t requestedBank;
+	int32_t requestedLocation;
+	uint32_t importsChecksum;
+	bool cacheable; // The patched contents only depend on the placement and the imported symbols
+	uint32_t writeIndex;
+	SCachedSection* cached;
+} SLinkSection;
+
+typedef struct {
+	uint8_t* data;
+	size_t size;
+	size_t index;
+	bool failed;
+} SCacheReader;
+
+static const char* g_filename = NULL;
+static uint32_t g_optionsChecksum = 0;
+
+static uint32_t g_totalCachedSections = 0;
+static SCachedSection* g_cachedSections = NULL;
+
+//	Maps the sections of this link to their SLinkSection
+static map_t* g_linkSections = NULL;
+
+static uint8_t*
+readBytes(SCacheReader* reader, size_t count) {
+	if (reader->failed || count > reader->size - reader->index) {
+		reader->failed = true;
+		return NULL;
+	}
+
+	uint8_t* data = &reader->data[reader->index];
+	reader->index += count;
+
+	return data;
+}
+
+static uint8_t
+readByte(SCacheReader* reader) {
+	uint8_t* data = readBytes(reader, 1);
+	return data != NULL ? *data : 0;
+}
+
+static uint32_t
+readLong(SCacheReader* reader) {
+	uint8_t* data = readBytes(reader, 4);
+	if (data == NULL)
+		return 0;
+
+	return (uint32_t) data[0] | (uint32_t) data[1] << 8u | (uint32_t) data[2] << 16u | (uint32_t) data[3] << 24u;
+}
+
+static const char*
+readString(SCacheReader* reader) {
+	if (reader->failed)
+		return "";
+
+	const char* s = (const char*) &reader->data[reader->index];
+	const uint8_t* end = memchr(s, 0, reader->size - reader->index);
+	if (end == NULL) {
+		reader->failed = true;
+		return "";
+	}
+
+	reader->index += (size_t) (end - (const uint8_t*) s) + 1;
+	return s;
+}
+
+static void
+readRelocations(SCacheReader* reader, SCachedSection* cached) {
+	uint32_t totalRelocations = readLong(reader);
+	if (totalRelocations > (reader->size - reader->index) / (3 * sizeof(uint32_t))) {
+		reader->failed = true;
+		return;
+	}
+
+	cached->totalRelocations = totalRelocations;
+	cached->relocations = mem_Alloc(sizeof(SCachedRelocation) * totalRelocations);
+
+	for (uint32_t i = 0; i < totalRelocations; ++i) {
+		SCachedRelocation* relocation = &cached->relocations[i];
+		relocation->offset = readLong(reader);
+		relocation->sectionIndex = readLong(reader);
+		relocation->symbolId = readLong(reader);
+	}
+}
+
+static void
+readCachedSection(SCacheReader* reader, SCachedSection* cached) {
+	cached->key = readString(reader);
+	cached->inputChecksum = readLong(reader);
+	cached->groupName = readString(reader);
+	cached->requestedBank = (int32_t) readLong(reader);
+	cached->requestedLocation = (int32_t) readLong(reader);
+	cached->byteAlign = (int32_t) readLong(reader);
+	cached->page = (int32_t) readLong(reader);
+	cached->size = readLong(reader);
+	cached->cpuBank = (int32_t) readLong(reader);
+	cached->cpuByteLocation = (int32_t) readLong(reader);
+	cached->cpuLocation = (int32_t) readLong(reader);
+	cached->imageLocation = (int32_t) readLong(reader);
+	cached->overlay = readLong(reader);
+	cached->importsChecksum = readLong(reader);
+	cached->hasContents = readByte(reader) != 0;
+	cached->data = NULL;
+	cached->totalRelocations = 0;
+	cached->relocations = NULL;
+	cached->section = NULL;
+
+	if (cached->hasContents) {
+		cached->data = readBytes(reader, cached->size);
+		readRelocations(reader, cached);
+	}
+}
+
+static bool
+readCache(void) {
+	SCacheReader reader;
+	reader.data = fmap_Open(g_filename, &reader.size);
+	reader.index = 0;
+	reader.failed = false;
+
+	if (reader.data == NULL)
+		return false;
+
+	uint8_t* id = readBytes(&reader, 4);
+	if (id == NULL || memcmp(id, CACHE_ID, 4) != 0 || readLong(&reader) != g_optionsChecksum)
+		return false;
+
+	uint32_t totalSections = readLong(&reader);
+	if (totalSections > reader.size - reader.index)
+		return false;
+
+	g_cachedSections = mem_Alloc(sizeof(SCachedSection) * totalSections);
+	for (uint32_t i = 0; i < totalSections && !reader.failed; ++i)
+		readCachedSection(&reader, &g_cachedSections[i]);
+
+	if (reader.failed)
+		return false;
+
+	g_totalCachedSections = totalSections;
+	return true;
+}
+
+static bool
+pointerEquals(intptr_t userData, intptr_t element1, intptr_t element2) {
+	return element1 == element2;
+}
+
+static uint32_t
+pointerHash(intptr_t userData, intptr_t element) {
+	return (uint32_t) ((uintptr_t) element >> 4u) * 2654435761u;
+}
+
+static void
+freeNothing(intptr_t userData, intptr_t element) {}
+
+static void
+freeOccurrence(intptr_t userData, intptr_t element) {
+	mem_Free((uint32_t*) element);
+}
+
+static SLinkSection*
+getLinkSection(SSection* section) {
+	intptr_t link;
+	return map_Value(g_linkSections, (intptr_t) section, &link) ? (SLinkSection*) link : NULL;
+}
+
+//	Sections are identified by the file they were read from, their name, and how many sections with the same name were
+//	read from the file before them
+static string*
+createSectionKey(SSection* section, strmap_t* occurrences) {
+	const char* inputName = obj_GetInputFileName(section->fileId);
+	string* name = str_CreateFormat("%s\t%s", inputName != NULL ? inputName : "", section->name);
+
+	uint32_t* occurrence;
+	if (strmap_Value(occurrences, name, (intptr_t*) &occurrence)) {
+		*occurrence += 1;
+	} else {
+		occurrence = mem_Alloc(sizeof(uint32_t));
+		*occurrence = 0;
+		strmap_Insert(occurrences, str_Create(str_String(name)), (intptr_t) occurrence);
+	}
+
+	string* key = str_CreateFormat("%s\t%u", str_String(name), *occurrence);
+	str_Free(name);
+
+	return key;
+}
+
+static void
+createLinkSections(void) {
+	g_linkSections = map_Create(pointerEquals, pointerHash, freeNothing, freeNothing);
+	strmap_t* occurrences = strmap_Create(freeOccurrence);
+
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		SLinkSection* link = mem_Alloc(sizeof(SLinkSection));
+		link->key = createSectionKey(section, occurrences);
+		link->keyChecksum = crc32((const uint8_t*) str_String(link->key), str_Length(link->key));
+		link->inputChecksum = obj_GetInputFileChecksum(section->fileId);
+		link->requestedBank = section->cpuBank;
+		link->requestedLocation = section->cpuByteLocation;
+		link->importsChecksum = 0;
+		link->cacheable = false;
+		link->writeIndex = NO_INDEX;
+		link->cached = NULL;
+
+		map_Insert(g_linkSections, (intptr_t) section, (intptr_t) link);
+	}
+
+	strmap_Free(occurrences);
+}
+
+static void
+matchSections(void) {
+	strmap_t* cachedSections = strmap_Create(freeNothing);
+	for (uint32_t i = 0; i < g_totalCachedSections; ++i)
+		strmap_Insert(cachedSections, str_Create(g_cachedSections[i].key), (intptr_t) &g_cachedSections[i]);
+
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		SLinkSection* link = getLinkSection(section);
+		SCachedSection* cached;
+
+		if (section->used && strmap_Value(cachedSections, link->key, (intptr_t*) &cached)) {
+			link->cached = cached;
+			cached->section = section;
+		}
+	}
+
+	strmap_Free(cachedSections);
+}
+
+static bool
+fitsPreviousPlacement(SSection* section) {
+	if (!section->used || sect_IsEquSection(section))
+		return true;
+
+	SLinkSection* link = getLinkSection(section);
+	SCachedSection* cached = link->cached;
+
+	return cached != NULL && cached->cpuByteLocation != -1 && strcmp(cached->groupName, section->group->name) == 0 &&
+	       cached->requestedBank == link->requestedBank && cached->requestedLocation == link->requestedLocation &&
+	       cached->byteAlign == section->byteAlign && cached->page == section->page && section->size <= cached->size;
+}
+
+//	Sections are only placed where they were previously when all of them fit, a section that could not be placed there
+//	might have to go where one of the others was
+static void
+placeAsCached(void) {
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		if (!fitsPreviousPlacement(section))
+			return;
+	}
+
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		if (section->used && !sect_IsEquSection(section)) {
+			SCachedSection* cached = getLinkSection(section)->cached;
+			section->cpuBank = cached->cpuBank;
+			section->cpuByteLocation = cached->cpuByteLocation;
+			section->cpuLocation = cached->cpuLocation;
+		}
+	}
+}
+
+static bool
+isPlacedAsCached(SSection* section, SCachedSection* cached) {
+	return section->size == cached->size && section->cpuBank == cached->cpuBank &&
+	       section->cpuByteLocation == cached->cpuByteLocation && section->cpuLocation == cached->cpuLocation &&
+	       section->imageLocation == cached->imageLocation && section->overlay == cached->overlay;
+}
+
+static uint32_t
+sectionKeyChecksum(SSection* section) {
+	SLinkSection* link = section != NULL ? getLinkSection(section) : NULL;
+	return link != NULL ? link->keyChecksum : 0;
+}
+
+//	Calculates the checksum of the imported symbols used by the section's patches. Returns false if the patched contents
+//	depend on more than the section's placement and the imported symbols.
+static bool
+calculateImportsChecksum(SSection* section, uint32_t* outChecksum) {
+	uint32_t totalValues = 0;
+	uint32_t allocatedValues = 0;
+	uint32_t* values = NULL;
+
+	SPatches* patches = section->patches;
+	for (uint32_t i = 0; patches != NULL && i < patches->totalPatches; ++i) {
+		SPatch* patch = &patches->patches[i];
+		for (uint32_t j = 0; j < patch->totalInstructions; ++j) {
+			SPatchInstruction* instruction = &patch->instructions[j];
+			if (instruction->operator== OBJ_GROUP_PROPERTY) {
+				mem_Free(values);
+				return false;
+			}
+
+			SSymbol* symbol = instruction->symbol;
+			if (symbol != NULL && sym_IsImport(symbol)) {
+				sect_ResolveSymbol(section, symbol, true);
+
+				if (totalValues + 3 > allocatedValues) {
+					allocatedValues = allocatedValues * 2 + 3;
+					values = mem_Realloc(values, sizeof(uint32_t) * allocatedValues);
+				}
+
+				if (symbol->resolved) {
+					values[totalValues++] = (uint32_t) symbol->value;
+					values[totalValues++] = symbol->section != NULL ? (uint32_t) symbol->section->cpuBank : 0;
+					values[totalValues++] = sectionKeyChecksum(symbol->section);
+				} else {
+					values[totalValues++] = 0;
+					values[totalValues++] = 0;
+					values[totalValues++] = crc32((const uint8_t*) symbol->name, strlen(symbol->name));
+				}
+			}
+		}
+	}
+
+	*outChecksum = crc32((const uint8_t*) values, sizeof(uint32_t) * totalValues);
+	mem_Free(values);
+
+	return true;
+}
+
+static bool
+findRelocationTargets(SCachedSection* cached) {
+	for (uint32_t i = 0; i < cached->totalRelocations; ++i) {
+		SCachedRelocation* relocation = &cached->relocations[i];
+		if (relocation->sectionIndex != NO_INDEX &&
+		    (relocation->sectionIndex >= g_totalCachedSections || g_cachedSections[relocation->sectionIndex].section == NULL))
+			return false;
+	}
+
+	return true;
+}
+
+static void
+useCachedContents(SSection* section, SCachedSection* cached) {
+	SPatches* patches = patch_Alloc(cached->totalRelocations);
+
+	for (uint32_t i = 0; i < cached->totalRelocations; ++i) {
+		SCachedRelocation* relocation = &cached->relocations[i];
+		SPatch* patch = &patches->patches[i];
+
+		memset(patch, 0, sizeof(SPatch));
+		patch->type = PATCH_RELOC;
+		patch->offset = relocation->offset;
+		patch->shape = PATCH_SHAPE_GENERAL;
+
+		if (relocation->sectionIndex != NO_INDEX)
+			patch->valueSection = g_cachedSections[relocation->sectionIndex].section;
+		if (relocation->symbolId != NO_INDEX && relocation->symbolId < section->totalSymbols)
+			patch->valueSymbol = &section->symbols[relocation->symbolId];
+	}
+
+	section->data = cached->data;
+	section->patches = patches;
+}
+
+static void
+reuseSection(SSection* section, intptr_t data) {
+	if (sect_IsEquSection(section) || section->group->type != GROUP_TEXT)
+		return;
+
+	SLinkSection* link = getLinkSection(section);
+	link->cacheable = calculateImportsChecksum(section, &link->importsChecksum);
+
+	SCachedSection* cached = link->cached;
+	if (link->cacheable && cached != NULL && cached->hasContents && cached->inputChecksum == link->inputChecksum &&
+	    cached->importsChecksum == link->importsChecksum && isPlacedAsCached(section, cached) &&
+	    findRelocationTargets(cached)) {
+		useCachedContents(section, cached);
+
+		if (data != 0)
+			printf("Section \"%s\" reused from cache\n", section->name);
+	}
+}
+
+static void
+writeRelocations(FILE* fileHandle, SSection* section, bool allowReloc) {
+	uint32_t totalRelocations = 0;
+	SPatches* patches = section->patches;
+
+	for (uint32_t i = 0; allowReloc && patches != NULL && i < patches->totalPatches; ++i) {
+		SPatch* patch = &patches->patches[i];
+		if (patch->type == PATCH_RELOC && (patch->valueSection != NULL || patch->valueSymbol != NULL))
+			++totalRelocations;
+	}
+
+	fputll(totalRelocations, fileHandle);
+
+	for (uint32_t i = 0; totalRelocations > 0 && i < patches->totalPatches; ++i) {
+		SPatch* patch = &patches->patches[i];
+		if (patch->type == PATCH_RELOC && (patch->valueSection != NULL || patch->valueSymbol != NULL)) {
+			fputll(patch->offset, fileHandle);
+			fputll(patch->valueSection != NULL ? getLinkSection(patch->valueSection)->writeIndex : NO_INDEX, fileHandle);
+			fputll(patch->valueSymbol != NULL ? (uint32_t) (patch->valueSymbol - section->symbols) : NO_INDEX, fileHandle);
+		}
+	}
+}
+
+//	Relocations can only be recorded when they refer to sections in the cache, and the section's own symbols
+static bool
+canWriteRelocations(SSection* section) {
+	SPatches* patches = section->patches;
+
+	for (uint32_t i = 0; patches != NULL && i < patches->totalPatches; ++i) {
+		SPatch* patch = &patches->patches[i];
+		if (patch->type != PATCH_RELOC)
+			continue;
+
+		if (patch->valueSection != NULL && getLinkSection(patch->valueSection)->writeIndex == NO_INDEX)
+			return false;
+
+		if (patch->valueSymbol != NULL &&
+		    (patch->valueSymbol < section->symbols || patch->valueSymbol >= section->symbols + section->totalSymbols))
+			return false;
+	}
+
+	return true;
+}
+
+static void
+writeSection(FILE* fileHandle, SSection* section, bool allowReloc) {
+	SLinkSection* link = getLinkSection(section);
+
+	fputsz(str_String(link->key), fileHandle);
+	fputll(link->inputChecksum, fileHandle);
+	fputsz(section->group != NULL ? section->group->name : "", fileHandle);
+	fputll(link->requestedBank, fileHandle);
+	fputll(link->requestedLocation, fileHandle);
+	fputll(section->byteAlign, fileHandle);
+	fputll(section->page, fileHandle);
+	fputll(section->size, fileHandle);
+	fputll(section->cpuBank, fileHandle);
+	fputll(section->cpuByteLocation, fileHandle);
+	fputll(section->cpuLocation, fileHandle);
+	fputll(section->imageLocation, fileHandle);
+	fputll(section->overlay, fileHandle);
+	fputll(link->importsChecksum, fileHandle);
+
+	bool hasContents = link->cacheable && section->data != NULL && canWriteRelocations(section);
+	fputc(hasContents, fileHandle);
+
+	if (hasContents) {
+		if (section->size != fwrite(section->data, 1, section->size, fileHandle))
+			error("Disk possibly full");
+
+		writeRelocations(fileHandle, section, allowReloc);
+	}
+}
+
+/* Exported functions */
+
+extern void
+cache_Read(const char* filename, uint32_t optionsChecksum, bool keepPlacements) {
+	g_filename = filename;
+	g_optionsChecksum = optionsChecksum;
+
+	createLinkSections();
+
+	if (readCache()) {
+		matchSections();
+		if (keepPlacements)
+			placeAsCached();
+	}
+}
+
+extern void
+cache_ReuseSections(bool verbose) {
+	sect_ForEachUsedSection(reuseSection, verbose);
+}
+
+extern void
+cache_Write(bool allowReloc) {
+	uint32_t totalSections = 0;
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		SLinkSection* link = getLinkSection(section);
+		if (section->used && link != NULL)
+			link->writeIndex = totalSections++;
+	}
+
+	//	Section contents may be read from the mapping of the existing cache, which is replaced once written
+	string* tempFilename = str_CreateFormat("%s.tmp", g_filename);
+	FILE* fileHandle = fopen(str_String(tempFilename), "wb");
+	if (fileHandle == NULL)
+		error("Unable to open \"%s\" for writing", str_String(tempFilename));
+
+	fwrite(CACHE_ID, 1, 4, fileHandle);
+	fputll(g_optionsChecksum, fileHandle);
+	fputll(totalSections, fileHandle);
+
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		SLinkSection* link = getLinkSection(section);
+		if (section->used && link != NULL)
+			writeSection(fileHandle, section, allowReloc);
+	}
+
+	fclose(fileHandle);
+
+#if defined(_WIN32)
+	remove(g_filename);
+#endif
+	if (rename(str_String(tempFilename), g_filename) != 0)
+		error("Unable to write \"%s\"", g_filename);
+
+	str_Free(tempFilename);
+}
@@ -0,0 +1,40 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XLINK_LINKCACHE_H_INCLUDED_
+#define XLINK_LINKCACHE_H_INCLUDED_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//	Reads the link cache, if it exists and was written by a link with the same options, and matches its sections with
+//	the sections to link. Must be called once the sections to link are known, and before they are assigned. When
+//	keepPlacements is true and all sections still fit where they were placed previously, they are placed there again.
+extern void
+cache_Read(const char* filename, uint32_t optionsChecksum, bool keepPlacements);
+
+//	Gives the sections whose patched contents are known from the cache those contents, printing their names if verbose
+//	is true. Must be called after the sections have been assigned, and before they are patched.
+extern void
+cache_ReuseSections(bool verbose);
+
+//	Writes the link cache. Must be called after the sections have been patched.
+extern void
+cache_Write(bool allowReloc);
+
+#endif
@@ -29,6 +29,7 @@
 
 #include "error.h"
 #include "group.h"
+#include "intern.h"
 #include "patch.h"
 #include "section.h"
 #include "xlink.h"
@@ -396,8 +397,7 @@ parseSymbolDirective(const char** line) {
 	g_linkerSymbols->symbols = mem_Realloc(g_linkerSymbols->symbols, sizeof(SSymbol) * (g_linkerSymbols->totalSymbols + 1));
 	SSymbol* symbol = &g_linkerSymbols->symbols[g_linkerSymbols->totalSymbols++];
 
-	strncpy(symbol->name, token, token_length);
-	symbol->name[token_length] = 0;
+	symbol->name = intern_StringLength(token, token_length);
 	symbol->type = SYM_LINKER;
 	symbol->value = 0;
 	symbol->resolved = false;
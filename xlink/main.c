@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "crc32.h"
 #include "str.h"
 
 #include "amiga.h"
@@ -32,7 +33,9 @@
 #include "gameboy.h"
 #include "group.h"
 #include "hc800.h"
+#include "filemap.h"
 #include "image.h"
+#include "linkcache.h"
 #include "listfile.h"
 #include "machinedefinition.h"
 #include "mapfile.h"
@@ -65,7 +68,11 @@ static const char* g_smartlink = NULL;
 static const char* g_entry = NULL;
 static const char* g_mapFilename = NULL;
 static const char* g_listFilename = NULL;
+static const char* g_cacheFilename = NULL;
 static bool g_targetDefined = false;
+static bool g_verbose = false;
+static uint32_t g_totalThreads = 1;
+static EPlacement g_placement = PLACEMENT_FIRST_FIT;
 
 const char* g_outputFilename = NULL;
 
@@ -147,14 +154,25 @@ printUsage(void) {
 	       "          -fcocobin   TRS-80 Color Computer .bin\n"
 	       "          -fmega65    MEGA65 .PRG\n"
 	       "\n"
+	       "    -i<cache>    Link incrementally, recording the link in <cache>\n"
+	       "\n"
+	       "    -j<threads>  Patch sections using <threads> threads\n"
+	       "\n"
 	       "    -l<listfile> Write a listfile to <listfile>\n"
 	       "\n"
 	       "    -m<mapfile>  Write a mapfile to <mapfile>\n"
 	       "\n"
 	       "    -o<output>   Write output to file <output>\n"
 	       "\n"
+	       "    -p<mode>     Section placement\n"
+	       "          -pfirst     Place sections in order, in the first free space (default)\n"
+	       "          -pbest      Place the largest sections first, in the smallest free space\n"
+	       "          -ppack      As -pbest, retrying with the sections that did not fit first\n"
+	       "\n"
 	       "    -s<symbol>   Strip unused sections, rooting the section containing <symbol>\n"
-	       "                 <symbol> is used as entry point when support by output format\n");
+	       "                 <symbol> is used as entry point when support by output format\n"
+	       "\n"
+	       "    -v           Verbose text output\n");
 	exit(EXIT_SUCCESS);
 }
 
@@ -193,6 +211,19 @@ handleFileFormatOption(const string* target) {
 	}
 }
 
+static void
+handlePlacementOption(const string* placement) {
+	if (str_EqualConst(placement, "first")) {
+		g_placement = PLACEMENT_FIRST_FIT;
+	} else if (str_EqualConst(placement, "best")) {
+		g_placement = PLACEMENT_BEST_FIT;
+	} else if (str_EqualConst(placement, "pack")) {
+		g_placement = PLACEMENT_PACK;
+	} else {
+		error("Unknown placement \"%s\"", str_String(placement));
+	}
+}
+
 static void
 handleLegacyTargetOption(const string* target) {
 	if (str_EqualConst(target, "a")) { /* Amiga executable */
@@ -431,7 +462,7 @@ writeOutput(void) {
 			gameboy_WriteImage(g_outputFilename);
 			break;
 		case FILE_FORMAT_BINARY:
-			image_WriteBinary(g_outputFilename, g_binaryPad);
+			image_WriteBinary(g_outputFilename, g_binaryPad, NULL, 0);
 			break;
 		case FILE_FORMAT_CBM_PRG:
 			commodore_WritePrg(g_outputFilename, g_entry, g_cbmHeaderAddress);
@@ -514,6 +545,21 @@ handleOption(const char* option) {
 			}
 			return true;
 		}
+		case 'i': /* Link cache */
+			if (option[1] == 0)
+				error("option \"i\" needs an argument");
+
+			g_cacheFilename = &option[1];
+			return true;
+		case 'j': /* Threads */
+			if (option[1] == 0)
+				error("option \"j\" needs an argument");
+
+			g_totalThreads = (uint32_t) atoi(&option[1]);
+			if (g_totalThreads == 0)
+				error("option \"j\" needs a positive number of threads");
+
+			return true;
 		case 'l': /* Map file */
 			if (option[1] == 0)
 				error("option \"l\" needs an argument");
@@ -532,6 +578,15 @@ handleOption(const char* option) {
 
 			g_outputFilename = &option[1];
 			return true;
+		case 'p': { /* Placement */
+			{
+				string* placement = str_Create(&option[1]);
+				str_ToLowerReplace(&placement);
+				handlePlacementOption(placement);
+				str_Free(placement);
+			}
+			return true;
+		}
 		case 's': /* Smart linking */
 			if (option[1] == 0)
 				error("option \"s\" needs an argument");
@@ -556,12 +611,52 @@ handleOption(const char* option) {
 			}
 			return true;
 		}
+		case 'v': /* Verbose */
+			if (option[1] != 0)
+				return false;
+
+			g_verbose = true;
+			return true;
 		default:
 			break;
 	}
 	return false;
 }
 
+//	Calculates a checksum of the arguments that affect the linked sections, and the contents of the machine definition file
+static uint32_t
+argumentsChecksum(int argc, char* argv[]) {
+	string* arguments = str_Create("");
+
+	for (int argn = 1; argn < argc; ++argn) {
+		const char* argument = argv[argn];
+		bool isOption = argument[0] == '-' || argument[0] == '/';
+		char option = isOption ? (char) tolower(argument[1]) : 0;
+
+		if (option == 'i' || option == 'j' || option == 'l' || option == 'm' || option == 'o' || option == 'v')
+			continue;
+
+		string* checksum = NULL;
+		if (option == 'a') {
+			size_t size;
+			uint8_t* data = fmap_Open(&argument[2], &size);
+			checksum = str_CreateFormat("%s\t%08X\n", argument, data != NULL ? crc32(data, size) : 0);
+		} else {
+			checksum = str_CreateFormat("%s\n", argument);
+		}
+
+		string* all = str_Concat(arguments, checksum);
+		str_Free(arguments);
+		str_Free(checksum);
+		arguments = all;
+	}
+
+	uint32_t checksum = crc32((const uint8_t*) str_String(arguments), str_Length(arguments));
+	str_Free(arguments);
+
+	return checksum;
+}
+
 int
 main(int argc, char* argv[]) {
 	int argn = 1;
@@ -598,20 +693,29 @@ main(int argc, char* argv[]) {
 		obj_Read(argv[argn++]);
 	}
 
+	obj_ReadRequiredLibraryModules(g_smartlink);
+
 	smart_Process(g_smartlink);
+	sect_CheckDuplicateExports();
+
+	if (g_cacheFilename != NULL)
+		cache_Read(g_cacheFilename, argumentsChecksum(argc, argv), !format_SupportsReloc(g_outputFormat));
 
 	if (group_NeedsOverlay() && !format_SupportsOverlay(g_outputFormat)) {
 		error("Output format does not support overlay files");
 	}
 
 	if (!format_SupportsReloc(g_outputFormat)) {
-		assign_Process();
+		assign_Process(g_placement);
 		sect_SortSections();
 		sect_ResolveUnresolved();
 	}
 
+	if (g_cacheFilename != NULL)
+		cache_ReuseSections(g_verbose);
+
 	patch_Process(format_SupportsReloc(g_outputFormat), format_SupportsOnlySectionRelativeReloc(g_outputFormat),
-	              format_SupportsImports(g_outputFormat));
+	              format_SupportsImports(g_outputFormat), g_totalThreads);
 
 	if (g_outputFilename != NULL) {
 		writeOutput();
@@ -621,6 +725,8 @@ main(int argc, char* argv[]) {
 		map_Write(g_mapFilename);
 	if (g_listFilename != NULL)
 		list_Write(g_listFilename);
+	if (g_cacheFilename != NULL)
+		cache_Write(format_SupportsReloc(g_outputFormat));
 
 	return EXIT_SUCCESS;
 }
@@ -17,7 +17,7 @@
 */
 
 #include "file.h"
-
+#include "mem.h"
 #include "str.h"
 
 #include "mapfile.h"
@@ -33,8 +33,8 @@ static uint32_t symbol_value_field_size;
 
 static int
 compareSymbols(const void* element1, const void* element2) {
-	const SSymbol* symbol1 = (const SSymbol*) element1;
-	const SSymbol* symbol2 = (const SSymbol*) element2;
+	const SSymbol* symbol1 = *(const SSymbol**) element1;
+	const SSymbol* symbol2 = *(const SSymbol**) element2;
 
 	bool symbol1Import = sym_IsImport(symbol1);
 	bool symbol2Import = sym_IsImport(symbol2);
@@ -45,19 +45,28 @@ compareSymbols(const void* element1, const void* element2) {
 	return symbol1->value - symbol2->value;
 }
 
-static void
-sortSymbols(SSymbol* symbolArray, uint32_t totalSymbols) {
-	qsort(symbolArray, totalSymbols, sizeof(SSymbol), compareSymbols);
+//	Sort pointers rather than the symbols themselves, the symbol index refers to the section's symbol array
+static SSymbol**
+sortedSymbols(SSection* section) {
+	SSymbol** symbols = (SSymbol**) mem_Alloc(sizeof(SSymbol*) * (section->totalSymbols + 1));
+	if (symbols == NULL)
+		error("Out of memory");
+
+	for (uint32_t i = 0; i < section->totalSymbols; ++i)
+		symbols[i] = &section->symbols[i];
+
+	qsort(symbols, section->totalSymbols, sizeof(SSymbol*), compareSymbols);
+	return symbols;
 }
 
 static void
 writeSectionToMapFile(SSection* section, intptr_t data) {
 	FILE* fileHandle = (FILE*) data;
 
-	sortSymbols(section->symbols, section->totalSymbols);
+	SSymbol** symbols = sortedSymbols(section);
 
 	for (uint32_t i = 0; i < section->totalSymbols; ++i) {
-		SSymbol* symbol = &section->symbols[i];
+		SSymbol* symbol = symbols[i];
 
 		if (!sym_IsImport(symbol) && symbol->resolved) {
 			if (symbol->fileInfoIndex != UINT32_MAX) {
@@ -68,6 +77,8 @@ writeSectionToMapFile(SSection* section, intptr_t data) {
 			}
 		}
 	}
+
+	mem_Free(symbols);
 }
 
 static void
@@ -83,6 +83,30 @@
  *					ENDR
  *			ENDC
  *	ENDR
+ *
+ * Libraries produced by xLib:
+ *
+ *	char		ID[3] = "XLB"
+ *	uint8_t		Version = 0 or 1
+ *	uint32_t	TotalModules
+ *	IF Version >= 1
+ *		uint32_t	DirectoryOffset
+ *	ENDC
+ *	REPT	TotalModules
+ *		ASCIIZ		Name
+ *		uint32_t	Size
+ *		uint8_t		Data[Size]	; XOB or ELF object
+ *	ENDR
+ *	IF Version >= 1
+ *		REPT	TotalModules	; Symbol directory, located at DirectoryOffset
+ *			uint32_t	DataOffset	; File offset of the module's Data
+ *			uint8_t		Flags		; Bit 0 set = always link, module has rooted sections or could not be indexed
+ *			uint32_t	TotalExports
+ *			REPT	TotalExports
+ *				ASCIIZ	Name
+ *			ENDR
+ *		ENDR
+ *	ENDC
  */
 
 #include <assert.h>
@@ -92,12 +116,16 @@
 #include <string.h>
 
 // from util
+#include "crc32.h"
 #include "file.h"
 #include "mem.h"
 #include "str.h"
+#include "strcoll.h"
 
 // from xlink
 #include "elf.h"
+#include "filemap.h"
+#include "intern.h"
 #include "object.h"
 #include "patch.h"
 #include "section.h"
@@ -106,19 +134,112 @@
 
 #define MAKE_ID(a, b, c, d) ((uint32_t) (a) | ((uint32_t) (b) << 8u) | ((uint32_t) (c) << 16u) | ((uint32_t) (d) << 24u))
 
+#define LIBRARY_MODULE_ALWAYS_LINK 0x01u
+
+//	A file mapped into memory. Section data, patch expressions and names are read directly from the mapping.
+typedef struct {
+	const char* fileName;
+	uint8_t* data;
+	size_t size;
+	size_t index;
+	uint32_t checksum;
+	bool checksumValid;
+} SReader;
+
+typedef struct LibraryModule {
+	SReader* library;
+	uint32_t dataOffset;
+	bool read;
+	struct LibraryModule* nextModule;
+} SLibraryModule;
+
 static uint32_t g_fileId = 0;
+static SReader** g_fileReaders = NULL; // The file each file id was read from
 static uint32_t g_minimumWordSize = 0;
 
 static uint32_t g_fileInfoCount = 0;
 static SFileInfo* g_fileInfo = NULL;
 
+//	Maps exported symbol names to the library modules defining them. The modules are owned by g_libraryModules.
+static strmap_t* g_libraryDirectory = NULL;
+static SLibraryModule* g_libraryModules = NULL;
+
+static SReader*
+openReader(const char* filename) {
+	size_t size;
+	uint8_t* data = fmap_Open(filename, &size);
+	if (data == NULL)
+		return NULL;
+
+	SReader* reader = (SReader*) mem_Alloc(sizeof(SReader));
+	if (reader == NULL)
+		error("Out of memory");
+
+	reader->fileName = filename;
+	reader->data = data;
+	reader->size = size;
+	reader->index = 0;
+	reader->checksumValid = false;
+
+	return reader;
+}
+
+static uint32_t
+allocateFileId(SReader* reader) {
+	g_fileReaders = mem_Realloc(g_fileReaders, sizeof(SReader*) * (g_fileId + 1));
+	if (g_fileReaders == NULL)
+		error("Out of memory");
+
+	g_fileReaders[g_fileId] = reader;
+	return g_fileId++;
+}
+
+static uint8_t*
+readBytes(SReader* reader, size_t count) {
+	if (count > reader->size - reader->index)
+		error("File \"%s\" is truncated", reader->fileName);
+
+	uint8_t* data = &reader->data[reader->index];
+	reader->index += count;
+
+	return data;
+}
+
+static uint8_t
+readByte(SReader* reader) {
+	return *readBytes(reader, 1);
+}
+
+static uint32_t
+readLong(SReader* reader) {
+	uint8_t* data = readBytes(reader, 4);
+	return (uint32_t) data[0] | (uint32_t) data[1] << 8u | (uint32_t) data[2] << 16u | (uint32_t) data[3] << 24u;
+}
+
+static const char*
+readString(SReader* reader) {
+	const char* s = (const char*) &reader->data[reader->index];
+	const uint8_t* end = memchr(s, 0, reader->size - reader->index);
+	if (end == NULL)
+		error("File \"%s\" is truncated", reader->fileName);
+
+	reader->index += (size_t) (end - (const uint8_t*) s) + 1;
+	return s;
+}
+
+static void
+readName(SReader* reader, char* dest) {
+	strncpy(dest, readString(reader), MAX_SYMBOL_NAME_LENGTH - 1);
+	dest[MAX_SYMBOL_NAME_LENGTH - 1] = 0;
+}
+
 static void
-readGroup(FILE* fileHandle, Group* group) {
+readGroup(SReader* reader, Group* group) {
 	uint32_t flags;
 	uint32_t type;
 
-	fgetsz(group->name, MAX_SYMBOL_NAME_LENGTH, fileHandle);
-	type = fgetll(fileHandle);
+	readName(reader, group->name);
+	type = readLong(reader);
 
 	flags = type & (GROUP_FLAG_DATA | GROUP_FLAG_SHARED);
 	type &= ~flags;
@@ -139,17 +260,17 @@ allocateGroups(uint32_t totalGroups) {
 }
 
 static Groups*
-readGroups(FILE* fileHandle) {
+readGroups(SReader* reader) {
 	Groups* groups;
 	uint32_t totalGroups;
 
-	totalGroups = fgetll(fileHandle);
+	totalGroups = readLong(reader);
 
 	if ((groups = allocateGroups(totalGroups)) != NULL) {
 		Group* group = groups->groups;
 
 		for (uint32_t i = 0; i < totalGroups; i += 1)
-			readGroup(fileHandle, group++);
+			readGroup(reader, group++);
 	} else {
 		error("Out of memory");
 	}
@@ -158,13 +279,13 @@ readGroups(FILE* fileHandle) {
 }
 
 static void
-readSymbol(FILE* fileHandle, SSymbol* symbol, int version, uint32_t fileInfoIndex) {
-	fgetsz(symbol->name, MAX_SYMBOL_NAME_LENGTH, fileHandle);
+readSymbol(SReader* reader, SSymbol* symbol, int version, uint32_t fileInfoIndex) {
+	symbol->name = intern_String(readString(reader));
 
-	symbol->type = (ESymbolType) fgetll(fileHandle);
+	symbol->type = (ESymbolType) readLong(reader);
 
 	if (symbol->type != SYM_IMPORT && symbol->type != SYM_LOCALIMPORT)
-		symbol->value = fgetll(fileHandle);
+		symbol->value = readLong(reader);
 	else
 		symbol->value = 0;
 
@@ -172,8 +293,8 @@ readSymbol(FILE* fileHandle, SSymbol* symbol, int version, uint32_t fileInfoInde
 	symbol->lineNumber = 0;
 
 	if (version >= 5) {
-		uint32_t symbolFileInfo = fgetll(fileHandle);
-		symbol->lineNumber = fgetll(fileHandle);
+		uint32_t symbolFileInfo = readLong(reader);
+		symbol->lineNumber = readLong(reader);
 
 		if (symbolFileInfo != UINT32_MAX) {
 			assert(symbolFileInfo + fileInfoIndex < g_fileInfoCount);
@@ -187,8 +308,8 @@ readSymbol(FILE* fileHandle, SSymbol* symbol, int version, uint32_t fileInfoInde
 }
 
 static uint32_t
-readSymbols(FILE* fileHandle, SSymbol** outputSymbols, int version, uint32_t fileInfoIndex) {
-	uint32_t totalSymbols = fgetll(fileHandle);
+readSymbols(SReader* reader, SSymbol** outputSymbols, int version, uint32_t fileInfoIndex) {
+	uint32_t totalSymbols = readLong(reader);
 
 	if (totalSymbols == 0) {
 		*outputSymbols = NULL;
@@ -199,7 +320,7 @@ readSymbols(FILE* fileHandle, SSymbol** outputSymbols, int version, uint32_t fil
 			*outputSymbols = symbol;
 
 			for (uint32_t i = 0; i < totalSymbols; i += 1)
-				readSymbol(fileHandle, symbol++, version, fileInfoIndex);
+				readSymbol(reader, symbol++, version, fileInfoIndex);
 
 			return totalSymbols;
 		}
@@ -209,32 +330,28 @@ readSymbols(FILE* fileHandle, SSymbol** outputSymbols, int version, uint32_t fil
 }
 
 static void
-readPatch(FILE* fileHandle, SPatch* patch) {
-	patch->offset = fgetll(fileHandle);
+readPatch(SReader* reader, SPatch* patch) {
+	patch->offset = readLong(reader);
 	patch->valueSymbol = NULL;
 	patch->valueSection = NULL;
-	patch->type = (EPatchType) fgetll(fileHandle);
-	patch->expressionSize = fgetll(fileHandle);
+	patch->type = (EPatchType) readLong(reader);
+	patch->expressionSize = readLong(reader);
 
-	if ((patch->expression = mem_Alloc(patch->expressionSize)) != NULL) {
-		if (patch->expressionSize != fread(patch->expression, 1, patch->expressionSize, fileHandle))
-			error("File read failed");
-	} else {
-		error("Out of memory");
-	}
+	patch->expression = readBytes(reader, patch->expressionSize);
+	patch->ownsExpression = false;
 }
 
 static SPatches*
-readPatches(FILE* fileHandle) {
+readPatches(SReader* reader) {
 	SPatches* patches;
-	int totalPatches = fgetll(fileHandle);
+	int totalPatches = readLong(reader);
 
 	if ((patches = patch_Alloc(totalPatches)) != NULL) {
 		SPatch* patch = patches->patches;
 		int i;
 
 		for (i = 0; i < totalPatches; i += 1)
-			readPatch(fileHandle, patch++);
+			readPatch(reader, patch++);
 
 		return patches;
 	}
@@ -243,22 +360,22 @@ readPatches(FILE* fileHandle) {
 }
 
 static void
-readLineMapping(FILE* fileHandle, SLineMapping* lineMapping, uint32_t fileInfoIndex) {
-	uint32_t index = fgetll(fileHandle) + fileInfoIndex;
+readLineMapping(SReader* reader, SLineMapping* lineMapping, uint32_t fileInfoIndex) {
+	uint32_t index = readLong(reader) + fileInfoIndex;
 	assert(index < g_fileInfoCount);
 
 	lineMapping->fileInfoIndex = index;
-	lineMapping->lineNumber = fgetll(fileHandle);
-	lineMapping->offset = fgetll(fileHandle);
+	lineMapping->lineNumber = readLong(reader);
+	lineMapping->offset = readLong(reader);
 }
 
 static uint32_t
-readLineMappings(FILE* fileHandle, SLineMapping** lineMappings, uint32_t fileInfoIndex) {
-	uint32_t total = fgetll(fileHandle);
+readLineMappings(SReader* reader, SLineMapping** lineMappings, uint32_t fileInfoIndex) {
+	uint32_t total = readLong(reader);
 	if (total > 0) {
 		*lineMappings = (SLineMapping*) mem_Alloc(sizeof(SLineMapping) * total);
 		for (uint32_t i = 0; i < total; ++i) {
-			readLineMapping(fileHandle, &(*lineMappings)[i], fileInfoIndex);
+			readLineMapping(reader, &(*lineMappings)[i], fileInfoIndex);
 		}
 	} else {
 		*lineMappings = NULL;
@@ -267,53 +384,51 @@ readLineMappings(FILE* fileHandle, SLineMapping** lineMappings, uint32_t fileInf
 }
 
 static void
-readSection(FILE* fileHandle, SSection* section, Groups* groups, int version, uint32_t fileInfoIndex) {
-	section->group = groups_GetGroup(groups, fgetll(fileHandle));
-	fgetsz(section->name, MAX_SYMBOL_NAME_LENGTH, fileHandle);
-	section->cpuBank = fgetll(fileHandle);
-	section->cpuByteLocation = fgetll(fileHandle);
+readSection(SReader* reader, SSection* section, Groups* groups, int version, uint32_t fileInfoIndex) {
+	section->group = groups_GetGroup(groups, readLong(reader));
+	section->name = intern_String(readString(reader));
+	section->cpuBank = readLong(reader);
+	section->cpuByteLocation = readLong(reader);
 	if (version >= 1)
-		section->cpuLocation = fgetll(fileHandle);
+		section->cpuLocation = readLong(reader);
 	else
 		section->cpuLocation = section->cpuByteLocation;
 
 	if (version >= 3)
-		section->byteAlign = fgetll(fileHandle);
+		section->byteAlign = readLong(reader);
 	else
 		section->byteAlign = -1;
 
 	if (version >= 4)
-		section->root = fgetc(fileHandle) != 0;
+		section->root = readByte(reader) != 0;
 	else
 		section->root = false;
 
 	if (version >= 6)
-		section->page = fgetll(fileHandle);
+		section->page = readLong(reader);
 	else
 		section->page = -1;
 
-	section->totalSymbols = readSymbols(fileHandle, &section->symbols, version, fileInfoIndex);
+	section->totalSymbols = readSymbols(reader, &section->symbols, version, fileInfoIndex);
 
 	if (version >= 2) {
-		section->totalLineMappings = readLineMappings(fileHandle, &section->lineMappings, fileInfoIndex);
+		section->totalLineMappings = readLineMappings(reader, &section->lineMappings, fileInfoIndex);
 	} else {
 		section->totalLineMappings = 0;
 		section->lineMappings = NULL;
 	}
 
-	section->size = fgetll(fileHandle);
+	section->size = readLong(reader);
 	if (group_isText(section->group)) {
-		if ((section->data = mem_Alloc(section->size)) != NULL) {
-			if (section->size != fread(section->data, 1, section->size, fileHandle))
-				error("File read failed");
-			section->patches = readPatches(fileHandle);
-		}
+		section->data = readBytes(reader, section->size);
+		section->patches = readPatches(reader);
+		patch_Compile(section);
 	}
 }
 
 static SSection**
-readSections(Groups* groups, FILE* fileHandle, int version, uint32_t fileInfoIndex, uint32_t fileId) {
-	uint32_t totalSections = fgetll(fileHandle);
+readSections(Groups* groups, SReader* reader, int version, uint32_t fileInfoIndex, uint32_t fileId) {
+	uint32_t totalSections = readLong(reader);
 	SSection** sections = mem_Alloc(sizeof(SSection*) * totalSections);
 
 	for (uint32_t i = 0; i < totalSections; ++i) {
@@ -323,7 +438,7 @@ readSections(Groups* groups, FILE* fileHandle, int version, uint32_t fileInfoInd
 		section->minimumWordSize = g_minimumWordSize;
 		section->fileId = fileId;
 
-		readSection(fileHandle, section, groups, version, fileInfoIndex);
+		readSection(reader, section, groups, version, fileInfoIndex);
 
 		if (group_isText(section->group) && strcmp(section->group->name, "HOME") == 0) {
 			section->cpuBank = 0;
@@ -344,9 +459,9 @@ findFileInfo(string* filename, uint32_t crc32) {
 }
 
 static uint32_t
-readFileInfo(FILE* fileHandle) {
+readFileInfo(SReader* reader) {
 	uint32_t fileInfoIndex = g_fileInfoCount;
-	uint32_t fileInfoInObject = fgetll(fileHandle);
+	uint32_t fileInfoInObject = readLong(reader);
 
 	if (fileInfoInObject > 0) {
 		g_fileInfoCount += fileInfoInObject;
@@ -354,8 +469,8 @@ readFileInfo(FILE* fileHandle) {
 
 		for (uint32_t i = 0; i < fileInfoInObject; ++i) {
 			uint32_t index = i + fileInfoIndex;
-			g_fileInfo[index].fileName = fgetstr(fileHandle);
-			g_fileInfo[index].crc32 = fgetll(fileHandle);
+			g_fileInfo[index].fileName = str_Create(readString(reader));
+			g_fileInfo[index].crc32 = readLong(reader);
 
 			SFileInfo* fileInfo = findFileInfo(g_fileInfo[i].fileName, g_fileInfo[i].crc32);
 			if (fileInfo != NULL) {
@@ -370,90 +485,177 @@ readFileInfo(FILE* fileHandle) {
 }
 
 static void
-readXOB0(FILE* fileHandle, uint32_t fileId) {
+readXOB0(SReader* reader, uint32_t fileId) {
 	g_minimumWordSize = 1;
-	SSection** sections = readSections(readGroups(fileHandle), fileHandle, 0, 0, fileId);
+	SSection** sections = readSections(readGroups(reader), reader, 0, 0, fileId);
 	mem_Free(sections);
 }
 
 static void
-readXOB1(FILE* fileHandle, uint32_t fileId) {
-	g_minimumWordSize = fgetc(fileHandle);
-	SSection** sections = readSections(readGroups(fileHandle), fileHandle, 1, 0, fileId);
+readXOB1(SReader* reader, uint32_t fileId) {
+	g_minimumWordSize = readByte(reader);
+	SSection** sections = readSections(readGroups(reader), reader, 1, 0, fileId);
 	mem_Free(sections);
 }
 
 static void
-readXOBn(FILE* fileHandle, int32_t version, uint32_t fileId) {
-	g_minimumWordSize = fgetc(fileHandle);
-	uint32_t fileInfoIndex = readFileInfo(fileHandle);
-	SSection** sections = readSections(readGroups(fileHandle), fileHandle, version, fileInfoIndex, fileId);
+readXOBn(SReader* reader, int32_t version, uint32_t fileId) {
+	g_minimumWordSize = readByte(reader);
+	uint32_t fileInfoIndex = readFileInfo(reader);
+	SSection** sections = readSections(readGroups(reader), reader, version, fileInfoIndex, fileId);
 	mem_Free(sections);
 }
 
 static bool
-readChunk(FILE* fileHandle, const char* filename);
+readChunk(SReader* reader);
 
 static void
-readXLB0(FILE* fileHandle, const char* filename) {
-	uint32_t count = fgetll(fileHandle);
+readXLB0(SReader* reader) {
+	uint32_t count = readLong(reader);
 
 	while (count--) {
-		while (fgetc(fileHandle)) {
-		}                   // Skip name
-		fgetll(fileHandle); // Skip length
+		readString(reader); // Skip name
+		readLong(reader);   // Skip length
 
-		readChunk(fileHandle, filename);
+		readChunk(reader);
 	}
 }
 
+static void
+freeModuleReference(intptr_t userData, intptr_t element) {
+	// Modules are owned by g_libraryModules
+}
+
+static SLibraryModule*
+createLibraryModule(SReader* library, uint32_t dataOffset) {
+	SLibraryModule* module = (SLibraryModule*) mem_Alloc(sizeof(SLibraryModule));
+	if (module == NULL)
+		error("Out of memory");
+
+	module->library = library;
+	module->dataOffset = dataOffset;
+	module->read = false;
+	module->nextModule = g_libraryModules;
+	g_libraryModules = module;
+
+	return module;
+}
+
+static void
+readLibraryModule(SLibraryModule* module) {
+	SReader* library = module->library;
+	if (module->dataOffset > library->size)
+		error("File \"%s\" is truncated", library->fileName);
+
+	module->read = true;
+	library->index = module->dataOffset;
+	readChunk(library);
+}
+
+static void
+readDirectoryEntry(SReader* reader) {
+	SLibraryModule* module = createLibraryModule(reader, readLong(reader));
+	uint8_t flags = readByte(reader);
+	uint32_t totalExports = readLong(reader);
+
+	for (uint32_t i = 0; i < totalExports; ++i) {
+		string* name = str_Create(readString(reader));
+
+		//	The first library on the command line defining a symbol wins
+		if (!strmap_HasKey(g_libraryDirectory, name))
+			strmap_Insert(g_libraryDirectory, name, (intptr_t) module);
+		else
+			str_Free(name);
+	}
+
+	if (flags & LIBRARY_MODULE_ALWAYS_LINK) {
+		size_t directoryIndex = reader->index;
+		readLibraryModule(module);
+		reader->index = directoryIndex;
+	}
+}
+
+static void
+readXLB1(SReader* reader) {
+	uint32_t count = readLong(reader);
+	uint32_t directoryOffset = readLong(reader);
+
+	if (g_libraryDirectory == NULL)
+		g_libraryDirectory = strmap_Create(freeModuleReference);
+
+	if (directoryOffset > reader->size)
+		error("File \"%s\" is truncated", reader->fileName);
+
+	reader->index = directoryOffset;
+	while (count--)
+		readDirectoryEntry(reader);
+
+	reader->index = reader->size;
+}
+
+static void
+readELF(SReader* reader) {
+	//	The ELF reader works on the file itself, it can only read stand-alone objects
+	FILE* fileHandle = fopen(reader->fileName, "rb");
+	if (fileHandle == NULL)
+		error("File \"%s\" not found", reader->fileName);
+
+	elf_Read(fileHandle, reader->fileName, allocateFileId(reader));
+	fclose(fileHandle);
+}
+
 static bool
-readChunk(FILE* fileHandle, const char* filename) {
-	uint32_t id = fgetll(fileHandle);
+readChunk(SReader* reader) {
+	uint32_t id = readLong(reader);
 
 	switch (id) {
 		case MAKE_ID('X', 'O', 'B', 0): {
-			readXOB0(fileHandle, g_fileId++);
+			readXOB0(reader, allocateFileId(reader));
 			return true;
 		}
 
 		case MAKE_ID('X', 'O', 'B', 1): {
-			readXOB1(fileHandle, g_fileId++);
+			readXOB1(reader, allocateFileId(reader));
 			return true;
 		}
 
 		case MAKE_ID('X', 'O', 'B', 2): {
-			readXOBn(fileHandle, 2, g_fileId++);
+			readXOBn(reader, 2, allocateFileId(reader));
 			return true;
 		}
 
 		case MAKE_ID('X', 'O', 'B', 3): {
-			readXOBn(fileHandle, 3, g_fileId++);
+			readXOBn(reader, 3, allocateFileId(reader));
 			return true;
 		}
 
 		case MAKE_ID('X', 'O', 'B', 4): {
-			readXOBn(fileHandle, 4, g_fileId++);
+			readXOBn(reader, 4, allocateFileId(reader));
 			return true;
 		}
 
 		case MAKE_ID('X', 'O', 'B', 5): {
-			readXOBn(fileHandle, 5, g_fileId++);
+			readXOBn(reader, 5, allocateFileId(reader));
 			return true;
 		}
 
 		case MAKE_ID('X', 'O', 'B', 6): {
-			readXOBn(fileHandle, 6, g_fileId++);
+			readXOBn(reader, 6, allocateFileId(reader));
 			return true;
 		}
 
 		case MAKE_ID('X', 'L', 'B', 0): {
-			readXLB0(fileHandle, filename);
+			readXLB0(reader);
+			return true;
+		}
+
+		case MAKE_ID('X', 'L', 'B', 1): {
+			readXLB1(reader);
 			return true;
 		}
 
 		case MAKE_ID(0x7F, 'E', 'L', 'F'): {
-			elf_Read(fileHandle, filename, g_fileId++);
+			readELF(reader);
 			return false;
 		}
 
@@ -481,20 +683,68 @@ obj_AllocateFileInfo(uint32_t count) {
 
 void
 obj_Read(char* filename) {
-	FILE* fileHandle;
-
-	if ((fileHandle = fopen(filename, "rb")) != NULL) {
-		size_t size = fsize(fileHandle);
+	SReader* reader = openReader(filename);
 
-		while ((size_t) ftell(fileHandle) < size && readChunk(fileHandle, filename)) {
+	if (reader != NULL) {
+		while (reader->index < reader->size && readChunk(reader)) {
 		}
-
-		fclose(fileHandle);
 	} else {
 		error("File \"%s\" not found", filename);
 	}
 }
 
+static void
+readModuleExporting(const char* symbolName) {
+	string* name = str_Create(symbolName);
+	SLibraryModule* module;
+
+	if (strmap_Value(g_libraryDirectory, name, (intptr_t*) &module) && !module->read) {
+		readLibraryModule(module);
+		sect_BuildSymbolIndex();
+	}
+
+	str_Free(name);
+}
+
+void
+obj_ReadRequiredLibraryModules(const char* rootSymbol) {
+	sect_BuildSymbolIndex();
+
+	if (g_libraryDirectory == NULL)
+		return;
+
+	if (rootSymbol != NULL && !sect_HasExportedSymbol(rootSymbol))
+		readModuleExporting(rootSymbol);
+
+	//	Modules read here append their sections to the list, so their imports are also visited
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		for (uint32_t i = 0; i < section->totalSymbols; ++i) {
+			SSymbol* symbol = &section->symbols[i];
+			if (symbol->type == SYM_IMPORT && !sect_HasExportedSymbol(symbol->name))
+				readModuleExporting(symbol->name);
+		}
+	}
+}
+
+const char*
+obj_GetInputFileName(uint32_t fileId) {
+	return fileId < g_fileId ? g_fileReaders[fileId]->fileName : NULL;
+}
+
+uint32_t
+obj_GetInputFileChecksum(uint32_t fileId) {
+	if (fileId >= g_fileId)
+		return 0;
+
+	SReader* reader = g_fileReaders[fileId];
+	if (!reader->checksumValid) {
+		reader->checksum = crc32(reader->data, reader->size);
+		reader->checksumValid = true;
+	}
+
+	return reader->checksum;
+}
+
 const string*
 obj_GetFilename(uint32_t fileInfoIndex) {
 	assert(fileInfoIndex < g_fileInfoCount);
@@ -72,4 +72,19 @@ obj_GetFilename(uint32_t fileInfoIndex);
 extern void
 obj_Read(char* fileName);
 
+//	Returns the name of the object file or library the sections with the file id were read from, or NULL for sections
+//	created by the linker
+extern const char*
+obj_GetInputFileName(uint32_t fileId);
+
+//	Returns a checksum of the contents of the file the sections with the file id were read from. Must be called before
+//	the sections are patched, patching changes the contents in memory.
+extern uint32_t
+obj_GetInputFileChecksum(uint32_t fileId);
+
+//	Reads the library modules needed to resolve the imports of the objects read so far and the root symbol, which may be
+//	NULL, and indexes all symbols
+extern void
+obj_ReadRequiredLibraryModules(const char* rootSymbol);
+
 #endif
@@ -0,0 +1,255 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "mem.h"
+
+#include "parallel.h"
+#include "xlink.h"
+
+#define MAX_THREADS 64
+
+typedef struct {
+	void (*job)(uint32_t index, void* data);
+	void* data;
+	uint32_t totalJobs;
+	uint32_t nextJob;
+	uint32_t failedJob;
+	char* errorMessage;
+#if defined(_WIN32)
+	CRITICAL_SECTION lock;
+#else
+	pthread_mutex_t lock;
+#endif
+} SJobQueue;
+
+typedef struct {
+	SJobQueue* queue;
+	jmp_buf abandon;
+	char* errorMessage;
+} SWorker;
+
+#if defined(_WIN32)
+static DWORD g_workerKey;
+#else
+static pthread_key_t g_workerKey;
+#endif
+static bool g_workerKeyCreated = false;
+
+static void
+lockQueue(SJobQueue* queue) {
+#if defined(_WIN32)
+	EnterCriticalSection(&queue->lock);
+#else
+	pthread_mutex_lock(&queue->lock);
+#endif
+}
+
+static void
+unlockQueue(SJobQueue* queue) {
+#if defined(_WIN32)
+	LeaveCriticalSection(&queue->lock);
+#else
+	pthread_mutex_unlock(&queue->lock);
+#endif
+}
+
+static SWorker*
+currentWorker(void) {
+	if (!g_workerKeyCreated)
+		return NULL;
+
+#if defined(_WIN32)
+	return (SWorker*) TlsGetValue(g_workerKey);
+#else
+	return (SWorker*) pthread_getspecific(g_workerKey);
+#endif
+}
+
+//	Jobs following one that has failed need not run, their errors would not be reported
+static uint32_t
+nextJob(SJobQueue* queue) {
+	lockQueue(queue);
+	uint32_t index = queue->nextJob < queue->failedJob ? queue->nextJob++ : UINT32_MAX;
+	unlockQueue(queue);
+
+	return index;
+}
+
+static void
+recordFailure(SJobQueue* queue, uint32_t index, char* errorMessage) {
+	lockQueue(queue);
+	if (index < queue->failedJob) {
+		mem_Free(queue->errorMessage);
+		queue->failedJob = index;
+		queue->errorMessage = errorMessage;
+	} else {
+		mem_Free(errorMessage);
+	}
+	unlockQueue(queue);
+}
+
+static bool
+runJob(SWorker* worker, uint32_t index) {
+	if (setjmp(worker->abandon) != 0)
+		return false;
+
+	worker->queue->job(index, worker->queue->data);
+	return true;
+}
+
+static void
+runJobs(SWorker* worker) {
+#if defined(_WIN32)
+	TlsSetValue(g_workerKey, worker);
+#else
+	pthread_setspecific(g_workerKey, worker);
+#endif
+
+	uint32_t index;
+	while ((index = nextJob(worker->queue)) < worker->queue->totalJobs) {
+		if (!runJob(worker, index))
+			recordFailure(worker->queue, index, worker->errorMessage);
+	}
+}
+
+#if defined(_WIN32)
+
+static DWORD WINAPI
+workerThread(LPVOID worker) {
+	runJobs((SWorker*) worker);
+	return 0;
+}
+
+#else
+
+static void*
+workerThread(void* worker) {
+	runJobs((SWorker*) worker);
+	return NULL;
+}
+
+#endif
+
+static void
+runThreads(SWorker* workers, uint32_t totalThreads) {
+#if defined(_WIN32)
+	HANDLE threads[MAX_THREADS];
+
+	for (uint32_t i = 0; i < totalThreads; ++i) {
+		threads[i] = CreateThread(NULL, 0, workerThread, &workers[i], 0, NULL);
+		if (threads[i] == NULL)
+			error("Unable to create thread");
+	}
+
+	for (uint32_t i = 0; i < totalThreads; ++i) {
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+	}
+#else
+	pthread_t threads[MAX_THREADS];
+
+	for (uint32_t i = 0; i < totalThreads; ++i) {
+		if (pthread_create(&threads[i], NULL, workerThread, &workers[i]) != 0)
+			error("Unable to create thread");
+	}
+
+	for (uint32_t i = 0; i < totalThreads; ++i)
+		pthread_join(threads[i], NULL);
+#endif
+}
+
+extern void
+parallel_For(uint32_t totalJobs, uint32_t totalThreads, void (*job)(uint32_t index, void* data), void* data) {
+	if (totalThreads > totalJobs)
+		totalThreads = totalJobs;
+	if (totalThreads > MAX_THREADS)
+		totalThreads = MAX_THREADS;
+
+	if (totalThreads <= 1) {
+		for (uint32_t i = 0; i < totalJobs; ++i)
+			job(i, data);
+		return;
+	}
+
+	SJobQueue queue;
+	queue.job = job;
+	queue.data = data;
+	queue.totalJobs = totalJobs;
+	queue.nextJob = 0;
+	queue.failedJob = UINT32_MAX;
+	queue.errorMessage = NULL;
+
+	SWorker workers[MAX_THREADS];
+
+#if defined(_WIN32)
+	InitializeCriticalSection(&queue.lock);
+	if ((g_workerKey = TlsAlloc()) == TLS_OUT_OF_INDEXES)
+		error("Unable to create thread");
+#else
+	pthread_mutex_init(&queue.lock, NULL);
+	if (pthread_key_create(&g_workerKey, NULL) != 0)
+		error("Unable to create thread");
+#endif
+	g_workerKeyCreated = true;
+
+	for (uint32_t i = 0; i < totalThreads; ++i) {
+		workers[i].queue = &queue;
+		workers[i].errorMessage = NULL;
+	}
+
+	runThreads(workers, totalThreads);
+
+	g_workerKeyCreated = false;
+#if defined(_WIN32)
+	TlsFree(g_workerKey);
+	DeleteCriticalSection(&queue.lock);
+#else
+	pthread_key_delete(g_workerKey);
+	pthread_mutex_destroy(&queue.lock);
+#endif
+
+	if (queue.errorMessage != NULL)
+		error("%s", queue.errorMessage);
+}
+
+extern void
+parallel_AbandonJob(const char* fmt, va_list args) {
+	SWorker* worker = currentWorker();
+	if (worker == NULL)
+		return;
+
+	va_list copy;
+	va_copy(copy, args);
+	int length = vsnprintf(NULL, 0, fmt, copy);
+	va_end(copy);
+
+	worker->errorMessage = (char*) mem_Alloc((size_t) length + 1);
+	vsnprintf(worker->errorMessage, (size_t) length + 1, fmt, args);
+
+	longjmp(worker->abandon, 1);
+}
@@ -0,0 +1,35 @@
+/*  Copyright 2008-2026 Carsten Elton Sorensen and contributors
+
+    This file is part of ASMotor.
+
+    ASMotor is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    ASMotor is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XLINK_PARALLEL_H_INCLUDED_
+#define XLINK_PARALLEL_H_INCLUDED_
+
+#include <stdarg.h>
+#include <stdint.h>
+
+//	Calls job(index, data) for every index from 0 to totalJobs - 1, using up to totalThreads threads. A job that calls
+//	error() is abandoned. When all jobs have finished, the error of the lowest abandoned index is reported, as it
+//	would have been had the jobs run one after the other.
+extern void
+parallel_For(uint32_t totalJobs, uint32_t totalThreads, void (*job)(uint32_t index, void* data), void* data);
+
+//	Called by error(). Abandons the calling thread's job, or returns if the thread isn't running one.
+extern void
+parallel_AbandonJob(const char* fmt, va_list args);
+
+#endif
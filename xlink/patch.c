@@ -25,6 +25,7 @@
 #include "mem.h"
 
 #include "group.h"
+#include "parallel.h"
 #include "patch.h"
 #include "section.h"
 #include "symbol.h"
@@ -38,137 +39,139 @@ typedef struct StackEntry_ {
 	int32_t value;
 } StackEntry;
 
-static char* g_stringStack[STACKSIZE];
-static StackEntry g_stack[STACKSIZE];
-static int32_t g_stackIndex;
+typedef struct {
+	char* strings[STACKSIZE];
+	StackEntry entries[STACKSIZE];
+	int32_t index;
+} SEvaluationStack;
 
 static void
-pushString(char* stringValue) {
-	if (g_stackIndex >= STACKSIZE)
+pushString(SEvaluationStack* stack, char* stringValue) {
+	if (stack->index >= STACKSIZE)
 		error("patch too complex");
 
-	g_stringStack[g_stackIndex++] = stringValue;
+	stack->strings[stack->index++] = stringValue;
 }
 
 static void
-pushStringCopy(const char* stringValue) {
+pushStringCopy(SEvaluationStack* stack, const char* stringValue) {
 	size_t len = strlen(stringValue) + 1;
 	char* copy = mem_Alloc(len);
 	strncpy(copy, stringValue, len);
 
-	pushString(copy);
+	pushString(stack, copy);
 }
 
 static void
-pushIntAsString(uint32_t intValue) {
+pushIntAsString(SEvaluationStack* stack, uint32_t intValue) {
 	char* value = mem_Alloc(16);
 	snprintf(value, 16, "%u", intValue);
 
-	pushString(value);
+	pushString(stack, value);
 }
 
 static char*
-popString(void) {
-	if (g_stackIndex > 0)
-		return g_stringStack[--g_stackIndex];
+popString(SEvaluationStack* stack) {
+	if (stack->index > 0)
+		return stack->strings[--stack->index];
 
 	error("mangled patch");
 	return NULL;
 }
 
 static void
-popStringPair(char** outLeft, char** outRight) {
-	*outRight = popString();
-	*outLeft = popString();
+popStringPair(SEvaluationStack* stack, char** outLeft, char** outRight) {
+	*outRight = popString(stack);
+	*outLeft = popString(stack);
 }
 
 static void
-pushStackValue(SSection* section, SSymbol* symbol, int32_t value) {
-	if (g_stackIndex >= STACKSIZE)
+pushStackValue(SEvaluationStack* stack, SSection* section, SSymbol* symbol, int32_t value) {
+	if (stack->index >= STACKSIZE)
 		error("patch too complex");
 
 	StackEntry entry = {section, symbol, value};
-	g_stack[g_stackIndex++] = entry;
+	stack->entries[stack->index++] = entry;
 }
 
 static void
-pushInt(int32_t value) {
-	pushStackValue(NULL, NULL, value);
+pushInt(SEvaluationStack* stack, int32_t value) {
+	pushStackValue(stack, NULL, NULL, value);
 }
 
 static StackEntry
-popInt(void) {
-	if (g_stackIndex > 0)
-		return g_stack[--g_stackIndex];
+popInt(SEvaluationStack* stack) {
+	if (stack->index > 0)
+		return stack->entries[--stack->index];
 
 	error("mangled patch");
-	return g_stack[0]; // dummy return
+	return stack->entries[0]; // dummy return
 }
 
 static void
-popIntPair(StackEntry* outLeft, StackEntry* outRight) {
-	*outRight = popInt();
-	*outLeft = popInt();
+popIntPair(SEvaluationStack* stack, StackEntry* outLeft, StackEntry* outRight) {
+	*outRight = popInt(stack);
+	*outLeft = popInt(stack);
 }
 
 static void
-combinePatchStrings(char* operator) {
+combinePatchStrings(SEvaluationStack* stack, char* operator) {
 	char* left;
 	char* right;
 	char* result;
 
-	popStringPair(&left, &right);
+	popStringPair(stack, &left, &right);
 
 	size_t sz = strlen(left) + strlen(right) + strlen(operator) + 5;
 	result = (char*) mem_Alloc(sz);
 	snprintf(result, sz, "(%s)%s(%s)", left, operator, right);
 
-	pushString(result);
+	pushString(stack, result);
 
 	mem_Free(left);
 	mem_Free(right);
 }
 
 static void
-combinePatchFunctionStrings(char* function) {
+combinePatchFunctionStrings(SEvaluationStack* stack, char* function) {
 	char* left;
 	char* right;
 	char* result;
 
-	popStringPair(&left, &right);
+	popStringPair(stack, &left, &right);
 
 	size_t sz = strlen(left) + strlen(right) + strlen(function) + 4;
 	result = (char*) mem_Alloc(sz);
 	snprintf(result, sz, "%s(%s,%s)", function, left, right);
 
-	pushString(result);
+	pushString(stack, result);
 
 	mem_Free(left);
 	mem_Free(right);
 }
 
 static void
-combinePatchFunctionString(char* function) {
+combinePatchFunctionString(SEvaluationStack* stack, char* function) {
 	char* left;
 	char* result;
 
-	left = popString();
+	left = popString(stack);
 
 	size_t sz = strlen(left) + strlen(function) + 3;
 	result = (char*) mem_Alloc(sz);
 	snprintf(result, sz, "%s(%s)", function, left);
 
-	pushString(result);
+	pushString(stack, result);
 
 	mem_Free(left);
 }
 
 static char*
-makePatchString(SPatch* patch, SSection* section) {
+formatPatch(SEvaluationStack* stack, SPatch* patch, SSection* section) {
 	int32_t size = patch->expressionSize;
 	uint8_t* expression = patch->expression;
 
-	g_stackIndex = 0;
+	stack->index = 0;
 
 	while (size-- > 0) {
 		char* left;
@@ -176,100 +179,100 @@ makePatchString(SPatch* patch, SSection* section) {
 
 		switch ((EExpressionOperator) *expression++) {
 			case OBJ_OP_SUB:
-				combinePatchStrings("-");
+				combinePatchStrings(stack, "-");
 				break;
 			case OBJ_OP_ADD:
-				combinePatchStrings("+");
+				combinePatchStrings(stack, "+");
 				break;
 			case OBJ_OP_XOR:
-				combinePatchStrings("^");
+				combinePatchStrings(stack, "^");
 				break;
 			case OBJ_OP_OR:
-				combinePatchStrings("|");
+				combinePatchStrings(stack, "|");
 				break;
 			case OBJ_OP_AND:
-				combinePatchStrings("&");
+				combinePatchStrings(stack, "&");
 				break;
 			case OBJ_OP_ASL:
-				combinePatchStrings("<<");
+				combinePatchStrings(stack, "<<");
 				break;
 			case OBJ_OP_ASR:
-				combinePatchStrings(">>");
+				combinePatchStrings(stack, ">>");
 				break;
 			case OBJ_OP_MUL:
-				combinePatchStrings("*");
+				combinePatchStrings(stack, "*");
 				break;
 			case OBJ_OP_DIV:
-				combinePatchStrings("/");
+				combinePatchStrings(stack, "/");
 				break;
 			case OBJ_OP_MOD:
-				combinePatchStrings("%%");
+				combinePatchStrings(stack, "%%");
 				break;
 			case OBJ_OP_BOOLEAN_OR:
-				combinePatchStrings("||");
+				combinePatchStrings(stack, "||");
 				break;
 			case OBJ_OP_BOOLEAN_AND:
-				combinePatchStrings("&&");
+				combinePatchStrings(stack, "&&");
 				break;
 			case OBJ_OP_BOOLEAN_NOT:
-				combinePatchFunctionString("!");
+				combinePatchFunctionString(stack, "!");
 				break;
 			case OBJ_OP_GREATER_OR_EQUAL:
-				combinePatchStrings(">=");
+				combinePatchStrings(stack, ">=");
 				break;
 			case OBJ_OP_GREATER_THAN:
-				combinePatchStrings(">");
+				combinePatchStrings(stack, ">");
 				break;
 			case OBJ_OP_LESS_OR_EQUAL:
-				combinePatchStrings("<=");
+				combinePatchStrings(stack, "<=");
 				break;
 			case OBJ_OP_LESS_THAN:
-				combinePatchStrings("<");
+				combinePatchStrings(stack, "<");
 				break;
 			case OBJ_OP_EQUALS:
-				combinePatchStrings("==");
+				combinePatchStrings(stack, "==");
 				break;
 			case OBJ_OP_NOT_EQUALS:
-				combinePatchStrings("!=");
+				combinePatchStrings(stack, "!=");
 				break;
 			case OBJ_FUNC_LOW_LIMIT: {
-				popStringPair(&left, &right);
-				pushString(left);
+				popStringPair(stack, &left, &right);
+				pushString(stack, left);
 				mem_Free(right);
 				break;
 			}
 			case OBJ_FUNC_HIGH_LIMIT: {
-				popStringPair(&left, &right);
-				pushString(left);
+				popStringPair(stack, &left, &right);
+				pushString(stack, left);
 				mem_Free(right);
 				break;
 			}
 			case OBJ_FUNC_FDIV:
-				combinePatchFunctionStrings("FDIV");
+				combinePatchFunctionStrings(stack, "FDIV");
 				break;
 			case OBJ_FUNC_FMUL:
-				combinePatchFunctionStrings("FMUL");
+				combinePatchFunctionStrings(stack, "FMUL");
 				break;
 			case OBJ_FUNC_ATAN2:
-				combinePatchFunctionStrings("ATAN2");
+				combinePatchFunctionStrings(stack, "ATAN2");
 				break;
 			case OBJ_FUNC_SIN:
-				combinePatchFunctionString("SIN");
+				combinePatchFunctionString(stack, "SIN");
 				break;
 			case OBJ_FUNC_COS:
-				combinePatchFunctionString("COS");
+				combinePatchFunctionString(stack, "COS");
 				break;
 			case OBJ_FUNC_TAN:
-				combinePatchFunctionString("TAN");
+				combinePatchFunctionString(stack, "TAN");
 				break;
 			case OBJ_FUNC_ASIN:
-				combinePatchFunctionString("ASIN");
+				combinePatchFunctionString(stack, "ASIN");
 				break;
 			case OBJ_FUNC_ACOS:
-				combinePatchFunctionString("ACOS");
+				combinePatchFunctionString(stack, "ACOS");
 				break;
 			case OBJ_FUNC_ATAN:
-				combinePatchFunctionString("ATAN");
+				combinePatchFunctionString(stack, "ATAN");
 				break;
 			case OBJ_CONSTANT: {
 				uint32_t value;
@@ -279,7 +282,7 @@ makePatchString(SPatch* patch, SSection* section) {
 				value |= (*expression++) << 16u;
 				value |= (*expression++) << 24u;
 
-				pushIntAsString(value);
+				pushIntAsString(stack, value);
 
 				size -= 4;
 				break;
@@ -292,13 +295,13 @@ makePatchString(SPatch* patch, SSection* section) {
 				symbolId |= (*expression++) << 16u;
 				symbolId |= (*expression++) << 24u;
 
-				pushStringCopy(sect_GetSymbolName(section, symbolId));
+				pushStringCopy(stack, sect_GetSymbolName(section, symbolId));
 
 				size -= 4;
 				break;
 			}
 			case OBJ_FUNC_BANK: {
-				char* symbolName;
+				const char* symbolName;
 				char* copy;
 				uint32_t symbolId;
 
@@ -313,15 +316,15 @@ makePatchString(SPatch* patch, SSection* section) {
 				copy = mem_Alloc(sz);
 				snprintf(copy, sz, "BANK(%s)", symbolName);
 
-				pushString(copy);
+				pushString(stack, copy);
 
 				size -= 4;
 				break;
 			}
 			case OBJ_PC_REL: {
-				combinePatchStrings("+");
-				pushStringCopy("*");
-				combinePatchStrings("-");
+				combinePatchStrings(stack, "+");
+				pushStringCopy(stack, "*");
+				combinePatchStrings(stack, "-");
 				break;
 			}
 			default:
@@ -330,65 +333,146 @@ makePatchString(SPatch* patch, SSection* section) {
 		}
 	}
 
-	return popString();
+	return popString(stack);
 }
 
-#define combine_bitwise(left, right, operator)                                                                           \
-	popIntPair(&(left), &(right));                                                                                       \
-	if ((left).symbol == NULL && (right).symbol == NULL) {                                                               \
-		pushInt((uint32_t) (left).value operator(uint32_t)(right).value);                                                \
-	} else {                                                                                                             \
-		error("Expression \"%s\" at offset %d in section \"%s\" attempts to combine two values from different sections", \
-		      makePatchString(patch, section), patch->offset, section->name);                                            \
-	}
+//	Used for error messages, the string is formatted on a stack of its own to leave the evaluation stack intact
+static char*
+makePatchString(SPatch* patch, SSection* section) {
+	SEvaluationStack stack;
+	return formatPatch(&stack, patch, section);
+}
 
-#define combine_operator(left, right, operator)                                                                          \
-	popIntPair(&(left), &(right));                                                                                       \
-	if ((left).symbol == NULL && (right).symbol == NULL) {                                                               \
-		pushInt((left).value operator(right).value);                                                                     \
-	} else {                                                                                                             \
-		error("Expression \"%s\" at offset %d in section \"%s\" attempts to combine two values from different sections", \
-		      makePatchString(patch, section), patch->offset, section->name);                                            \
+static void
+combineError(SPatch* patch, SSection* section) {
+	if (patch != NULL && section != NULL) {
+		error("Expression \"%s\" at offset %d in section \"%s\" attempts to combine two values from different sections",
+		      makePatchString(patch, section), patch->offset, section->name);
 	}
 
-#define combine_func(left, right, operator)                                                                              \
-	popIntPair(&(left), &(right));                                                                                       \
-	if ((left).symbol == NULL && (right).symbol == NULL) {                                                               \
-		pushInt(operator((left).value, (right).value));                                                                  \
-	} else {                                                                                                             \
-		error("Expression \"%s\" at offset %d in section \"%s\" attempts to combine two values from different sections", \
-		      makePatchString(patch, section), patch->offset, section->name);                                            \
+	error("Internal patch error");
+}
+
+//	The value of an operator applied to two values not relative to a section. Unary operators ignore the right value.
+static int32_t
+applyOperator(EExpressionOperator operator, int32_t left, int32_t right) {
+	switch (operator) {
+		case OBJ_OP_SUB:
+			return left - right;
+		case OBJ_OP_ADD:
+			return left + right;
+		case OBJ_OP_XOR:
+			return (int32_t) ((uint32_t) left ^ (uint32_t) right);
+		case OBJ_OP_OR:
+			return (int32_t) ((uint32_t) left | (uint32_t) right);
+		case OBJ_OP_AND:
+			return (int32_t) ((uint32_t) left & (uint32_t) right);
+		case OBJ_OP_ASL:
+			return left << right;
+		case OBJ_OP_ASR:
+			return left >> right;
+		case OBJ_OP_MUL:
+			return left * right;
+		case OBJ_OP_DIV:
+			return left / right;
+		case OBJ_OP_MOD:
+			return left % right;
+		case OBJ_OP_BOOLEAN_OR:
+			return left || right;
+		case OBJ_OP_BOOLEAN_AND:
+			return left && right;
+		case OBJ_OP_GREATER_OR_EQUAL:
+			return left >= right;
+		case OBJ_OP_GREATER_THAN:
+			return left > right;
+		case OBJ_OP_LESS_OR_EQUAL:
+			return left <= right;
+		case OBJ_OP_LESS_THAN:
+			return left < right;
+		case OBJ_OP_EQUALS:
+			return left == right;
+		case OBJ_OP_NOT_EQUALS:
+			return left != right;
+		case OBJ_OP_BOOLEAN_NOT:
+			return !left;
+		case OBJ_FUNC_FDIV:
+			return fdiv(left, right);
+		case OBJ_FUNC_FMUL:
+			return fmul(left, right);
+		case OBJ_FUNC_ATAN2:
+			return fatan2(left, right);
+		case OBJ_FUNC_SIN:
+			return fsin(left);
+		case OBJ_FUNC_COS:
+			return fcos(left);
+		case OBJ_FUNC_TAN:
+			return ftan(left);
+		case OBJ_FUNC_ASIN:
+			return fasin(left);
+		case OBJ_FUNC_ACOS:
+			return facos(left);
+		case OBJ_FUNC_ATAN:
+			return fatan(left);
+		default:
+			error("Unknown patch operator");
+			return 0;
 	}
+}
 
-#define unary(left, operator)                                                                                                    \
-	(left) = popInt();                                                                                                           \
-	if ((left).symbol == NULL) {                                                                                                 \
-		pushStackValue(NULL, (left).symbol, operator((left).value));                                                             \
-	} else {                                                                                                                     \
-		error("Expression \"%s\" at offset %d in section \"%s\" attempts to perform a unary operation on a value relative to a " \
-		      "section",                                                                                                         \
-		      makePatchString(patch, section), patch->offset, section->name);                                                    \
+//	Whether an operator applied to constants can be replaced by its value when the expression is compiled. Operators
+//	that would fail are left for the evaluation to report.
+static bool
+foldConstants(EExpressionOperator operator, int32_t left, int32_t right, int32_t* outValue) {
+	switch (operator) {
+		case OBJ_OP_DIV:
+		case OBJ_OP_MOD:
+		case OBJ_FUNC_FDIV:
+			if (right == 0)
+				return false;
+			break;
+		case OBJ_FUNC_LOW_LIMIT:
+			*outValue = left;
+			return left >= right;
+		case OBJ_FUNC_HIGH_LIMIT:
+			*outValue = left;
+			return left <= right;
+		case OBJ_FUNC_ASSERT:
+			*outValue = left;
+			return right != 0;
+		case OBJ_PC_REL:
+		case OBJ_GROUP_PROPERTY:
+			return false;
+		default:
+			break;
 	}
 
+	*outValue = applyOperator(operator, left, right);
+	return true;
+}
+
 static bool
-calculateExpressionValue(uint8_t* expression, uint32_t size, SPatch* patch, SSection* section, bool allowImports, int32_t* outValue,
-                         SSymbol** outSymbol, SSection** outSection) {
-	g_stackIndex = 0;
+isAbsoluteSymbol(const SSymbol* symbol) {
+	return symbol->section != NULL && (symbol->section->cpuLocation != -1 || symbol->section->group == NULL);
+}
 
-	while (size > 0) {
-		StackEntry left, right;
+static bool
+calculateExpressionValue(SEvaluationStack* stack, const SPatchInstruction* instruction, uint32_t totalInstructions,
+                         SPatch* patch, SSection* section, bool allowImports, int32_t* outValue, SSymbol** outSymbol,
+                         SSection** outSection) {
+	stack->index = 0;
 
-		--size;
+	for (; totalInstructions > 0; --totalInstructions, ++instruction) {
+		StackEntry left, right;
 
-		switch ((EExpressionOperator) *expression++) {
+		switch (instruction->operator) {
 			case OBJ_OP_SUB: {
-				popIntPair(&left, &right);
+				popIntPair(stack, &left, &right);
 				if (left.symbol == NULL && right.symbol == NULL)
-					pushInt(left.value - right.value);
+					pushInt(stack, left.value - right.value);
 				else if (left.symbol != NULL && right.symbol == NULL)
-					pushStackValue(NULL, left.symbol, left.value - right.value);
+					pushStackValue(stack, NULL, left.symbol, left.value - right.value);
 				else if (left.symbol != NULL && right.symbol != NULL && left.symbol->section == right.symbol->section)
-					pushInt(left.symbol->value - right.symbol->value);
+					pushInt(stack, left.symbol->value - right.symbol->value);
 				else if (patch != NULL && section != NULL) {
 					error(
 					    "Expression \"%s\" at offset %d in section \"%s\" attempts to subtract two values from different sections",
@@ -398,13 +482,13 @@ calculateExpressionValue(uint8_t* expression, uint32_t size, SPatch* patch, SSec
 				break;
 			}
 			case OBJ_OP_ADD: {
-				popIntPair(&left, &right);
+				popIntPair(stack, &left, &right);
 				if (left.symbol == NULL && right.symbol == NULL)
-					pushInt(left.value + right.value);
+					pushInt(stack, left.value + right.value);
 				else if (right.symbol == NULL)
-					pushStackValue(NULL, left.symbol, left.value + right.value);
+					pushStackValue(stack, NULL, left.symbol, left.value + right.value);
 				else if (left.symbol == NULL)
-					pushStackValue(NULL, right.symbol, left.value + right.value);
+					pushStackValue(stack, NULL, right.symbol, left.value + right.value);
 				else if (patch != NULL && section != NULL) {
 					error("Expression \"%s\" at offset %d in section \"%s\" attempts to add two values from different sections",
 					      makePatchString(patch, section), patch->offset, section->name);
@@ -412,103 +496,55 @@ calculateExpressionValue(uint8_t* expression, uint32_t size, SPatch* patch, SSec
 					error("Internal patch error");
 				break;
 			}
-			case OBJ_OP_XOR: {
-				combine_bitwise(left, right, ^);
-				break;
-			}
-			case OBJ_OP_OR: {
-				combine_bitwise(left, right, |);
-				break;
-			}
-			case OBJ_OP_AND: {
-				combine_bitwise(left, right, &);
-				break;
-			}
-			case OBJ_OP_ASL: {
-				combine_operator(left, right, <<);
-				break;
-			}
-			case OBJ_OP_ASR: {
-				combine_operator(left, right, >>);
-				break;
-			}
-			case OBJ_OP_MUL: {
-				combine_operator(left, right, *);
-				break;
-			}
-			case OBJ_OP_DIV: {
-				combine_operator(left, right, /);
-				break;
-			}
-			case OBJ_OP_MOD: {
-				combine_operator(left, right, %);
-				break;
-			}
-			case OBJ_OP_BOOLEAN_OR: {
-				combine_operator(left, right, ||);
-				break;
-			}
-			case OBJ_OP_BOOLEAN_AND: {
-				combine_operator(left, right, &&);
-				break;
-			}
-			case OBJ_OP_GREATER_OR_EQUAL: {
-				combine_operator(left, right, >=);
-				break;
-			}
-			case OBJ_OP_GREATER_THAN: {
-				combine_operator(left, right, >);
-				break;
-			}
-			case OBJ_OP_LESS_OR_EQUAL: {
-				combine_operator(left, right, <=);
-				break;
-			}
-			case OBJ_OP_LESS_THAN: {
-				combine_operator(left, right, <);
-				break;
-			}
-			case OBJ_OP_EQUALS: {
-				combine_operator(left, right, ==);
-				break;
-			}
-			case OBJ_OP_NOT_EQUALS: {
-				combine_operator(left, right, !=);
-				break;
-			}
-			case OBJ_OP_BOOLEAN_NOT: {
-				unary(left, !);
-				break;
-			}
-			case OBJ_FUNC_SIN: {
-				unary(left, fsin);
-				break;
-			}
-			case OBJ_FUNC_COS: {
-				unary(left, fcos);
-				break;
-			}
-			case OBJ_FUNC_TAN: {
-				unary(left, ftan);
-				break;
-			}
-			case OBJ_FUNC_ASIN: {
-				unary(left, fasin);
-				break;
-			}
-			case OBJ_FUNC_ACOS: {
-				unary(left, facos);
+			case OBJ_OP_XOR:
+			case OBJ_OP_OR:
+			case OBJ_OP_AND:
+			case OBJ_OP_ASL:
+			case OBJ_OP_ASR:
+			case OBJ_OP_MUL:
+			case OBJ_OP_DIV:
+			case OBJ_OP_MOD:
+			case OBJ_OP_BOOLEAN_OR:
+			case OBJ_OP_BOOLEAN_AND:
+			case OBJ_OP_GREATER_OR_EQUAL:
+			case OBJ_OP_GREATER_THAN:
+			case OBJ_OP_LESS_OR_EQUAL:
+			case OBJ_OP_LESS_THAN:
+			case OBJ_OP_EQUALS:
+			case OBJ_OP_NOT_EQUALS:
+			case OBJ_FUNC_FDIV:
+			case OBJ_FUNC_FMUL:
+			case OBJ_FUNC_ATAN2: {
+				popIntPair(stack, &left, &right);
+				if (left.symbol == NULL && right.symbol == NULL)
+					pushInt(stack, applyOperator(instruction->operator, left.value, right.value));
+				else
+					combineError(patch, section);
 				break;
 			}
+			case OBJ_OP_BOOLEAN_NOT:
+			case OBJ_FUNC_SIN:
+			case OBJ_FUNC_COS:
+			case OBJ_FUNC_TAN:
+			case OBJ_FUNC_ASIN:
+			case OBJ_FUNC_ACOS:
 			case OBJ_FUNC_ATAN: {
-				unary(left, fatan);
+				left = popInt(stack);
+				if (left.symbol == NULL)
+					pushInt(stack, applyOperator(instruction->operator, left.value, 0));
+				else if (patch != NULL && section != NULL) {
+					error("Expression \"%s\" at offset %d in section \"%s\" attempts to perform a unary operation on a value "
+					      "relative to a section",
+					      makePatchString(patch, section), patch->offset, section->name);
+				} else
+					error("Internal patch error");
 				break;
 			}
 			case OBJ_FUNC_LOW_LIMIT: {
-				popIntPair(&left, &right);
+				popIntPair(stack, &left, &right);
 
 				if (left.symbol == NULL && right.symbol == NULL && left.value >= right.value)
-					pushInt(left.value);
+					pushInt(stack, left.value);
 				else if (patch != NULL && section != NULL) {
 					error("Expression \"%s\" at offset %d in section \"%s\" out of range (%d must be >= %d)",
 					      makePatchString(patch, section), patch->offset, section->name, left.value, right.value);
@@ -517,10 +553,10 @@ calculateExpressionValue(uint8_t* expression, uint32_t size, SPatch* patch, SSec
 				break;
 			}
 			case OBJ_FUNC_HIGH_LIMIT: {
-				popIntPair(&left, &right);
+				popIntPair(stack, &left, &right);
 
 				if (left.symbol == NULL && right.symbol == NULL && left.value <= right.value)
-					pushInt(left.value);
+					pushInt(stack, left.value);
 				else if (patch != NULL && section != NULL) {
 					error("Expression \"%s\" at offset %d in section \"%s\" out of range (%d must be <= %d)",
 					      makePatchString(patch, section), patch->offset, section->name, left.value, right.value);
@@ -528,71 +564,37 @@ calculateExpressionValue(uint8_t* expression, uint32_t size, SPatch* patch, SSec
 					error("Internal patch error");
 				break;
 			}
-			case OBJ_FUNC_FDIV: {
-				combine_func(left, right, fdiv);
-				break;
-			}
-			case OBJ_FUNC_FMUL: {
-				combine_func(left, right, fmul);
-				break;
-			}
-			case OBJ_FUNC_ATAN2: {
-				combine_func(left, right, fatan2);
-				break;
-			}
 			case OBJ_CONSTANT: {
-				uint32_t value;
-
-				value = (*expression++);
-				value |= (*expression++) << 8u;
-				value |= (*expression++) << 16u;
-				value |= (*expression++) << 24u;
-
-				pushInt(value);
-
-				size -= 4;
+				pushInt(stack, instruction->value);
 				break;
 			}
 			case OBJ_SYMBOL: {
-				uint32_t symbolId;
-				SSymbol* symbol;
-
-				symbolId = (*expression++);
-				symbolId |= (*expression++) << 8u;
-				symbolId |= (*expression++) << 16u;
-				symbolId |= (*expression++) << 24u;
-
-				symbol = sect_GetSymbol(section, symbolId, allowImports);
-				if (symbol->section != NULL && (symbol->section->cpuLocation != -1 || symbol->section->group == NULL))
-					pushStackValue(NULL, NULL, symbol->value);
+				SSymbol* symbol = sect_ResolveSymbol(section, instruction->symbol, allowImports);
+				if (isAbsoluteSymbol(symbol))
+					pushStackValue(stack, NULL, NULL, symbol->value);
 				else
-					pushStackValue(NULL, symbol, 0);
-				size -= 4;
+					pushStackValue(stack, NULL, symbol, 0);
 				break;
 			}
 			case OBJ_FUNC_BANK: {
-				uint32_t symbolId;
 				int32_t bank;
-
-				symbolId = (*expression++);
-				symbolId |= (*expression++) << 8u;
-				symbolId |= (*expression++) << 16u;
-				symbolId |= (*expression++) << 24u;
-
-				if (!sect_GetConstantSymbolBank(section, symbolId, &bank))
+				if (!sect_GetConstantSymbolBank(section, instruction->symbol, &bank))
 					return false;
 
-				pushInt(bank);
-				size -= 4;
+				pushInt(stack, bank);
 				break;
 			}
 			case OBJ_PC_REL: {
-				combine_operator(left, right, +);
-				left = popInt();
-				if (left.symbol == NULL)
-					pushInt(left.value - (section->cpuLocation + patch->offset));
-				else if (left.symbol->section == section)
-					pushInt(left.symbol->value + left.value - patch->offset);
+				popIntPair(stack, &left, &right);
+				if (left.symbol != NULL && right.symbol != NULL)
+					combineError(patch, section);
+
+				SSymbol* symbol = left.symbol != NULL ? left.symbol : right.symbol;
+				int32_t value = left.value + right.value;
+				if (symbol == NULL)
+					pushInt(stack, value - (section->cpuLocation + patch->offset));
+				else if (symbol->section == section)
+					pushInt(stack, symbol->value + value - patch->offset);
 				else if (patch != NULL && section != NULL) {
 					error(
 					    "Illegal PC relative expression \"%s\" at offset %d in section \"%s\" attempts to subtract two values from "
@@ -603,10 +605,10 @@ calculateExpressionValue(uint8_t* expression, uint32_t size, SPatch* patch, SSec
 				break;
 			}
 			case OBJ_FUNC_ASSERT: {
-				popIntPair(&left, &right);
+				popIntPair(stack, &left, &right);
 
 				if (left.symbol == NULL && right.symbol == NULL && right.value != 0)
-					pushInt(left.value);
+					pushInt(stack, left.value);
 				else if (patch != NULL && section != NULL) {
 					error("Expression \"%s\" (=%d) at offset %d in section \"%s\" out of range", makePatchString(patch, section),
 					      left.value, patch->offset, section->name);
@@ -615,12 +617,12 @@ calculateExpressionValue(uint8_t* expression, uint32_t size, SPatch* patch, SSec
 				break;
 			}
 			case OBJ_GROUP_PROPERTY: {
-				popIntPair(&left, &right);
+				popIntPair(stack, &left, &right);
 
 				SSection* section;
 				int32_t value;
 				group_GetProperty(left.value, right.value, &section, &value);
-				pushStackValue(section, NULL, value);
+				pushStackValue(stack, section, NULL, value);
 				break;
 			}
 			default: {
@@ -630,7 +632,7 @@ calculateExpressionValue(uint8_t* expression, uint32_t size, SPatch* patch, SSec
 		}
 	}
 
-	StackEntry entry = popInt();
+	StackEntry entry = popInt(stack);
 
 	if (outValue != NULL)
 		*outValue = entry.value;
@@ -641,15 +643,212 @@ calculateExpressionValue(uint8_t* expression, uint32_t size, SPatch* patch, SSec
 	if (outSection != NULL)
 		*outSection = entry.section;
 
-	return g_stackIndex == 0;
+	return stack->index == 0;
 }
 
 static bool
-calculatePatchValue(SPatch* patch, SSection* section, bool allowImports, int32_t* outValue, SSymbol** outSymbol) {
-	int32_t size = patch->expressionSize;
-	uint8_t* expression = patch->expression;
+calculatePatchValue(SEvaluationStack* stack, SPatch* patch, SSection* section, bool allowImports, int32_t* outValue,
+                    SSymbol** outSymbol) {
+	const SPatchInstruction* instructions = patch->instructions;
+
+	switch (patch->shape) {
+		case PATCH_SHAPE_CONSTANT: {
+			*outValue = instructions[0].value;
+			*outSymbol = NULL;
+			return true;
+		}
+		case PATCH_SHAPE_SYMBOL:
+		case PATCH_SHAPE_SYMBOL_OFFSET: {
+			SSymbol* symbol = sect_ResolveSymbol(section, instructions[0].symbol, allowImports);
+			int32_t offset = patch->shape == PATCH_SHAPE_SYMBOL_OFFSET ? instructions[1].value : 0;
+			if (isAbsoluteSymbol(symbol)) {
+				*outValue = symbol->value + offset;
+				*outSymbol = NULL;
+			} else {
+				*outValue = offset;
+				*outSymbol = symbol;
+			}
+			return true;
+		}
+		case PATCH_SHAPE_PC_RELATIVE: {
+			SSymbol* symbol = sect_ResolveSymbol(section, instructions[0].symbol, allowImports);
+			if (isAbsoluteSymbol(symbol)) {
+				*outValue = symbol->value + instructions[1].value - (section->cpuLocation + patch->offset);
+				*outSymbol = NULL;
+				return true;
+			} else if (symbol->section == section) {
+				*outValue = symbol->value + instructions[1].value - patch->offset;
+				*outSymbol = NULL;
+				return true;
+			}
+			break;
+		}
+		case PATCH_SHAPE_GENERAL: {
+			break;
+		}
+	}
+
+	return calculateExpressionValue(stack, instructions, patch->totalInstructions, patch, section, allowImports, outValue,
+	                                outSymbol, NULL);
+}
+
+typedef struct {
+	bool constant;
+	int32_t value;
+	uint32_t firstInstruction;
+} SCompileEntry;
+
+//	Returns the number of values an operator takes from the stack, or -1 if the operator is unknown
+static int
+totalOperands(EExpressionOperator operator) {
+	switch (operator) {
+		case OBJ_CONSTANT:
+		case OBJ_SYMBOL:
+		case OBJ_FUNC_BANK:
+			return 0;
+		case OBJ_OP_BOOLEAN_NOT:
+		case OBJ_FUNC_SIN:
+		case OBJ_FUNC_COS:
+		case OBJ_FUNC_TAN:
+		case OBJ_FUNC_ASIN:
+		case OBJ_FUNC_ACOS:
+		case OBJ_FUNC_ATAN:
+			return 1;
+		case OBJ_OP_SUB:
+		case OBJ_OP_ADD:
+		case OBJ_OP_XOR:
+		case OBJ_OP_OR:
+		case OBJ_OP_AND:
+		case OBJ_OP_ASL:
+		case OBJ_OP_ASR:
+		case OBJ_OP_MUL:
+		case OBJ_OP_DIV:
+		case OBJ_OP_MOD:
+		case OBJ_OP_BOOLEAN_OR:
+		case OBJ_OP_BOOLEAN_AND:
+		case OBJ_OP_GREATER_OR_EQUAL:
+		case OBJ_OP_GREATER_THAN:
+		case OBJ_OP_LESS_OR_EQUAL:
+		case OBJ_OP_LESS_THAN:
+		case OBJ_OP_EQUALS:
+		case OBJ_OP_NOT_EQUALS:
+		case OBJ_FUNC_LOW_LIMIT:
+		case OBJ_FUNC_HIGH_LIMIT:
+		case OBJ_FUNC_FDIV:
+		case OBJ_FUNC_FMUL:
+		case OBJ_FUNC_ATAN2:
+		case OBJ_PC_REL:
+		case OBJ_FUNC_ASSERT:
+		case OBJ_GROUP_PROPERTY:
+			return 2;
+	}
+
+	return -1;
+}
+
+static SSymbol*
+compileSymbol(SSection* section, uint32_t symbolId) {
+	if (section == NULL || symbolId >= section->totalSymbols)
+		error("Symbol ID out of range");
+
+	return &section->symbols[symbolId];
+}
+
+//	Converts an expression to instructions, replacing operators applied to constants with their value. Returns the
+//	number of instructions, which is never more than the size of the expression.
+static uint32_t
+compileExpression(const uint8_t* expression, uint32_t size, SSection* section, SPatchInstruction* instructions) {
+	SCompileEntry stack[STACKSIZE];
+	uint32_t stackIndex = 0;
+	uint32_t totalInstructions = 0;
+	bool canFold = true;
+
+	while (size-- > 0) {
+		EExpressionOperator operator = (EExpressionOperator) *expression++;
+		int operands = totalOperands(operator);
+
+		SPatchInstruction* instruction = &instructions[totalInstructions];
+		instruction->operator = operator;
+		instruction->value = 0;
+		instruction->symbol = NULL;
+
+		if (operands == 0) {
+			if (size < 4)
+				error("mangled patch");
+
+			uint32_t operand = expression[0] | expression[1] << 8u | expression[2] << 16u | (uint32_t) expression[3] << 24u;
+			expression += 4;
+			size -= 4;
+
+			if (operator == OBJ_CONSTANT)
+				instruction->value = (int32_t) operand;
+			else
+				instruction->symbol = compileSymbol(section, operand);
+		}
+
+		if (canFold && (operands < 0 || stackIndex < (uint32_t) operands)) {
+			//	Mangled, leave it for the evaluation to report
+			canFold = false;
+		}
+
+		if (!canFold) {
+			++totalInstructions;
+			continue;
+		}
+
+		uint32_t firstInstruction = totalInstructions;
+		int32_t value = instruction->value;
+
+		if (operands > 0) {
+			SCompileEntry* left = &stack[stackIndex - operands];
+			SCompileEntry* right = &stack[stackIndex - 1];
 
-	return calculateExpressionValue(expression, size, patch, section, allowImports, outValue, outSymbol, NULL);
+			firstInstruction = left->firstInstruction;
+			if (left->constant && right->constant &&
+			    foldConstants(operator, left->value, operands == 2 ? right->value : 0, &value)) {
+				totalInstructions = firstInstruction;
+				instruction = &instructions[totalInstructions];
+				instruction->operator = OBJ_CONSTANT;
+				instruction->value = value;
+			}
+			stackIndex -= operands;
+		}
+
+		if (stackIndex < STACKSIZE) {
+			SCompileEntry entry = {instruction->operator == OBJ_CONSTANT, value, firstInstruction};
+			stack[stackIndex++] = entry;
+		} else {
+			canFold = false;
+		}
+
+		++totalInstructions;
+	}
+
+	return totalInstructions;
+}
+
+//	Recognises the expressions that can be evaluated without the stack. The operands of addition may be swapped, the
+//	result is the same.
+static EPatchShape
+getShape(SPatchInstruction* instructions, uint32_t totalInstructions) {
+	if (totalInstructions == 1 && instructions[0].operator == OBJ_CONSTANT)
+		return PATCH_SHAPE_CONSTANT;
+
+	if (totalInstructions == 1 && instructions[0].operator == OBJ_SYMBOL)
+		return PATCH_SHAPE_SYMBOL;
+
+	if (totalInstructions == 3 && (instructions[2].operator == OBJ_OP_ADD || instructions[2].operator == OBJ_PC_REL)) {
+		if (instructions[0].operator == OBJ_CONSTANT && instructions[1].operator == OBJ_SYMBOL) {
+			SPatchInstruction constant = instructions[0];
+			instructions[0] = instructions[1];
+			instructions[1] = constant;
+		}
+
+		if (instructions[0].operator == OBJ_SYMBOL && instructions[1].operator == OBJ_CONSTANT)
+			return instructions[2].operator == OBJ_OP_ADD ? PATCH_SHAPE_SYMBOL_OFFSET : PATCH_SHAPE_PC_RELATIVE;
+	}
+
+	return PATCH_SHAPE_GENERAL;
 }
 
 static void
@@ -657,13 +856,18 @@ patchSection(SSection* section, bool allowReloc, bool onlySectionRelativeReloc,
 	SPatches* patches = section->patches;
 
 	if (patches != NULL) {
+		SEvaluationStack stack;
 		SPatch* patch = patches->patches;
 
 		for (uint32_t i = patches->totalPatches; i > 0; --i, ++patch) {
 			SSymbol* valueSymbol;
 			int32_t value;
 
-			if (calculatePatchValue(patch, section, allowImports, &value, &valueSymbol)) {
+			//	Relocations taken from the link cache have already been applied
+			if (patch->type == PATCH_RELOC)
+				continue;
+
+			if (calculatePatchValue(&stack, patch, section, allowImports, &value, &valueSymbol)) {
 				if (valueSymbol != NULL) {
 					if (!allowReloc) {
 						error("Expression \"%s\" at offset %d in section \"%s\" is relocatable", makePatchString(patch, section),
@@ -732,7 +936,8 @@ patchSection(SSection* section, bool allowReloc, bool onlySectionRelativeReloc,
 						break;
 					}
 				}
-				mem_Free(patch->expression);
+				if (patch->ownsExpression)
+					mem_Free(patch->expression);
 
 				if (allowReloc) {
 					patch->type = PATCH_RELOC;
@@ -744,6 +949,8 @@ patchSection(SSection* section, bool allowReloc, bool onlySectionRelativeReloc,
 				}
 				patch->expression = NULL;
 				patch->expressionSize = 0;
+				patch->instructions = NULL;
+				patch->totalInstructions = 0;
 			}
 		}
 	}
@@ -752,15 +959,63 @@ patchSection(SSection* section, bool allowReloc, bool onlySectionRelativeReloc,
 extern bool
 patch_EvaluateExpression(uint8_t* expression, uint32_t expressionSize, int32_t* outValue, SSymbol** outSymbol,
                          SSection** outSection) {
-	return calculateExpressionValue(expression, expressionSize, NULL, NULL, true, outValue, outSymbol, outSection);
+	SEvaluationStack stack;
+	SPatchInstruction* instructions = mem_Alloc(expressionSize * sizeof(SPatchInstruction));
+	uint32_t totalInstructions = compileExpression(expression, expressionSize, NULL, instructions);
+
+	bool result = calculateExpressionValue(&stack, instructions, totalInstructions, NULL, NULL, true, outValue, outSymbol,
+	                                       outSection);
+
+	mem_Free(instructions);
+	return result;
+}
+
+typedef struct {
+	SSection** sections;
+	bool allowReloc;
+	bool onlySectionRelativeReloc;
+	bool allowImports;
+} SPatchJobs;
+
+static void
+patchSectionJob(uint32_t index, void* data) {
+	SPatchJobs* jobs = (SPatchJobs*) data;
+	patchSection(jobs->sections[index], jobs->allowReloc, jobs->onlySectionRelativeReloc, jobs->allowImports);
 }
 
 extern void
-patch_Process(bool allowReloc, bool onlySectionRelativeReloc, bool allowImports) {
+patch_Process(bool allowReloc, bool onlySectionRelativeReloc, bool allowImports, uint32_t totalThreads) {
+	if (totalThreads <= 1) {
+		for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+			if (section->used)
+				patchSection(section, allowReloc, onlySectionRelativeReloc, allowImports);
+		}
+		return;
+	}
+
+	//	Symbols are otherwise resolved when first used, resolve them up front so the threads only read them
+	sect_ResolveUnresolved();
+
+	uint32_t totalSections = 0;
+	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
+		if (section->used)
+			++totalSections;
+	}
+
+	if (totalSections == 0)
+		return;
+
+	SPatchJobs jobs = {mem_Alloc(totalSections * sizeof(SSection*)), allowReloc, onlySectionRelativeReloc, allowImports};
+
+	uint32_t index = 0;
 	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
 		if (section->used)
-			patchSection(section, allowReloc, onlySectionRelativeReloc, allowImports);
+			jobs.sections[index++] = section;
 	}
+
+	parallel_For(totalSections, totalThreads, patchSectionJob, &jobs);
+
+	mem_Free(jobs.sections);
 }
 
 extern SPatches*
@@ -768,7 +1023,33 @@ patch_Alloc(uint32_t totalPatches) {
 	SPatches* patches = mem_Alloc(sizeof(SPatches) + totalPatches * sizeof(SPatch));
 	if (patches != NULL) {
 		patches->totalPatches = totalPatches;
+		patches->instructions = NULL;
 	}
 
 	return patches;
 }
+
+extern void
+patch_Compile(SSection* section) {
+	SPatches* patches = section->patches;
+	if (patches == NULL)
+		return;
+
+	uint32_t totalSize = 0;
+	for (uint32_t i = 0; i < patches->totalPatches; ++i)
+		totalSize += patches->patches[i].expressionSize;
+
+	if (totalSize > 0)
+		patches->instructions = mem_Alloc(totalSize * sizeof(SPatchInstruction));
+
+	SPatchInstruction* instructions = patches->instructions;
+	for (uint32_t i = 0; i < patches->totalPatches; ++i) {
+		SPatch* patch = &patches->patches[i];
+
+		patch->instructions = instructions;
+		patch->totalInstructions = compileExpression(patch->expression, patch->expressionSize, section, instructions);
+		patch->shape = getShape(instructions, patch->totalInstructions);
+
+		instructions += patch->totalInstructions;
+	}
+}
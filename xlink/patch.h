@@ -76,6 +76,21 @@ typedef enum {
 	PROP_SIZE
 } ESymbolProperty;
 
+typedef enum {
+	PATCH_SHAPE_GENERAL,
+	PATCH_SHAPE_CONSTANT,
+	PATCH_SHAPE_SYMBOL,
+	PATCH_SHAPE_SYMBOL_OFFSET,
+	PATCH_SHAPE_PC_RELATIVE
+} EPatchShape;
+
+//	An expression operator with its operand decoded. Symbols point into the patched section's symbols.
+typedef struct {
+	EExpressionOperator operator;
+	int32_t value;
+	struct Symbol* symbol;
+} SPatchInstruction;
+
 typedef struct {
 	EPatchType type;
 
@@ -86,10 +101,16 @@ typedef struct {
 
 	uint32_t expressionSize;
 	uint8_t* expression;
+	bool ownsExpression; // False when the expression points into a mapped object file
+
+	EPatchShape shape;
+	uint32_t totalInstructions;
+	SPatchInstruction* instructions; // The expression, compiled by patch_Compile
 } SPatch;
 
 typedef struct Patches {
 	uint32_t totalPatches;
+	SPatchInstruction* instructions; // Shared by the patches
 	SPatch patches[];
 } SPatches;
 
@@ -99,10 +120,15 @@ extern bool
 patch_EvaluateExpression(uint8_t* expression, uint32_t expressionSize, int32_t* outValue, struct Symbol** outSymbol,
                          struct Section** outSection);
 
+//	Patches the used sections on up to totalThreads threads
 extern void
-patch_Process(bool allowReloc, bool onlySectionRelativeReloc, bool allowImports);
+patch_Process(bool allowReloc, bool onlySectionRelativeReloc, bool allowImports, uint32_t totalThreads);
 
 extern SPatches*
 patch_Alloc(uint32_t totalPatches);
 
+//	Compiles the expressions of a section's patches once its symbols are known
+extern void
+patch_Compile(struct Section* section);
+
 #endif
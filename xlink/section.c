@@ -16,11 +16,13 @@
     along with ASMotor.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <assert.h>
 #include <string.h>
 
 #include "mem.h"
 #include "strbuf.h"
 
+#include "intern.h"
 #include "object.h"
 #include "patch.h"
 #include "section.h"
@@ -28,10 +30,178 @@
 
 #include "xlink.h"
 
+#define INDEX_END UINT32_MAX
+
+typedef struct SymbolIndexEntry {
+	uint32_t hash;
+	uint32_t nextEntry;
+	SSection* section;
+	SSymbol* symbol;
+	SSection* duplicateSection; // Another section exporting the symbol, NULL if none
+} SSymbolIndexEntry;
+
+typedef struct SymbolIndex {
+	uint32_t bucketMask;
+	uint32_t* buckets;
+	uint32_t totalEntries;
+	uint32_t allocatedEntries;
+	SSymbolIndexEntry* entries;
+} SSymbolIndex;
+
+typedef struct DuplicateExport {
+	uint32_t entry;
+	SSection* section;
+} SDuplicateExport;
+
 SSection* sect_Sections = NULL;
 
 static uint32_t g_sectionId = 0;
 
+//	Symbols visible to all files (SYM_EXPORT and SYM_LINKER), keyed by name
+static SSymbolIndex g_exportIndex;
+
+//	Symbols visible within a single file (SYM_LOCALEXPORT and SYM_EXPORT), keyed by file ID and name
+static SSymbolIndex g_localExportIndex;
+
+//	The last section added to the indices, sections following it have not been indexed yet
+static SSection* g_lastIndexedSection = NULL;
+
+//	Exports of a name already in the export index, only an error if the symbol is needed
+static SDuplicateExport* g_duplicateExports = NULL;
+static uint32_t g_totalDuplicateExports = 0;
+static uint32_t g_allocatedDuplicateExports = 0;
+
+static uint32_t
+hashLocalName(const char* name, uint32_t fileId) {
+	return intern_Hash(name) ^ (fileId * 2654435761u);
+}
+
+static bool
+isGlobalExport(const SSymbol* symbol) {
+	return symbol->type == SYM_EXPORT || symbol->type == SYM_LINKER;
+}
+
+static bool
+isLocalExport(const SSymbol* symbol) {
+	return symbol->type == SYM_LOCALEXPORT || symbol->type == SYM_EXPORT;
+}
+
+static void
+growSymbolIndex(SSymbolIndex* index, uint32_t additionalEntries) {
+	uint32_t totalEntries = index->totalEntries + additionalEntries;
+
+	//	The index grows each time a library module is read, the capacity is doubled to keep that linear
+	if (totalEntries > index->allocatedEntries || index->entries == NULL) {
+		uint32_t allocatedEntries = index->allocatedEntries > 0 ? index->allocatedEntries * 2 : 64;
+		while (allocatedEntries < totalEntries)
+			allocatedEntries *= 2;
+
+		index->entries = (SSymbolIndexEntry*) mem_Realloc(index->entries, sizeof(SSymbolIndexEntry) * allocatedEntries);
+		if (index->entries == NULL)
+			error("Out of memory");
+
+		index->allocatedEntries = allocatedEntries;
+	}
+
+	if (index->buckets != NULL && index->bucketMask + 1 >= totalEntries * 2)
+		return;
+
+	uint32_t totalBuckets = 16;
+	while (totalBuckets < totalEntries * 2)
+		totalBuckets <<= 1;
+
+	mem_Free(index->buckets);
+	index->bucketMask = totalBuckets - 1;
+	index->buckets = (uint32_t*) mem_Alloc(sizeof(uint32_t) * totalBuckets);
+	if (index->buckets == NULL)
+		error("Out of memory");
+
+	for (uint32_t i = 0; i < totalBuckets; ++i)
+		index->buckets[i] = INDEX_END;
+
+	for (uint32_t i = 0; i < index->totalEntries; ++i) {
+		uint32_t* bucket = &index->buckets[index->entries[i].hash & index->bucketMask];
+		index->entries[i].nextEntry = *bucket;
+		*bucket = i;
+	}
+}
+
+static SSymbolIndexEntry*
+findIndexEntry(const SSymbolIndex* index, uint32_t hash, const char* name, uint32_t fileId, bool matchFileId) {
+	assert(index->buckets != NULL);
+
+	for (uint32_t i = index->buckets[hash & index->bucketMask]; i != INDEX_END; i = index->entries[i].nextEntry) {
+		SSymbolIndexEntry* entry = &index->entries[i];
+		if (entry->symbol->name == name && (!matchFileId || entry->section->fileId == fileId)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+insertIndexEntry(SSymbolIndex* index, uint32_t hash, SSection* section, SSymbol* symbol) {
+	uint32_t* bucket = &index->buckets[hash & index->bucketMask];
+	SSymbolIndexEntry* entry = &index->entries[index->totalEntries];
+
+	entry->hash = hash;
+	entry->nextEntry = *bucket;
+	entry->section = section;
+	entry->symbol = symbol;
+	entry->duplicateSection = NULL;
+
+	*bucket = index->totalEntries++;
+}
+
+static void
+addDuplicateExport(SSymbolIndexEntry* entry, SSection* section) {
+	if (entry->duplicateSection == NULL)
+		entry->duplicateSection = section;
+
+	if (g_totalDuplicateExports == g_allocatedDuplicateExports) {
+		g_allocatedDuplicateExports = g_allocatedDuplicateExports == 0 ? 16 : g_allocatedDuplicateExports * 2;
+		g_duplicateExports =
+		    (SDuplicateExport*) mem_Realloc(g_duplicateExports, sizeof(SDuplicateExport) * g_allocatedDuplicateExports);
+		if (g_duplicateExports == NULL)
+			error("Out of memory");
+	}
+
+	SDuplicateExport* duplicate = &g_duplicateExports[g_totalDuplicateExports++];
+	duplicate->entry = (uint32_t) (entry - g_exportIndex.entries);
+	duplicate->section = section;
+}
+
+static void
+reportDuplicateExport(const SSymbolIndexEntry* entry, const SSection* section) {
+	error("Symbol \"%s\" exported by both section \"%s\" and \"%s\"", entry->symbol->name, entry->section->name,
+	      section->name);
+}
+
+//	Returns the export of a name without checking that it is unique
+static SSymbolIndexEntry*
+lookupExport(const char* name) {
+	return findIndexEntry(&g_exportIndex, intern_Hash(name), name, 0, false);
+}
+
+//	Returns the export of a name that is needed by the link, which must be unique
+static SSymbolIndexEntry*
+findExport(const char* name) {
+	SSymbolIndexEntry* entry = lookupExport(name);
+	if (entry != NULL && entry->duplicateSection != NULL)
+		reportDuplicateExport(entry, entry->duplicateSection);
+
+	return entry;
+}
+
+static SSymbolIndexEntry*
+findLocalExport(const char* name, uint32_t fileId) {
+	return findIndexEntry(&g_localExportIndex, hashLocalName(name, fileId), name, fileId, true);
+}
+
+static void
+resolveFromExport(SSymbol* symbol, SSection* definingSection, SSymbol* exportedSymbol, bool allowImports);
+
 static void
 resolveSymbol(SSection* section, SSymbol* symbol, bool allowImports) {
 	switch (symbol->type) {
@@ -48,28 +218,10 @@ resolveSymbol(SSection* section, SSymbol* symbol, bool allowImports) {
 		}
 
 		case SYM_IMPORT: {
-			SSection* definingSection;
-
-			for (definingSection = sect_Sections; definingSection != NULL; definingSection = definingSection->nextSection) {
-				if (definingSection->used || definingSection->group == NULL) {
-					uint32_t i;
-					SSymbol* exportedSymbol = definingSection->symbols;
-
-					for (i = 0; i < definingSection->totalSymbols; ++i, ++exportedSymbol) {
-						if (exportedSymbol->type == SYM_EXPORT && strcmp(exportedSymbol->name, symbol->name) == 0) {
-							if (!exportedSymbol->resolved)
-								resolveSymbol(definingSection, exportedSymbol, allowImports);
-
-							symbol->resolved = true;
-							symbol->value = exportedSymbol->value;
-							symbol->section = definingSection;
-							symbol->fileInfoIndex = exportedSymbol->fileInfoIndex;
-							symbol->lineNumber = exportedSymbol->lineNumber;
-
-							return;
-						}
-					}
-				}
+			SSymbolIndexEntry* entry = findExport(symbol->name);
+			if (entry != NULL && (entry->section->used || entry->section->group == NULL)) {
+				resolveFromExport(symbol, entry->section, entry->symbol, allowImports);
+				return;
 			}
 
 			if (!allowImports)
@@ -79,27 +231,10 @@ resolveSymbol(SSection* section, SSymbol* symbol, bool allowImports) {
 		}
 
 		case SYM_LOCALIMPORT: {
-			for (SSection* definingSection = sect_Sections; definingSection != NULL;
-			     definingSection = definingSection->nextSection) {
-				if (definingSection->used && definingSection->fileId == section->fileId) {
-					SSymbol* exportedSymbol = definingSection->symbols;
-
-					for (uint32_t i = 0; i < definingSection->totalSymbols; ++i, ++exportedSymbol) {
-						if ((exportedSymbol->type == SYM_LOCALEXPORT || exportedSymbol->type == SYM_EXPORT) &&
-						    strcmp(exportedSymbol->name, symbol->name) == 0) {
-							if (!exportedSymbol->resolved)
-								resolveSymbol(definingSection, exportedSymbol, allowImports);
-
-							symbol->resolved = true;
-							symbol->value = exportedSymbol->value;
-							symbol->section = definingSection;
-							symbol->fileInfoIndex = exportedSymbol->fileInfoIndex;
-							symbol->lineNumber = exportedSymbol->lineNumber;
-
-							return;
-						}
-					}
-				}
+			SSymbolIndexEntry* entry = findLocalExport(symbol->name, section->fileId);
+			if (entry != NULL && entry->section->used) {
+				resolveFromExport(symbol, entry->section, entry->symbol, allowImports);
+				return;
 			}
 
 			error("Unresolved symbol \"%s\"", symbol->name);
@@ -122,6 +257,18 @@ resolveSymbol(SSection* section, SSymbol* symbol, bool allowImports) {
 	}
 }
 
+static void
+resolveFromExport(SSymbol* symbol, SSection* definingSection, SSymbol* exportedSymbol, bool allowImports) {
+	if (!exportedSymbol->resolved)
+		resolveSymbol(definingSection, exportedSymbol, allowImports);
+
+	symbol->resolved = true;
+	symbol->value = exportedSymbol->value;
+	symbol->section = definingSection;
+	symbol->fileInfoIndex = exportedSymbol->fileInfoIndex;
+	symbol->lineNumber = exportedSymbol->lineNumber;
+}
+
 static void
 resolveUnresolvedSymbols(SSection* section, intptr_t data) {
 	for (uint32_t i = 0; i < section->totalSymbols; ++i) {
@@ -163,17 +310,6 @@ compareSections(const void* element1, const void* element2) {
 	return section1->cpuLocation - section2->cpuLocation;
 }
 
-static SSymbol*
-sectionHasSymbol(SSection* section, const char* symbolName, ESymbolType symbolType) {
-	for (uint32_t i = 0; i < section->totalSymbols; ++i) {
-		SSymbol* symbol = &section->symbols[i];
-		if (symbol->type == symbolType && strcmp(symbol->name, symbolName) == 0)
-			return symbol;
-	}
-
-	return NULL;
-}
-
 static SSection*
 findSectionContainingAddress(int32_t value, uint32_t fileId) {
 	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
@@ -187,20 +323,14 @@ findSectionContainingAddress(int32_t value, uint32_t fileId) {
 /* Exported functions */
 
 extern SSymbol*
-sect_GetSymbol(SSection* section, uint32_t symbolId, bool allowImports) {
-	if (symbolId >= section->totalSymbols) {
-		error("Symbol ID out of range");
-	} else {
-		SSymbol* symbol = &section->symbols[symbolId];
-
-		if (!symbol->resolved)
-			resolveSymbol(section, symbol, allowImports);
+sect_ResolveSymbol(SSection* section, SSymbol* symbol, bool allowImports) {
+	if (!symbol->resolved)
+		resolveSymbol(section, symbol, allowImports);
 
-		return symbol;
-	}
+	return symbol;
 }
 
-extern char*
+extern const char*
 sect_GetSymbolName(SSection* section, uint32_t symbolId) {
 	SSymbol* symbol = &section->symbols[symbolId];
 
@@ -208,9 +338,7 @@ sect_GetSymbolName(SSection* section, uint32_t symbolId) {
 }
 
 extern bool
-sect_GetConstantSymbolBank(SSection* section, uint32_t symbolId, int32_t* outValue) {
-	SSymbol* symbol = &section->symbols[symbolId];
-
+sect_GetConstantSymbolBank(SSection* section, SSymbol* symbol, int32_t* outValue) {
 	if (!symbol->resolved)
 		resolveSymbol(section, symbol, false);
 
@@ -252,6 +380,8 @@ sect_CreateNew(void) {
 	memset(*section, 0, sizeof(SSection));
 
 	(*section)->sectionId = g_sectionId++;
+	(*section)->fileId = UINT32_MAX;
+	(*section)->name = intern_String("");
 	(*section)->nextSection = NULL;
 	(*section)->used = false;
 	(*section)->assigned = false;
@@ -282,45 +412,89 @@ sect_IsEquSection(SSection* section) {
 	return section->group == NULL;
 }
 
-extern SSymbol*
-sect_FindExportedSymbol(const char* symbolName) {
-	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
-		SSymbol* symbol = sectionHasSymbol(section, symbolName, SYM_EXPORT);
-		symbol = symbol != NULL ? symbol : sectionHasSymbol(section, symbolName, SYM_LINKER);
-		if (symbol != NULL) {
-			return symbol;
+extern void
+sect_BuildSymbolIndex(void) {
+	SSection* firstSection = g_lastIndexedSection != NULL ? g_lastIndexedSection->nextSection : sect_Sections;
+	uint32_t totalExports = 0;
+	uint32_t totalLocalExports = 0;
+
+	for (SSection* section = firstSection; section != NULL; section = section->nextSection) {
+		for (uint32_t i = 0; i < section->totalSymbols; ++i) {
+			const SSymbol* symbol = &section->symbols[i];
+			if (isGlobalExport(symbol))
+				++totalExports;
+			if (isLocalExport(symbol))
+				++totalLocalExports;
 		}
 	}
-	return NULL;
+
+	growSymbolIndex(&g_exportIndex, totalExports);
+	growSymbolIndex(&g_localExportIndex, totalLocalExports);
+
+	for (SSection* section = firstSection; section != NULL; section = section->nextSection) {
+		for (uint32_t i = 0; i < section->totalSymbols; ++i) {
+			SSymbol* symbol = &section->symbols[i];
+
+			if (isGlobalExport(symbol)) {
+				SSymbolIndexEntry* existing = lookupExport(symbol->name);
+				if (existing != NULL)
+					addDuplicateExport(existing, section);
+				else
+					insertIndexEntry(&g_exportIndex, intern_Hash(symbol->name), section, symbol);
+			}
+
+			//	The first definition in a file wins, as it would when scanning the sections in order
+			if (isLocalExport(symbol) && findLocalExport(symbol->name, section->fileId) == NULL) {
+				insertIndexEntry(&g_localExportIndex, hashLocalName(symbol->name, section->fileId), section, symbol);
+			}
+		}
+		g_lastIndexedSection = section;
+	}
+}
+
+extern void
+sect_CheckDuplicateExports(void) {
+	for (uint32_t i = 0; i < g_totalDuplicateExports; ++i) {
+		const SDuplicateExport* duplicate = &g_duplicateExports[i];
+		const SSymbolIndexEntry* entry = &g_exportIndex.entries[duplicate->entry];
+		if (entry->section->used || duplicate->section->used)
+			reportDuplicateExport(entry, duplicate->section);
+	}
+}
+
+extern bool
+sect_HasExportedSymbol(const char* symbolName) {
+	return lookupExport(intern_String(symbolName)) != NULL;
+}
+
+extern SSymbol*
+sect_FindExportedSymbol(const char* symbolName) {
+	SSymbolIndexEntry* entry = findExport(intern_String(symbolName));
+	return entry != NULL ? entry->symbol : NULL;
 }
 
 extern SSection*
 sect_FindSectionWithExportedSymbol(const char* symbolName) {
-	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
-		SSymbol* symbol = sectionHasSymbol(section, symbolName, SYM_EXPORT);
-		symbol = symbol != NULL ? symbol : sectionHasSymbol(section, symbolName, SYM_LINKER);
-		if (symbol != NULL) {
-			if (symbol->section == NULL && sect_IsEquSection(section)) {
-				return findSectionContainingAddress(symbol->value, section->fileId);
-			}
-			return symbol->section != NULL ? symbol->section : section;
+	SSymbolIndexEntry* entry = findExport(intern_String(symbolName));
+	if (entry != NULL) {
+		SSymbol* symbol = entry->symbol;
+		SSection* section = entry->section;
+		if (symbol->section == NULL && sect_IsEquSection(section)) {
+			return findSectionContainingAddress(symbol->value, section->fileId);
 		}
+		return symbol->section != NULL ? symbol->section : section;
 	}
 	return NULL;
 }
 
 extern SSection*
 sect_FindSectionWithLocallyExportedSymbol(const char* symbolName, uint32_t fileId) {
-	for (SSection* section = sect_Sections; section != NULL; section = section->nextSection) {
-		if (section->fileId == fileId) {
-			SSymbol* symbol = sectionHasSymbol(section, symbolName, SYM_LOCALEXPORT);
-			if (symbol != NULL) {
-				if (sect_IsEquSection(section)) {
-					return findSectionContainingAddress(symbol->value, section->fileId);
-				}
-				return section;
-			}
+	SSymbolIndexEntry* entry = findLocalExport(intern_String(symbolName), fileId);
+	if (entry != NULL && entry->symbol->type == SYM_LOCALEXPORT) {
+		if (sect_IsEquSection(entry->section)) {
+			return findSectionContainingAddress(entry->symbol->value, fileId);
 		}
+		return entry->section;
 	}
 	return sect_FindSectionWithExportedSymbol(symbolName);
 }
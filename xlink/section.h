@@ -57,7 +57,7 @@ typedef struct Section {
 	int32_t page;
 	bool root;
 
-	char name[MAX_SYMBOL_NAME_LENGTH];
+	const char* name; // Interned
 
 	uint32_t totalSymbols;
 	SSymbol* symbols;
@@ -81,13 +81,14 @@ extern SSection* sect_Sections;
 extern SSection*
 sect_CreateNew(void);
 
+//	Resolves one of the section's symbols, if not already resolved
 extern SSymbol*
-sect_GetSymbol(SSection* section, uint32_t symbolId, bool allowImports);
+sect_ResolveSymbol(SSection* section, SSymbol* symbol, bool allowImports);
 
 extern bool
-sect_GetConstantSymbolBank(SSection* section, uint32_t symbolId, int32_t* outValue);
+sect_GetConstantSymbolBank(SSection* section, SSymbol* symbol, int32_t* outValue);
 
-extern char*
+extern const char*
 sect_GetSymbolName(SSection* section, uint32_t symbolId);
 
 extern void
@@ -99,6 +100,21 @@ sect_TotalSections(void);
 extern void
 sect_SortSections(void);
 
+//	Adds the sections created since the previous call to the symbol index. Must be called once all object files have been
+//	read, and before any symbols are resolved or looked up
+extern void
+sect_BuildSymbolIndex(void);
+
+//	Reports a symbol exported by more than one section when one of them is used. Must be called once it is known which
+//	sections are used
+extern void
+sect_CheckDuplicateExports(void);
+
+//	Returns true if the symbol is exported, even if more than one section exports it
+extern bool
+sect_HasExportedSymbol(const char* symbol);
+
+//	Returns the exported symbol, which must be exported by a single section
 extern SSymbol*
 sect_FindExportedSymbol(const char* symbol);
 
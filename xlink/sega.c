@@ -17,75 +17,64 @@
 */
 
 #include <stdint.h>
-#include <stdio.h>
-
-#include "file.h"
+#include <string.h>
 
 #include "image.h"
 #include "xlink.h"
 
+#define MEGA_DRIVE_HEADER_END 0x200U
+
 static uint16_t
-sega_CalcMegaDriveChecksum(FILE* fileHandle, size_t length) {
+sega_CalcMegaDriveChecksum(const SImage* image, uint32_t length) {
 	uint16_t r = 0;
-	size_t c = (length - 0x200U) >> 1u;
 
-	fseek(fileHandle, 0x200, SEEK_SET);
-	while (c--)
-		r += fgetbw(fileHandle);
+	for (uint32_t i = MEGA_DRIVE_HEADER_END; i + 1 < length; i += 2)
+		r += (uint16_t) (image->data[i] << 8U | image->data[i + 1]);
 
 	return r;
 }
 
 static void
-sega_UpdateMegaDriveHeader(FILE* fileHandle) {
-	fseek(fileHandle, 0, SEEK_END);
-	long length = ftell(fileHandle);
+writeBigEndian(SImage* image, uint32_t offset, uint32_t value, uint32_t bytes) {
+	while (bytes-- > 0) {
+		image->data[offset + bytes] = (uint8_t) value;
+		value >>= 8U;
+	}
+}
 
-	fseek(fileHandle, 0x1A4, SEEK_SET);
-	fputbl(length - 1, fileHandle);
+static void
+sega_UpdateMegaDriveHeader(SImage* image, intptr_t data) {
+	uint32_t length = image->size;
+	image_Extend(image, MEGA_DRIVE_HEADER_END, 0);
 
-	uint16_t checksum = sega_CalcMegaDriveChecksum(fileHandle, length);
-	fseek(fileHandle, 0x18E, SEEK_SET);
-	fputbw(checksum, fileHandle);
+	writeBigEndian(image, 0x1A4, length - 1, 4);
+	writeBigEndian(image, 0x18E, sega_CalcMegaDriveChecksum(image, length), 2);
 }
 
 void
 sega_WriteMegaDriveImage(const char* outputFilename) {
-	image_WriteBinary(outputFilename, 0);
-
-	FILE* fileHandle = fopen(outputFilename, "r+b");
-	if (fileHandle == NULL)
-		error("Unable to open \"%s\" for writing", outputFilename);
-
-	sega_UpdateMegaDriveHeader(fileHandle);
-
-	fclose(fileHandle);
+	image_WriteBinary(outputFilename, 0, sega_UpdateMegaDriveHeader, 0);
 }
 
 static uint16_t
-sega_CalcMasterSystemCheckSumPart(FILE* fileHandle, int count, uint16_t checkSumIn) {
-	while (count--) {
-		checkSumIn += (uint16_t) fgetc(fileHandle);
+sega_CalcMasterSystemCheckSumPart(const SImage* image, uint32_t start, uint32_t end, uint16_t checkSumIn) {
+	for (uint32_t i = start; i < end && i < image->size; ++i) {
+		checkSumIn += image->data[i];
 	}
 	return checkSumIn;
 }
 
 static uint16_t
-sega_CalcMasterSystemCheckSum(FILE* fileHandle, int fileSize, int headerLocation) {
+sega_CalcMasterSystemCheckSum(const SImage* image, uint32_t headerLocation) {
 	uint16_t checkSum = 0;
 
-	fseek(fileHandle, 0, SEEK_SET);
-	checkSum = sega_CalcMasterSystemCheckSumPart(fileHandle, headerLocation, checkSum);
-	fseek(fileHandle, 16, SEEK_CUR);
-	fileSize -= headerLocation + 16;
-
-	if (fileSize > 0)
-		checkSum = sega_CalcMasterSystemCheckSumPart(fileHandle, fileSize, checkSum);
+	checkSum = sega_CalcMasterSystemCheckSumPart(image, 0, headerLocation, checkSum);
+	checkSum = sega_CalcMasterSystemCheckSumPart(image, headerLocation + 16, image->size, checkSum);
 
 	return checkSum;
 }
 
-uint8_t
+static uint8_t
 sega_CalcSizeCode(uint8_t code, size_t fileSize) {
 	uint8_t newCode = 0;
 
@@ -123,37 +112,25 @@ sega_CalcSizeCode(uint8_t code, size_t fileSize) {
 	return (uint8_t) ((code & 0xF0U) | newCode);
 }
 
-void
-sega_UpdateMasterSystemHeader(FILE* fileHandle, int headerLocation) {
-	uint16_t checkSum;
-	int fileSize;
-	uint8_t code;
-
-	fseek(fileHandle, 0, SEEK_END);
-	fileSize = ftell(fileHandle);
-
-	checkSum = sega_CalcMasterSystemCheckSum(fileHandle, fileSize, headerLocation);
-
-	fseek(fileHandle, headerLocation, SEEK_SET);
-	fwrite("TMR SEGA  ", 1, 10, fileHandle);
-	fputlw(checkSum, fileHandle);
-	fseek(fileHandle, 3, SEEK_CUR);
-	code = fgetc(fileHandle);
-	fseek(fileHandle, -1, SEEK_CUR);
-	fputc(sega_CalcSizeCode(code, fileSize), fileHandle);
+static void
+sega_UpdateMasterSystemHeader(SImage* image, intptr_t data) {
+	uint32_t headerLocation = (uint32_t) data;
+	uint32_t fileSize = image->size;
+
+	uint16_t checkSum = sega_CalcMasterSystemCheckSum(image, headerLocation);
+
+	image_Extend(image, headerLocation + 16, 0);
+
+	uint8_t* header = &image->data[headerLocation];
+	memcpy(header, "TMR SEGA  ", 10);
+	header[10] = (uint8_t) checkSum;
+	header[11] = (uint8_t) (checkSum >> 8U);
+	header[15] = sega_CalcSizeCode(header[15], fileSize);
 }
 
 void
 sega_WriteMasterSystemImage(const char* outputFilename, int binaryPad) {
 	int headerLocation = (binaryPad == 0) || (binaryPad >= 0x8000) ? 0x8000 : binaryPad;
 
-	FILE* fileHandle = fopen(outputFilename, "r+b");
-	if (fileHandle == NULL)
-		error("Unable to open \"%s\" for writing", outputFilename);
-
-	image_WriteBinaryToFile(fileHandle, binaryPad);
-
-	sega_UpdateMasterSystemHeader(fileHandle, headerLocation - 16);
-
-	fclose(fileHandle);
+	image_WriteBinary(outputFilename, binaryPad, sega_UpdateMasterSystemHeader, headerLocation - 16);
 }
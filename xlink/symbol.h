@@ -37,7 +37,7 @@ typedef enum {
 } ESymbolType;
 
 typedef struct Symbol {
-	char name[MAX_SYMBOL_NAME_LENGTH];
+	const char* name; // Interned
 	ESymbolType type;
 	int32_t value;
 	bool resolved;